@@ -33,10 +33,12 @@ extern "C" {
 #include "config.h"
 #include "hdbscan/utils.h"
 #include "listlib/list.h"
+#include "hdbscan/lists.h"
 #include "listlib/set.h"
 
 #define CLUSTER_SUCCESS 1			//! Notificaiton for successful operatoin
 #define CLUSTER_ERROR	0			//! Notification for errorneous results
+#define CLUSTER_INVALID_LABEL ((label_t)-1)	//! Returned instead of a label when no cluster could be created
 
 #ifdef __cplusplus
 namespace clustering {
@@ -369,6 +371,130 @@ void cluster_release_virtual_child(cluster* cl);
  */
 int32_t cluster_compare(const void* a, const void* b);
 
+/**
+ * \struct ClusterPool
+ * \brief Storage for a whole cluster tree, kept as one array per field and indexed by label.
+ * 
+ * Label 0 is reserved for noise and is never a parent, so 0 is used as the
+ * "no cluster" value for parent. Instead of keeping the propagated descendants
+ * of every cluster, propagation only records whether a cluster was selected
+ * over its descendants and the flat solution is collected afterwards in one
+ * pass. The virtual child clusters are recorded per point in virtualChildOf
+ * since a point can only become noise once. Clearing the pool is O(1); the
+ * arrays are kept for the next run.
+ */
+typedef struct ClusterPool {
+	label_t size;								//! Number of labels in use, including the noise label
+	label_t capacity;							//! Number of labels the arrays can hold
+	index_t numVertices;						//! Number of points virtualChildOf and noiseLevel can hold
+	distance_t* birthLevel;
+	distance_t* deathLevel;
+	index_t* numPoints;
+	int64_t* offset;
+	distance_t* stability;
+	distance_t* propagatedStability;
+	distance_t* propagatedLowestChildDeathLevel;
+	index_t* numConstraintsSatisfied;
+	index_t* propagatedNumConstraintsSatisfied;
+	label_t* parent;
+	boolean* hasChildren;
+	boolean* selected;							//! Cluster was chosen over its descendants
+	label_t* solution;							//! Solution cluster each cluster belongs to, 0 if none
+	boolean* chosen;							//! Scratch flags used while collecting the solution
+	label_t* ancestor;							//! Scratch per-label map used by the selection passes
+	label_t* virtualChildOf;					//! Cluster whose virtual child each noise point joined, i.e. its last cluster
+	distance_t* noiseLevel;						//! Level at which each point became noise
+} cluster_pool;
+
+/**
+ * @brief Initialise an empty pool. No memory is allocated until cluster_pool_reserve() is called.
+ * @param pool 
+ * @return cluster_pool* 
+ */
+cluster_pool* cluster_pool_init(cluster_pool* pool);
+
+/**
+ * @brief Make sure the pool can hold at least capacity labels and numVertices points.
+ * @param pool 
+ * @param capacity 
+ * @param numVertices 
+ * @return int CLUSTER_SUCCESS or CLUSTER_ERROR
+ */
+int cluster_pool_reserve(cluster_pool* pool, label_t capacity, index_t numVertices);
+
+/**
+ * @brief Forget all the clusters in the pool while keeping the memory
+ * @param pool 
+ */
+void cluster_pool_clear(cluster_pool* pool);
+
+/**
+ * @brief Free all the memory held by the pool
+ * @param pool 
+ */
+void cluster_pool_clean(cluster_pool* pool);
+
+/**
+ * @brief Add a cluster to the pool. The pool grows if it is full.
+ * @param pool 
+ * @param parent The label of the cluster which split to create this cluster, 0 for the root
+ * @param birthLevel The MST edge level at which this cluster first appeared
+ * @param numPoints The initial number of points in this cluster
+ * @return label_t The label of the new cluster, or CLUSTER_INVALID_LABEL if the pool could not grow
+ */
+label_t cluster_pool_add(cluster_pool* pool, label_t parent, distance_t birthLevel, index_t numPoints);
+
+/**
+ * @brief Same as cluster_detach_points() for the cluster with the given label
+ * @param pool 
+ * @param label 
+ * @param numPoints 
+ * @param level 
+ * @return int 
+ */
+int cluster_pool_detach_points(cluster_pool* pool, label_t label, index_t numPoints, distance_t level);
+
+/**
+ * @brief Same as cluster_propagate() for the cluster with the given label, except
+ * that the choice between the cluster and its descendants is only recorded in
+ * selected instead of copying the descendants to the parent.
+ * @param pool 
+ * @param label 
+ */
+void cluster_pool_propagate(cluster_pool* pool, label_t label);
+
+/**
+ * @brief Fill solution with the flat clustering. The candidates are the first
+ * clusters below the root that were selected (excess of mass) or, when leaves
+ * is set, the clusters without children. With a positive epsilon, a candidate
+ * born below epsilon is replaced by its deepest ancestor born above epsilon
+ * (or by the child of the root it descends from). Every cluster maps to the
+ * solution cluster above it and all other clusters map to 0 (noise). All the
+ * clusters must have been propagated first.
+ * @param pool 
+ * @param leaves Select the leaves of the tree instead of using excess of mass
+ * @param epsilon The cluster selection epsilon, 0 to disable
+ * @return label_t The number of clusters in the solution
+ */
+label_t cluster_pool_collect_solution(cluster_pool* pool, boolean leaves, distance_t epsilon);
+
+/**
+ * @brief Record the points as members of the virtual child cluster of label
+ * @param pool 
+ * @param label 
+ * @param points 
+ */
+void cluster_pool_add_points_to_virtual_child(cluster_pool* pool, label_t label, set_t* points);
+
+/**
+ * @brief 
+ * @param pool 
+ * @param label 
+ * @param point 
+ * @return boolean 
+ */
+boolean cluster_pool_virtual_child_contains_point(cluster_pool* pool, label_t label, index_t point);
+
 // ------------------------------ GETTERS & SETTERS ------------------------------
 
 
@@ -40,6 +40,7 @@ extern "C" {
 #include <stdint.h>
 #include "config.h"
 #include "hdbscan/utils.h"
+#include "hdbscan/progress.h"
 
 
 #define DISTANCE_SUCCESS 1
@@ -72,6 +73,7 @@ struct Distance{
 	index_t numNeighbors;
 	calculator cal;
 	enum HTYPES datatype;
+	progress* runProgress;			/// Progress of the run the distances are computed for, may be NULL
 
 #ifdef __cplusplus
 public:
@@ -177,6 +179,20 @@ void distance_clean(distance* d);
  */
 distance_t distance_get(distance* dis, index_t row, index_t col);
 
+/**
+ * @brief Get the euclidean distance between row i of dataA and row j of dataB,
+ * where both have dis->cols columns of dis->datatype. Used to measure points
+ * that are not part of the distance matrix.
+ * 
+ * @param dis 
+ * @param dataA 
+ * @param i 
+ * @param dataB 
+ * @param j 
+ * @return distance_t 
+ */
+distance_t distance_between(distance* dis, void* dataA, index_t i, void* dataB, index_t j);
+
 /**
  * @brief Computes the euclidean distance between two points, 
  * 
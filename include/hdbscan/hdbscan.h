@@ -42,6 +42,10 @@ extern "C" {
 #include "distance.h"
 #include "outlier_score.h"
 #include "undirected_graph.h"
+#include "workspace.h"
+#include "moments.h"
+#include "profile.h"
+#include "progress.h"
 #include "listlib/list.h"
 #include "listlib/hashtable.h"
 
@@ -70,6 +74,15 @@ typedef hashtable IntClusterListMap;
 namespace clustering {
 #endif
 
+/**
+ * \enum SELECTION_METHOD
+ * @brief How the flat clustering is selected from the cluster tree
+ */
+typedef enum _SELECTION_METHOD {
+	SELECTION_EOM,				/// Excess of mass, the most stable clusters
+	SELECTION_LEAF				/// The leaves of the cluster tree
+} SELECTION_METHOD;
+
 /**
  * \struct distance_values
  * 
@@ -86,6 +99,18 @@ typedef struct distance_values{
 	distance_t dr_confidence;		/// Cluster confidence based on actual distances
 } distance_values; /** \typedef distance_values */
 
+/**
+ * \struct _cluster_members
+ * @brief Flat cluster membership index. The points of cluster labels[k] are
+ * members[offsets[k]] up to members[offsets[k+1] - 1].
+ */
+typedef struct _cluster_members{
+	index_t numClusters;			/// Number of clusters, including noise if it has points
+	label_t* labels;				/// The label of each cluster
+	index_t* offsets;				/// numClusters + 1 offsets into members
+	index_t* members;				/// The point ids grouped by cluster
+} cluster_members; /** \typedef cluster_members */
+
 /**
  * \struct stats_values
  * @brief The statistical values
@@ -130,13 +155,22 @@ struct hdbscan {
 	UndirectedGraph* mst;					/// The dendogram graph
 	ArrayList* constraints;					/// Constraints
 	distance_t* coreDistances;					/// Core distances
-	ArrayList* clusters;
-	outlier_score* outlierScores;
+	cluster_pool clusters;					/// The cluster tree, indexed by label
+	distance_t* outlierScores;				/// GLOSH score of each point, in id order
 	label_t* clusterLabels;
 	hashtable* hierarchy;
 	IntDoubleMap* clusterStabilities;
 	boolean selfEdges;
-	index_t minPoints, minClusterSize, numPoints;
+	index_t minPoints;						/// Number of neighbours used for the core distances
+	index_t minClusterSize;					/// Smallest number of points a cluster can have, minPoints by default
+	index_t numPoints;
+	SELECTION_METHOD selectionMethod;		/// How the flat clustering is selected, SELECTION_EOM by default
+	distance_t clusterSelectionEpsilon;		/// Clusters born below this distance are merged into their parents, 0 by default
+	workspace scratch;						/// Reusable memory for the scratch buffers of a run
+	boolean keepDataSet;					/// Keep a copy of the training data for prediction, FALSE by default
+	void* dataSet;							/// The copy of the training data when keepDataSet is TRUE
+	hdbscan_profile profile;				/// Time and memory used by each phase of the runs, when enabled
+	progress runProgress;					/// Progress reporting and cancellation of the runs
 
 #ifdef __cplusplus
 
@@ -154,6 +188,14 @@ public:
 	 */
 	hdbscan(index_t minPts);
 
+	/**
+	 * @brief Construct a new hdbscan object
+	 * 
+	 * @param minPts 
+	 * @param minClusterSize 
+	 */
+	hdbscan(index_t minPts, index_t minClusterSize);
+
 	/**
 	 * @brief Destroy the hdbscan object
 	 * 
@@ -179,6 +221,100 @@ public:
 	 */
 	void reRun(index_t minPts);
 
+	/**
+	 * @brief Re-selects the clusters with a new minClusterSize from the MST of the
+	 * last run. It MUST be run after run()
+	 * 
+	 * @param minClusterSize 
+	 */
+	void reSelect(index_t minClusterSize);
+
+	/**
+	 * @brief C++ version of hdbscan_select_clusters
+	 * 
+	 * @param method 
+	 * @param epsilon 
+	 */
+	void selectClusters(SELECTION_METHOD method, distance_t epsilon);
+
+	/**
+	 * @brief C++ version of hdbscan_cut_tree
+	 * 
+	 * @param cutDistance 
+	 * @param labels 
+	 */
+	void cutTree(distance_t cutDistance, label_t* labels);
+
+	/**
+	 * @brief C++ version of hdbscan_approximate_predict
+	 * 
+	 * @param newPoints 
+	 * @param m 
+	 * @param labels 
+	 * @param probabilities 
+	 */
+	void approximatePredict(void* newPoints, index_t m, label_t* labels, distance_t* probabilities);
+
+	/**
+	 * @brief C++ version of hdbscan_selected_clusters
+	 * 
+	 * @param clusters 
+	 * @return index_t 
+	 */
+	index_t selectedClusters(label_t* clusters);
+
+	/**
+	 * @brief C++ version of hdbscan_membership_vectors
+	 * 
+	 * @param memberships 
+	 */
+	void membershipVectors(distance_t* memberships);
+
+	/**
+	 * @brief C++ version of hdbscan_top_outliers
+	 * 
+	 * @param k 
+	 * @param top 
+	 * @return index_t 
+	 */
+	index_t topOutliers(index_t k, outlier_score* top);
+
+	/**
+	 * @brief C++ version of hdbscan_dbcv
+	 * 
+	 * @param clusterValidity 
+	 * @return distance_t The validity index
+	 */
+	distance_t dbcv(distance_t* clusterValidity);
+
+	/**
+	 * @brief C++ version of hdbscan_enable_profile
+	 * 
+	 * @param enabled 
+	 */
+	void enableProfile(boolean enabled);
+
+	/**
+	 * @brief C++ version of hdbscan_enable_prediction
+	 * 
+	 * @param enabled 
+	 */
+	void enablePrediction(boolean enabled);
+
+	/**
+	 * @brief C++ version of hdbscan_set_progress_callback
+	 * 
+	 * @param callback 
+	 * @param data 
+	 */
+	void setProgressCallback(progress_callback callback, void* data);
+
+	/**
+	 * @brief C++ version of hdbscan_cancel
+	 * 
+	 */
+	void cancel();
+
 	/**
 	 * @brief Calculates the core distances for each point in the data set.
 	 * 
@@ -274,7 +410,10 @@ void hdbscan_destroy(hdbscan* sc);
 void hdbscan_clean(hdbscan* sc);
 
 /**
- * @brief Run HDBSCAN cluster detection on the dataset.
+ * @brief Run HDBSCAN cluster detection on the dataset. When prediction has been
+ * enabled with hdbscan_enable_prediction(), a copy of the dataset is kept in
+ * sc->dataSet for hdbscan_approximate_predict(). The results of a previous run
+ * on the same sc are released first.
  * 
  * @param sc 
  * @param dataset 
@@ -289,7 +428,8 @@ int hdbscan_run(hdbscan* sc, void* dataset, index_t rows, index_t cols, boolean
 /**
  * @brief In case you need to re-cluster with a differnt minPts without changing the dataset.
  * This function will do that by just recalculating the core distances from the existing
- * distances.
+ * distances. minPoints is set to minPts. minClusterSize follows it when it still equals
+ * the old minPoints, a minClusterSize set with hdbscan_reselect() or directly is kept.
  * 
  * @param sc 
  * @param minPts 
@@ -297,20 +437,85 @@ int hdbscan_run(hdbscan* sc, void* dataset, index_t rows, index_t cols, boolean
  */
 int hdbscan_rerun(hdbscan* sc, index_t minPts);
 
+/**
+ * @brief Re-cluster with a different minClusterSize. The distances, core distances
+ * and the sorted MST of the last run are reused, only the cluster tree is rebuilt
+ * and the flat clustering selected again. hdbscan_run() must be called first.
+ * 
+ * @param sc 
+ * @param minClusterSize The smallest number of points a cluster can have
+ * @return int HDBSCAN_SUCCESS or HDBSCAN_ERROR
+ */
+int hdbscan_reselect(hdbscan* sc, index_t minClusterSize);
+
+/**
+ * @brief Start or stop recording the time and memory used by each phase of
+ * the runs in sc->profile. Enabling the profile clears it. See hdbscan_profile
+ * for why the memory figures are only exact for one run at a time.
+ * 
+ * @param sc 
+ * @param enabled 
+ */
+void hdbscan_enable_profile(hdbscan* sc, boolean enabled);
+
+/**
+ * @brief Keep a copy of the training data in the next runs so that
+ * hdbscan_approximate_predict() can measure new points against it. Off by
+ * default, because the copy takes as much memory as the dataset. Disabling
+ * prediction frees the copy.
+ * 
+ * @param sc 
+ * @param enabled 
+ */
+void hdbscan_enable_prediction(hdbscan* sc, boolean enabled);
+
+/**
+ * @brief Set the callback that gets the progress of the distances, the MST
+ * and the hierarchy while hdbscan_run(), hdbscan_rerun() and hdbscan_reselect()
+ * run. The callback is called from the thread that started the run, at most
+ * every PROGRESS_INTERVAL seconds, and can cancel the run by returning
+ * PROGRESS_CANCEL.
+ * 
+ * A cancelled run returns HDBSCAN_ERROR and frees everything it computed,
+ * including the distances and the MST, so sc has to be run again before its
+ * results can be used.
+ * 
+ * @param sc 
+ * @param callback The callback, or NULL to stop reporting
+ * @param data Passed to the callback
+ */
+void hdbscan_set_progress_callback(hdbscan* sc, progress_callback callback, void* data);
+
+/**
+ * @brief Cancel the run of sc that is in progress. Safe to call from any thread.
+ * 
+ * @param sc 
+ */
+void hdbscan_cancel(hdbscan* sc);
+
 /**
  * @brief Given min and max values of minPts, select the best minPts from min
  * to max inclusive.
  * 
- * @param min 
- * @param max 
+ * The distances are computed once and the max nearest neighbours of every point
+ * are cached, so every candidate only builds its own MST and cluster tree. The
+ * candidates are run in parallel, a wave of one per thread, and each is scored
+ * with hdbscan_dbcv(). The sweep stops early once HDBSCAN_SWEEP_PATIENCE
+ * candidates in a row have not beaten the best score. Ties go to the smaller minPts.
+ * 
+ * @param min The smallest minPts, at least 2
+ * @param max The largest minPts, at most rows
  * @param dataset 
+ * @param rows 
+ * @param cols 
  * @param datatype 
- * @param selection 
- * @param val 
- * @param numClusters 
- * @return int32_t 
+ * @param selection An (H_INT, H_DOUBLE) hashtable that receives the score of every
+ * evaluated minPts, or NULL. Candidates without clusters score -1.
+ * @param val The best minPts
+ * @param numClusters The number of clusters, noise excluded, found with val
+ * @return int32_t HDBSCAN_SUCCESS or HDBSCAN_ERROR
  */
-int32_t hdbscan_select_min_pts(int32_t min, int32_t max, void* dataset, int32_t datatype, hashtable* selection, int32_t *val, int32_t *numClusters);
+int32_t hdbscan_select_min_pts(int32_t min, int32_t max, void* dataset, index_t rows, index_t cols, int32_t datatype, hashtable* selection, int32_t *val, int32_t *numClusters);
 
 /**
  * @brief Create the minimum spanning tree
@@ -354,8 +559,78 @@ boolean hdbscan_propagate_tree(hdbscan* sc);
 void hdbscan_find_prominent_clusters(hdbscan* sc, int32_t infiniteStability);
 
 /**
- * @brief Produces the outlier score for each point in the data set, and returns a sorted list of outlier
- * scores.  hdbscan_propagate_tree() must be called before calling this method.
+ * @brief Select the flat clustering again from the existing cluster tree with a
+ * different selection method or cluster selection epsilon and update clusterLabels.
+ * This is a linear pass over the tree and the points, hdbscan_run() must be called first.
+ * 
+ * @param sc 
+ * @param method SELECTION_EOM or SELECTION_LEAF
+ * @param epsilon Clusters born below this distance are replaced by their closest
+ * ancestor born above it. 0 disables it.
+ * @return int HDBSCAN_SUCCESS or HDBSCAN_ERROR
+ */
+int hdbscan_select_clusters(hdbscan* sc, SELECTION_METHOD method, distance_t epsilon);
+
+/**
+ * @brief The flat clustering obtained by cutting the cluster tree at cutDistance:
+ * every point gets the label of the cluster it belongs to at that distance and
+ * points that are already noise get 0. hdbscan_run() must be called first.
+ * 
+ * @param sc 
+ * @param cutDistance 
+ * @param labels An array of numPoints labels to fill
+ * @return int HDBSCAN_SUCCESS or HDBSCAN_ERROR
+ */
+int hdbscan_cut_tree(hdbscan* sc, distance_t cutDistance, label_t* labels);
+
+/**
+ * @brief Assign new points to the clusters of the fitted model without running
+ * HDBSCAN again. hdbscan_run() must be called first, with prediction enabled
+ * by hdbscan_enable_prediction().
+ * 
+ * Each new point gets a core distance from its minPoints-1 nearest training
+ * points and is attached to the cluster tree through the training point it is
+ * closest to in mutual reachability distance, at the level of that distance.
+ * The model is only read, so several threads can predict at the same time.
+ * 
+ * @param sc 
+ * @param newPoints m rows with the same columns and datatype as the training data
+ * @param m The number of new points
+ * @param labels An array of m labels to fill, 0 for noise
+ * @param probabilities An array of m membership strengths to fill, or NULL
+ * @return int HDBSCAN_SUCCESS or HDBSCAN_ERROR
+ */
+int hdbscan_approximate_predict(hdbscan* sc, void* newPoints, index_t m, label_t* labels, distance_t* probabilities);
+
+/**
+ * @brief Get the labels of the selected clusters in ascending order. These are the
+ * columns of hdbscan_membership_vectors().
+ * 
+ * @param sc 
+ * @param clusters An array to fill with the labels, or NULL to only count them
+ * @return index_t The number of selected clusters
+ */
+index_t hdbscan_selected_clusters(hdbscan* sc, label_t* clusters);
+
+/**
+ * @brief Compute the soft clustering of every point as a numPoints x K row major
+ * matrix, where K is the number of selected clusters.
+ * 
+ * The membership of a point in a cluster combines the distance to the nearest
+ * exemplar of the cluster (the points that persist longest in its leaves) with
+ * the level at which the point merges with the cluster in the cluster tree. Each
+ * row is scaled by the probability that the point is in any cluster, so noise
+ * points have small rows. hdbscan_run() must be called first.
+ * 
+ * @param sc 
+ * @param memberships An array of numPoints * K values to fill
+ * @return int HDBSCAN_SUCCESS or HDBSCAN_ERROR
+ */
+int hdbscan_membership_vectors(hdbscan* sc, distance_t* memberships);
+
+/**
+ * @brief Produces the GLOSH outlier score for each point in the data set and stores them in
+ * sc->outlierScores in id order. hdbscan_propagate_tree() must be called before calling this method.
  * 
  * @param sc 
  * @param pointNoiseLevels A distance_t array with the levels at which each point became noise
@@ -365,6 +640,41 @@ void hdbscan_find_prominent_clusters(hdbscan* sc, int32_t infiniteStability);
  */
 int hdbscsan_calculate_outlier_scores(hdbscan* sc, distance_t* pointNoiseLevels, label_t* pointLastClusters, boolean infiniteStability);
 
+/**
+ * @brief Get the k points with the highest outlier scores, most outlying first. Ties
+ * are broken by core distance and then by id as in outlier_score_compare(). This
+ * is a parallel partial selection, so it costs O(N log k) instead of a full sort.
+ * 
+ * @param sc 
+ * @param k The number of outliers wanted
+ * @param top An array of k outlier scores to fill
+ * @return index_t The number of outliers written, which is less than k when there are fewer points
+ */
+index_t hdbscan_top_outliers(hdbscan* sc, index_t k, outlier_score* top);
+
+/**
+ * @brief Density based clustering validation (DBCV) of the flat clustering,
+ * approximated on the mutual reachability MST of the run. hdbscan_run() must be
+ * called first.
+ * 
+ * The density sparseness of a cluster is its widest MST edge with both ends inside
+ * it, and its density separation is the smallest minimax path weight on the MST
+ * from it to another cluster, where the path may run through noise. A cluster that
+ * the MST does not join to another cluster is given twice the widest MST edge (twice
+ * the shortest edge to noise when there is only one cluster). The validity of a
+ * cluster is (separation - sparseness) / max(separation, sparseness) and the index
+ * is the mean over the points, noise counting as 0. It lies in [-1, 1], higher is
+ * better, and is 0 when there are no clusters. This is one parallel pass and one
+ * single linkage pass over the sorted MST edges and can be compared across runs.
+ * 
+ * @param sc 
+ * @param validity The validity index of the clustering
+ * @param clusterValidity An array to fill with the validity of every cluster in
+ * hdbscan_selected_clusters() order, or NULL
+ * @return int HDBSCAN_SUCCESS or HDBSCAN_ERROR
+ */
+int hdbscan_dbcv(hdbscan* sc, distance_t* validity, distance_t* clusterValidity);
+
 /**
  * @brief Given an array of labels, create a hash table where the keys are the labels and the values are the indices.
  * 
@@ -387,7 +697,19 @@ hashtable* hdbscan_create_cluster_map(label_t* labels, index_t begin, index_t en
 void hdbscan_calculate_stats(hashtable* distanceMap, clustering_stats* stats);
 
 /**
- * @brief A helper function for calculating statical values
+ * @brief Calculate the statistical values of an array of distance values, such as
+ * the one filled by hdbscan_cluster_members_min_max(), and set their confidences.
+ * 
+ * @param values 
+ * @param numValues 
+ * @param stats 
+ * @return int HDBSCAN_SUCCESS or HDBSCAN_ERROR
+ */
+int hdbscan_calculate_values_stats(distance_values* values, index_t numValues, clustering_stats* stats);
+
+/**
+ * @brief A helper function for calculating statical values. The values are read once
+ * and their moments are accumulated in parallel chunks, see moments.h
  * 
  * @param cr 
  * @param dr 
@@ -395,6 +717,15 @@ void hdbscan_calculate_stats(hashtable* distanceMap, clustering_stats* stats);
  */
 void hdbscan_calculate_stats_helper(distance_t* cr, distance_t* dr, clustering_stats* stats);
 
+/**
+ * @brief Fill the mean, variance, standard deviation, skewness and kurtosis of values
+ * from a moments accumulator. The max is left alone since it is not a moment.
+ * 
+ * @param values 
+ * @param m 
+ */
+void hdbscan_stats_from_moments(stats_values* values, const moments* m);
+
 /**
  * @brief Create a hash table for statistical values describing the clustering results
  * 
@@ -412,6 +743,56 @@ int32_t hdbscan_analyse_stats(clustering_stats* stats);
  */
 hashtable* hdbscan_get_min_max_distances(hdbscan* sc, hashtable* clusterTable);
 
+/**
+ * @brief Build the membership index of labels[begin] to labels[end - 1] with a parallel
+ * counting sort. The clusters are in ascending label order and the points of every
+ * cluster are in ascending id order. An empty range gives an index with no clusters.
+ * 
+ * Every thread counts the labels of its share of the points, the counts are turned
+ * into offsets, and every thread then places its points. Only the index itself and
+ * one count per label and thread are allocated.
+ * 
+ * @param cm 
+ * @param labels 
+ * @param begin 
+ * @param end 
+ * @return int HDBSCAN_SUCCESS or HDBSCAN_ERROR
+ */
+int hdbscan_create_cluster_members(cluster_members* cm, label_t* labels, index_t begin, index_t end);
+
+/**
+ * @brief Flatten a cluster table from hdbscan_create_cluster_map() into a membership
+ * index. The clusters keep the order of the table's keys.
+ * 
+ * @param cm 
+ * @param clusterTable 
+ * @return int HDBSCAN_SUCCESS or HDBSCAN_ERROR
+ */
+int hdbscan_cluster_members_from_map(cluster_members* cm, hashtable* clusterTable);
+
+/**
+ * @brief Free the arrays of the membership index but not cm itself
+ * 
+ * @param cm 
+ */
+void hdbscan_cluster_members_clean(cluster_members* cm);
+
+/**
+ * @brief Get the minimum and maximum core and intra-cluster distances of every
+ * cluster in the membership index. values[k] is filled for cluster cm->labels[k]
+ * and its confidences are set to 0.
+ * 
+ * The pairwise distances of each cluster are split into blocks of rows that are
+ * shared among the threads, so large clusters do not run on one thread, and the
+ * block results are reduced per cluster at the end.
+ * 
+ * @param sc 
+ * @param cm 
+ * @param values An array of cm->numClusters values to fill
+ * @return int HDBSCAN_SUCCESS or HDBSCAN_ERROR
+ */
+int hdbscan_cluster_members_min_max(hdbscan* sc, cluster_members* cm, distance_values* values);
+
 /**
  * @brief Sorts the clusters using the distances in the distanceMap.
  * 
@@ -431,6 +812,30 @@ ArrayList* hdbscan_sort_by_similarity(hashtable* distanceMap, ArrayList *cluster
  */
 ArrayList* hdbscan_sort_by_length(hashtable* clusterTable, ArrayList *clusters);
 
+/**
+ * @brief Sorts the clusters of a membership index by their confidences. values[k]
+ * belongs to cluster cm->labels[k] and its confidences must have been set with
+ * hdbscan_calculate_values_stats(). When clusters is NULL or empty it is filled
+ * with all the clusters of cm.
+ * 
+ * @param cm 
+ * @param values 
+ * @param clusters 
+ * @param distanceType CORE_DISTANCE_TYPE or INTRA_DISTANCE_TYPE
+ * @return ArrayList* clusters, or NULL when a cluster is not in cm or memory runs out
+ */
+ArrayList* hdbscan_cluster_members_sort_by_similarity(cluster_members* cm, distance_values* values, ArrayList *clusters, int32_t distanceType);
+
+/**
+ * @brief Sorts the clusters of a membership index by their number of points. When
+ * clusters is NULL or empty it is filled with all the clusters of cm.
+ * 
+ * @param cm 
+ * @param clusters 
+ * @return ArrayList* clusters, or NULL when a cluster is not in cm or memory runs out
+ */
+ArrayList* hdbscan_cluster_members_sort_by_length(cluster_members* cm, ArrayList *clusters);
+
 /**
  * @brief Uses quick sort algorithm to sort clusters based on the data
  * 
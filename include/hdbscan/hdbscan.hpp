@@ -46,6 +46,64 @@ typedef set<index_t> set_i;
 
 
 namespace clustering {
+
+	/**
+	 * @brief A read-only view of the points of one cluster in a ClusterMembers index
+	 */
+	struct MemberSpan {
+		const index_t* first;
+		const index_t* last;
+
+		const index_t* begin() const { return first; }
+		const index_t* end() const { return last; }
+		size_t size() const { return (size_t)(last - first); }
+		index_t operator[](size_t i) const { return first[i]; }
+	};
+
+	/**
+	 * @brief Owner of a flat cluster membership index built by hdbscan_create_cluster_members
+	 */
+	class ClusterMembers {
+	public:
+		/**
+		 * @brief Build the index of labels[begin] to labels[end - 1]
+		 * 
+		 * @param labels 
+		 * @param begin 
+		 * @param end 
+		 */
+		ClusterMembers(label_t* labels, index_t begin, index_t end);
+		ClusterMembers(ClusterMembers&& other);
+		ClusterMembers(const ClusterMembers&) = delete;
+		ClusterMembers& operator=(const ClusterMembers&) = delete;
+		~ClusterMembers();
+
+		/**
+		 * @brief Number of clusters in the index
+		 */
+		index_t size() const { return cm.numClusters; }
+
+		/**
+		 * @brief Label of the k-th cluster
+		 */
+		label_t label(index_t k) const { return cm.labels[k]; }
+
+		/**
+		 * @brief Points of the k-th cluster
+		 */
+		MemberSpan members(index_t k) const { 
+			MemberSpan span = {cm.members + cm.offsets[k], cm.members + cm.offsets[k + 1]};
+			return span; 
+		}
+
+		/**
+		 * @brief The underlying C index
+		 */
+		cluster_members* data() { return &cm; }
+
+	private:
+		cluster_members cm;
+	};
 	
 	/**
 	 * @brief Create a Cluster Map object
@@ -66,6 +124,15 @@ namespace clustering {
 	 */
 	map<label_t, distance_values> getMinMaxDistances(hdbscan& scan, map_t& clusterTable);
 
+	/**
+	 * @brief Get the Min Max Distances object straight from a membership index
+	 * 
+	 * @param scan 
+	 * @param members 
+	 * @return map<label_t, distance_values> 
+	 */
+	map<label_t, distance_values> getMinMaxDistances(hdbscan& scan, ClusterMembers& members);
+
 	/**
 	 * @brief 
 	 * 
@@ -82,6 +149,30 @@ namespace clustering {
 	 */
 	int32_t analyseStats(clustering_stats& stats);
 
+	/**
+	 * @brief The profile of the runs of scan, keyed by the name of the phase
+	 * 
+	 * @param scan 
+	 * @return map<string, phase_profile> 
+	 */
+	map<string, phase_profile> getProfile(hdbscan& scan);
+
+	/**
+	 * @brief C++ version of hdbscan_select_min_pts
+	 * 
+	 * @param min 
+	 * @param max 
+	 * @param dataset 
+	 * @param rows 
+	 * @param cols 
+	 * @param datatype 
+	 * @param selection Receives the score of every evaluated minPts
+	 * @param val The best minPts
+	 * @param numClusters 
+	 * @return int32_t 
+	 */
+	int32_t selectMinPts(int32_t min, int32_t max, void* dataset, index_t rows, index_t cols, int32_t datatype, map<int32_t, distance_t>& selection, int32_t& val, int32_t& numClusters);
+
 	/**
 	 * @brief 
 	 * 
@@ -127,6 +218,14 @@ namespace clustering {
 	 */
 	void sortByLength(map_t& clusterTable, vector<label_t>& clusters);
 
+	/**
+	 * @brief Sorts clusters according to how long the cluster is, using a membership index
+	 * 
+	 * @param members 
+	 * @param clusters 
+	 */
+	void sortByLength(ClusterMembers& members, vector<label_t>& clusters);
+
 	/**
 	 * @brief 
 	 * 
@@ -0,0 +1,61 @@
+/*
+ * lists.h
+ *
+ * Copyright 2024 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** 
+ * @file lists.h
+ * 
+ * @brief Typed ArrayList functions for the types used by the clustering.
+ * 
+ * index_list_*, label_list_* and distance_list_* work on lists of index_t,
+ * label_t and distance_t and ptr_list_* on lists of pointers. See
+ * listlib/typedlist.h for the functions.
+ */
+#ifndef LISTS_H_
+#define LISTS_H_
+
+#include "config.h"
+#include "listlib/typedlist.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+LISTLIB_TYPED_LIST(index, index_t)
+LISTLIB_ORDERED_LIST(index, index_t)
+
+LISTLIB_TYPED_LIST(label, label_t)
+LISTLIB_ORDERED_LIST(label, label_t)
+
+LISTLIB_TYPED_LIST(distance, distance_t)
+LISTLIB_ORDERED_LIST(distance, distance_t)
+
+LISTLIB_TYPED_LIST(ptr, void*)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* LISTS_H_ */
@@ -0,0 +1,115 @@
+/*
+ * moments.h
+ *
+ * Copyright 2024 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** @file moments.h */
+#ifndef MOMENTS_H_
+#define MOMENTS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include "config.h"
+
+#ifdef __cplusplus
+namespace clustering {
+#endif
+
+/**
+ * \struct Moments
+ * 
+ * @brief Streaming accumulator for the first four central moments of a set of values.
+ * 
+ * Values are added one at a time with the Welford/Terriberry update, so only one
+ * pass over the data is needed. Accumulators of separate chunks can be merged,
+ * which lets the chunks be accumulated on different threads, and values or whole
+ * chunks can be taken out again when the data they describe changes.
+ * 
+ * \typedef moments
+ */
+typedef struct Moments{
+	index_t count;			/// Number of values
+	distance_t mean;		/// Mean of the values
+	distance_t m2;			/// Sum of the squared deviations from the mean
+	distance_t m3;			/// Sum of the cubed deviations from the mean
+	distance_t m4;			/// Sum of the fourth powers of the deviations from the mean
+} moments;
+
+/**
+ * @brief Initialise an empty accumulator
+ * 
+ * @param m 
+ * @return moments* 
+ */
+moments* moments_init(moments* m);
+
+/**
+ * @brief Add one value
+ * 
+ * @param m 
+ * @param x 
+ */
+void moments_add(moments* m, distance_t x);
+
+/**
+ * @brief Take out a value that was added before
+ * 
+ * @param m 
+ * @param x 
+ */
+void moments_remove(moments* m, distance_t x);
+
+/**
+ * @brief Merge the values of b into a
+ * 
+ * @param a 
+ * @param b 
+ */
+void moments_merge(moments* a, const moments* b);
+
+/**
+ * @brief Take the values of b out of a, where b describes a subset of the values of a
+ * 
+ * @param a 
+ * @param b 
+ */
+void moments_subtract(moments* a, const moments* b);
+
+/**
+ * @brief Sample variance, m2 / (count - 1)
+ * 
+ * @param m 
+ * @return distance_t 
+ */
+distance_t moments_variance(const moments* m);
+
+#ifdef __cplusplus
+};
+}
+#endif
+
+#endif /* MOMENTS_H_ */
@@ -0,0 +1,173 @@
+/*
+ * profile.h
+ *
+ * Copyright 2024 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** @file profile.h */
+#ifndef PROFILE_H_
+#define PROFILE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include "config.h"
+#include "hdbscan/utils.h"
+
+#ifdef __cplusplus
+namespace clustering {
+#endif
+
+/**
+ * \enum HDBSCAN_PHASE
+ * @brief The phases of a run, in the order they run
+ */
+typedef enum _HDBSCAN_PHASE {
+	PHASE_DISTANCES,			/// distance_compute, the core distances
+	PHASE_MST,					/// hdbscan_construct_mst
+	PHASE_SORT,					/// Sorting the MST edges by weight
+	PHASE_HIERARCHY,			/// hdbscan_compute_hierarchy_and_cluster_tree
+	PHASE_PROPAGATION,			/// hdbscan_propagate_tree and hdbscan_find_prominent_clusters
+	PHASE_OUTLIER_SCORES,		/// The GLOSH outlier scores
+	HDBSCAN_NUM_PHASES
+} HDBSCAN_PHASE;
+
+/**
+ * \struct PhaseProfile
+ * 
+ * @brief Time and memory used by one phase, summed over all the runs since
+ * the profile was reset.
+ * 
+ * The memory counters only see the allocations made through the allocator
+ * of allocator.h and are process-wide, so they include the allocations of
+ * other instances running at the same time.
+ * 
+ * \typedef phase_profile
+ */
+typedef struct PhaseProfile{
+	double wallTime;			/// Elapsed time in seconds
+	double cpuTime;				/// CPU time of the process in seconds, summed over all threads
+	size_t bytesAllocated;		/// Bytes allocated
+	size_t peakBytes;			/// Most bytes held on top of those held when the phase started, over all the runs
+	index_t calls;				/// Number of times the phase ran
+} phase_profile;
+
+/**
+ * \struct Profile
+ * 
+ * @brief Per-phase profile of the runs of an hdbscan instance. Nothing is
+ * recorded until the profile is enabled, and nothing at all unless the library
+ * is compiled with HDBSCAN_PROFILE (PROFILE_ENABLE=ON in cmake, off by default
+ * because it puts a header in front of every allocation).
+ * 
+ * The times are per instance but the memory counters are shared by the whole
+ * process. Runs that overlap, like the candidates of a parallel minPts
+ * selection or instances on other threads, add to each other's bytes and
+ * peaks, and every phase that starts resets the one process-wide peak. The
+ * memory figures are only exact when one profiled run goes at a time.
+ * 
+ * \typedef hdbscan_profile
+ */
+typedef struct Profile{
+	boolean enabled;
+	phase_profile phases[HDBSCAN_NUM_PHASES];
+} hdbscan_profile;
+
+/**
+ * \struct ProfileMark
+ * 
+ * @brief The clocks and counters at the start of a phase
+ * 
+ * \typedef profile_mark
+ */
+typedef struct ProfileMark{
+	double wallTime;
+	double cpuTime;
+	size_t bytesAllocated;
+	size_t liveBytes;
+} profile_mark;
+
+#ifdef HDBSCAN_PROFILE
+/**
+ * @brief Start timing a phase in the function. Declares the mark.
+ */
+#define PROFILE_BEGIN(profile, mark) profile_mark mark; profile_begin(profile, &mark)
+
+/**
+ * @brief Add the time and memory used since PROFILE_BEGIN to the phase.
+ */
+#define PROFILE_END(profile, phase, mark) profile_end(profile, phase, &mark)
+#else
+#define PROFILE_BEGIN(profile, mark)
+#define PROFILE_END(profile, phase, mark)
+#endif
+
+/**
+ * @brief Initialise a disabled and empty profile
+ * 
+ * @param profile 
+ */
+void profile_init(hdbscan_profile* profile);
+
+/**
+ * @brief Clear all the phases of the profile
+ * 
+ * @param profile 
+ */
+void profile_reset(hdbscan_profile* profile);
+
+/**
+ * @brief Record the clocks and counters at the start of a phase in mark, if
+ * the profile is enabled
+ * 
+ * @param profile 
+ * @param mark 
+ */
+void profile_begin(hdbscan_profile* profile, profile_mark* mark);
+
+/**
+ * @brief Add the time and memory used since profile_begin() to the phase, if
+ * the profile is enabled
+ * 
+ * @param profile 
+ * @param phase 
+ * @param mark 
+ */
+void profile_end(hdbscan_profile* profile, HDBSCAN_PHASE phase, profile_mark* mark);
+
+/**
+ * @brief Name of the phase, as used by the bindings
+ * 
+ * @param phase 
+ * @return const char* 
+ */
+const char* profile_phase_name(HDBSCAN_PHASE phase);
+
+#ifdef __cplusplus
+};
+}
+#endif
+
+#endif /* PROFILE_H_ */
@@ -0,0 +1,132 @@
+/*
+ * progress.h
+ *
+ * Copyright 2024 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** @file progress.h */
+#ifndef PROGRESS_H_
+#define PROGRESS_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+#include "hdbscan/profile.h"
+
+#define PROGRESS_CONTINUE 0
+#define PROGRESS_CANCEL 1
+
+/**
+ * Least number of seconds between two calls of the progress callback
+ * within a phase.
+ */
+#define PROGRESS_INTERVAL 0.1
+
+#ifdef __cplusplus
+namespace clustering {
+#endif
+
+/**
+ * @brief Called with the phase and the fraction of it that is done. Returning
+ * PROGRESS_CANCEL stops the run.
+ */
+typedef int (*progress_callback)(HDBSCAN_PHASE phase, double fraction, void* data);
+
+/**
+ * \struct Progress
+ * 
+ * @brief Progress reporting and cooperative cancellation of a run.
+ * 
+ * The long loops report their progress with progress_report(), which calls
+ * the callback at most every PROGRESS_INTERVAL seconds and always from the
+ * thread that started the run, and stop early once the run is cancelled.
+ * A run is cancelled when the callback returns PROGRESS_CANCEL or when
+ * progress_cancel() is called, which may be done from any thread.
+ * 
+ * \typedef progress
+ */
+typedef struct Progress{
+	progress_callback callback;		/// Called with the progress of the run, may be NULL
+	void* data;						/// Passed to the callback
+	double lastReport;				/// When the callback was last called
+	int cancelled;					/// Set once the run has been cancelled
+} progress;
+
+/**
+ * @brief Initialise progress without a callback
+ * 
+ * @param p 
+ */
+void progress_init(progress* p);
+
+/**
+ * @brief Set the callback and its data. A NULL callback stops the reporting.
+ * 
+ * @param p 
+ * @param callback 
+ * @param data 
+ */
+void progress_set_callback(progress* p, progress_callback callback, void* data);
+
+/**
+ * @brief Clear the cancellation at the start of a run
+ * 
+ * @param p 
+ */
+void progress_start(progress* p);
+
+/**
+ * @brief Cancel the run. Safe to call from any thread.
+ * 
+ * @param p 
+ */
+void progress_cancel(progress* p);
+
+/**
+ * @brief Check whether the run has been cancelled. p may be NULL.
+ * 
+ * @param p 
+ * @return int 1 if the run has been cancelled, 0 otherwise
+ */
+int progress_cancelled(progress* p);
+
+/**
+ * @brief Report that fraction of the phase is done. The callback is only
+ * called if PROGRESS_INTERVAL seconds have passed since the last call or the
+ * phase is done. p may be NULL.
+ * 
+ * @param p 
+ * @param phase 
+ * @param fraction 
+ * @return int 1 if the run has been cancelled, 0 otherwise
+ */
+int progress_report(progress* p, HDBSCAN_PHASE phase, double fraction);
+
+#ifdef __cplusplus
+};
+}
+#endif
+
+#endif /* PROGRESS_H_ */
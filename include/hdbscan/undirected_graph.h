@@ -35,6 +35,7 @@ extern "C" {
 #include "config.h"
 #include "hdbscan/utils.h"
 #include "listlib/list.h"
+#include "hdbscan/lists.h"
 
 #define GRAPH_SUCCESS 1
 #define GRAPH_ERROR 0
@@ -54,6 +55,16 @@ struct UndirectedGraph {
 	ArrayList* edgeWeights;
 	ArrayList** edges;   				// This is an array of lists
 
+	/**
+	 * Compressed sparse row (CSR) adjacency. When csr is TRUE, edges is NULL and
+	 * the neighbours of vertex v are adjacency[adjOffsets[v] ... adjOffsets[v] + adjSizes[v]).
+	 * Removed edges are swapped past the end of the live range of the vertex.
+	 */
+	boolean csr;
+	size_t* adjOffsets;					// numVertices + 1 offsets into adjacency
+	index_t* adjSizes;					// Number of live neighbours of each vertex
+	index_t* adjacency;					// Neighbours of all vertices in one block
+
 #ifdef __cplusplus
 public:
 	virtual ~UndirectedGraph();
@@ -178,6 +189,24 @@ void graph_swap_edges(UndirectedGraph* g, int64_t indexOne, int64_t indexTwo);
  */
 UndirectedGraph* graph_init(UndirectedGraph* g, index_t numVertices, ArrayList* verticesA, ArrayList* verticesB, ArrayList* edgeWeights) ;
 
+/**
+ * @brief Constructs a new UndirectedGraph with a compact CSR adjacency instead of one
+ * ArrayList per vertex.
+ * 
+ * The adjacency is built with a parallel counting sort over the edge arrays and the
+ * neighbours of each vertex are kept in ascending order so that the layout does not
+ * depend on the number of threads. Edge removal is a swap with the last live neighbour
+ * and never allocates.
+ * 
+ * @param g 
+ * @param numVertices The number of vertices in the graph (indexed 0 to numVertices-1)
+ * @param verticesA An array of vertices corresponding to the array of edges
+ * @param verticesB An array of vertices corresponding to the array of edges
+ * @param edgeWeights An array of edges corresponding to the arrays of vertices
+ * @return UndirectedGraph* 
+ */
+UndirectedGraph* graph_init_csr(UndirectedGraph* g, index_t numVertices, ArrayList* verticesA, ArrayList* verticesB, ArrayList* edgeWeights);
+
 /**
  * @brief Deallocate memory for UndirectedGraph components and for the graph itself
  * 
@@ -200,6 +229,19 @@ void graph_clean(UndirectedGraph* g);
  */
 void graph_quicksort_by_edge_weight(UndirectedGraph* g);
 
+/**
+ * @brief Sorts the graph by edge weight in ascending order with a parallel LSD radix sort.
+ * 
+ * The keys are the IEEE bit patterns of the edge weights, mapped so that unsigned
+ * order matches floating point order, and one byte is sorted per pass. Passes in
+ * which every key has the same digit are skipped. The sort is stable, so edges with
+ * equal weights keep their original relative order and the result is the same for
+ * any number of threads. verticesA and verticesB are permuted through an index array.
+ * 
+ * @param g 
+ */
+void graph_radix_sort_by_edge_weight(UndirectedGraph* g);
+
 // ------------------------------ GETTERS & SETTERS ------------------------------
 
 /**
@@ -252,6 +294,26 @@ distance_t graph_get_edge_weight_at_index(UndirectedGraph* g, int32_t index);
  */
 ArrayList* graph_get_edge_list_for_vertex(UndirectedGraph* g, int32_t vertex);
 
+/**
+ * @brief Rebuild the adjacency of a CSR graph from its edge lists, restoring
+ * every edge taken out with graph_remove_edge(). The edge lists themselves
+ * are not changed, so a sorted graph stays sorted.
+ * 
+ * @param g 
+ * @return int GRAPH_SUCCESS or GRAPH_ERROR if g was not built with graph_init_csr()
+ */
+int graph_reset_edges(UndirectedGraph* g);
+
+/**
+ * @brief Get the neighbours of vertex for either adjacency layout.
+ * 
+ * @param g 
+ * @param vertex 
+ * @param numNeighbours Set to the number of neighbours in the returned array
+ * @return index_t* Pointer to the first neighbour. It is invalidated by graph_remove_edge
+ */
+index_t* graph_get_neighbours(UndirectedGraph* g, index_t vertex, index_t* numNeighbours);
+
 /**
  * @brief Remove vb from edge list of va
  * 
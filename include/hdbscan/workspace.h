@@ -0,0 +1,145 @@
+/*
+ * workspace.h
+ *
+ * Copyright 2024 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/** @file workspace.h */
+#ifndef WORKSPACE_H_
+#define WORKSPACE_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdlib.h>
+
+#define WORKSPACE_SUCCESS 1
+#define WORKSPACE_ERROR 0
+
+/**
+ * Alignment (in bytes) of every buffer handed out by the workspace.
+ */
+#define WORKSPACE_ALIGNMENT 64
+
+#ifdef __cplusplus
+namespace clustering {
+#endif
+
+/**
+ * \struct Workspace
+ * 
+ * @brief A bump arena that hands out scratch buffers from one block of memory.
+ * 
+ * The block only ever grows, so once it has been reserved for a given problem
+ * size, later runs of the same size reuse it instead of allocating their
+ * scratch buffers again. Only those buffers come from the workspace, the
+ * results of a run such as the hierarchy are still allocated on the heap.
+ * Buffers are given back in LIFO order with workspace_release() or all at
+ * once with workspace_reset().
+ * 
+ * \typedef workspace
+ */
+typedef struct Workspace{
+	char* data;				/// The backing memory block
+	size_t capacity;		/// Size of the backing memory block in bytes
+	size_t offset;			/// Number of bytes currently handed out
+} workspace;
+
+/**
+ * @brief Initialise an empty workspace. No memory is reserved until
+ * workspace_reserve() or workspace_alloc() is called.
+ * 
+ * @param ws 
+ * @return workspace* 
+ */
+workspace* workspace_init(workspace* ws);
+
+/**
+ * @brief Make sure the workspace can hold at least capacity bytes. The
+ * backing block is only reallocated when it is too small and nothing is
+ * currently handed out.
+ * 
+ * @param ws 
+ * @param capacity 
+ * @return int WORKSPACE_SUCCESS or WORKSPACE_ERROR
+ */
+int workspace_reserve(workspace* ws, size_t capacity);
+
+/**
+ * @brief Hand out an aligned buffer of the given size. If the workspace
+ * is empty and too small it is grown, otherwise NULL is returned when the
+ * request does not fit.
+ * 
+ * @param ws 
+ * @param bytes 
+ * @return void* 
+ */
+void* workspace_alloc(workspace* ws, size_t bytes);
+
+/**
+ * @brief The number of bytes that workspace_alloc() consumes for a buffer of
+ * the given size, used when computing how much to reserve.
+ * 
+ * @param bytes 
+ * @return size_t 
+ */
+size_t workspace_aligned_size(size_t bytes);
+
+/**
+ * @brief Record the current position so that everything allocated after it
+ * can be returned with workspace_release().
+ * 
+ * @param ws 
+ * @return size_t 
+ */
+size_t workspace_mark(workspace* ws);
+
+/**
+ * @brief Return all the buffers handed out since mark was taken.
+ * 
+ * @param ws 
+ * @param mark 
+ */
+void workspace_release(workspace* ws, size_t mark);
+
+/**
+ * @brief Return all buffers but keep the backing memory for reuse.
+ * 
+ * @param ws 
+ */
+void workspace_reset(workspace* ws);
+
+/**
+ * @brief Free the backing memory.
+ * 
+ * @param ws 
+ */
+void workspace_clean(workspace* ws);
+
+#ifdef __cplusplus
+};
+}
+#endif
+
+#endif /* WORKSPACE_H_ */
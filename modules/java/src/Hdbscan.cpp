@@ -49,6 +49,11 @@ JNIEXPORT void JNICALL Java_hdbscan_Hdbscan_initHdbscan(JNIEnv *env, jobject obj
 }
 
 jintArray getLabelsArray(JNIEnv *env, label_t *lbs, int rows){
+	// A cancelled run has no labels
+	if(lbs == NULL){
+		return NULL;
+	}
+
 	jintArray labels = env->NewIntArray(rows);	
 	int32_t tmp[rows];
 
@@ -93,6 +98,48 @@ JNIEXPORT jintArray JNICALL Java_hdbscan_Hdbscan_reRunImpl(JNIEnv *env, jobject
 	return getLabelsArray(env, scan.clusterLabels, scan.numPoints);
 }
 
+JNIEXPORT jintArray JNICALL Java_hdbscan_Hdbscan_reSelectImpl(JNIEnv *env, jobject obj, jint minClusterSize){
+	scan.reSelect((index_t)minClusterSize);
+	return getLabelsArray(env, scan.clusterLabels, scan.numPoints);
+}
+
+JNIEXPORT void JNICALL Java_hdbscan_Hdbscan_setMinClusterSizeImpl(JNIEnv *env, jobject obj, jint minClusterSize){
+	scan.minClusterSize = (index_t)minClusterSize;
+}
+
 JNIEXPORT void JNICALL Java_hdbscan_Hdbscan_cleanHdbscan(JNIEnv *, jobject){
 	//scan.clean();
 }
+
+JNIEXPORT void JNICALL Java_hdbscan_Hdbscan_enableProfileImpl(JNIEnv *env, jobject obj, jboolean enabled){
+	scan.enableProfile(enabled ? TRUE : FALSE);
+}
+
+JNIEXPORT void JNICALL Java_hdbscan_Hdbscan_cancelImpl(JNIEnv *env, jobject obj){
+	scan.cancel();
+}
+
+JNIEXPORT jobjectArray JNICALL Java_hdbscan_Hdbscan_getPhaseNamesImpl(JNIEnv *env, jobject obj){
+	jobjectArray names = env->NewObjectArray(HDBSCAN_NUM_PHASES, env->FindClass("java/lang/String"), NULL);
+
+	for(int i = 0; i < HDBSCAN_NUM_PHASES; i++){
+		env->SetObjectArrayElement(names, i, env->NewStringUTF(profile_phase_name((HDBSCAN_PHASE)i)));
+	}
+
+	return names;
+}
+
+JNIEXPORT jobjectArray JNICALL Java_hdbscan_Hdbscan_getProfileImpl(JNIEnv *env, jobject obj){
+	jobjectArray phases = env->NewObjectArray(HDBSCAN_NUM_PHASES, env->FindClass("[D"), NULL);
+
+	for(int i = 0; i < HDBSCAN_NUM_PHASES; i++){
+		phase_profile* p = scan.profile.phases + i;
+		jdouble values[] = {p->wallTime, p->cpuTime, (jdouble)p->bytesAllocated, (jdouble)p->peakBytes, (jdouble)p->calls};
+		jdoubleArray row = env->NewDoubleArray(5);
+		env->SetDoubleArrayRegion(row, 0, 5, values);
+		env->SetObjectArrayElement(phases, i, row);
+		env->DeleteLocalRef(row);
+	}
+
+	return phases;
+}
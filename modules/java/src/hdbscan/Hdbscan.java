@@ -56,6 +56,42 @@ public class Hdbscan{
 	 * @return
 	 */
 	private native int[] reRunImpl(int minPoints);
+
+	/**
+	 * 
+	 * @param minClusterSize
+	 * @return
+	 */
+	private native int[] reSelectImpl(int minClusterSize);
+
+	/**
+	 * 
+	 * @param minClusterSize
+	 */
+	private native void setMinClusterSizeImpl(int minClusterSize);
+	
+	/**
+	 * 
+	 * @param enabled
+	 */
+	private native void enableProfileImpl(boolean enabled);
+
+	/**
+	 * 
+	 * @return the names of the phases, in the order of getProfileImpl
+	 */
+	private native String[] getPhaseNamesImpl();
+
+	/**
+	 * 
+	 * @return wallTime, cpuTime, bytesAllocated, peakBytes and calls of each phase
+	 */
+	private native double[][] getProfileImpl();
+
+	/**
+	 * 
+	 */
+	private native void cancelImpl();
 	
 	/**
 	 * Call this method to clean up C allocated memory
@@ -71,6 +107,16 @@ public class Hdbscan{
 		initHdbscan(minPoints);
 	}
 	
+	/**
+	 * 
+	 * @param minPoints
+	 * @param minClusterSize
+	 */
+	public Hdbscan(int minPoints, int minClusterSize){
+		initHdbscan(minPoints);
+		setMinClusterSizeImpl(minClusterSize);
+	}
+	
 	/**
 	 * 
 	 * @param dataset
@@ -87,6 +133,51 @@ public class Hdbscan{
 		labels = reRunImpl(minPts);
 	}
 	
+	/**
+	 * Select the clusters again with a new minimum cluster size without
+	 * recomputing the distances or the minimum spanning tree.
+	 * 
+	 * @param minClusterSize
+	 */
+	public void reSelect(int minClusterSize){
+		labels = reSelectImpl(minClusterSize);
+	}
+	
+	/**
+	 * Cancel the run, rerun or reselect in progress on another thread. The
+	 * cancelled call frees what it has computed and returns null labels.
+	 */
+	public void cancel(){
+		cancelImpl();
+	}
+	
+	/**
+	 * Start or stop recording the time and memory used by each phase of
+	 * the runs. Enabling the profile clears it.
+	 * 
+	 * @param enabled
+	 */
+	public void enableProfile(boolean enabled){
+		enableProfileImpl(enabled);
+	}
+	
+	/**
+	 * 
+	 * @return the profile of each phase, keyed by the name of the phase
+	 */
+	public HashMap<String, PhaseProfile> getProfile(){
+		HashMap<String, PhaseProfile> profile = new HashMap<String, PhaseProfile>();
+		String[] names = getPhaseNamesImpl();
+		double[][] phases = getProfileImpl();
+		
+		for(int i = 0; i < names.length; i++){
+			double[] p = phases[i];
+			profile.put(names[i], new PhaseProfile(p[0], p[1], (long)p[2], (long)p[3], (long)p[4]));
+		}
+		
+		return profile;
+	}
+	
 	/**
 	 * 
 	 * @return
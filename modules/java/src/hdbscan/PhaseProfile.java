@@ -0,0 +1,73 @@
+/*
+ * PhaseProfile.java
+ * 
+ * Copyright 2019 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+package hdbscan;
+
+/**
+ * Time and memory used by one phase of the runs, see hdbscan_profile in
+ * profile.h.
+ */
+public class PhaseProfile{
+	private double wallTime;
+	private double cpuTime;
+	private long bytesAllocated;
+	private long peakBytes;
+	private long calls;
+
+	public PhaseProfile(double wallTime, double cpuTime, long bytesAllocated, long peakBytes, long calls){
+		this.wallTime = wallTime;
+		this.cpuTime = cpuTime;
+		this.bytesAllocated = bytesAllocated;
+		this.peakBytes = peakBytes;
+		this.calls = calls;
+	}
+
+	/**
+	 * @return the elapsed time in seconds
+	 */
+	public double getWallTime(){
+		return this.wallTime;
+	}
+
+	/**
+	 * @return the CPU time of the process in seconds, summed over all threads
+	 */
+	public double getCpuTime(){
+		return this.cpuTime;
+	}
+
+	public long getBytesAllocated(){
+		return this.bytesAllocated;
+	}
+
+	public long getPeakBytes(){
+		return this.peakBytes;
+	}
+
+	public long getCalls(){
+		return this.calls;
+	}
+}
@@ -31,6 +31,22 @@ JNIEXPORT jintArray JNICALL Java_hdbscan_Hdbscan_runImpl
 JNIEXPORT jintArray JNICALL Java_hdbscan_Hdbscan_reRunImpl
   (JNIEnv *, jobject, jint);
 
+/*
+ * Class:     hdbscan_Hdbscan
+ * Method:    reSelectImpl
+ * Signature: (I)[I
+ */
+JNIEXPORT jintArray JNICALL Java_hdbscan_Hdbscan_reSelectImpl
+  (JNIEnv *, jobject, jint);
+
+/*
+ * Class:     hdbscan_Hdbscan
+ * Method:    setMinClusterSizeImpl
+ * Signature: (I)V
+ */
+JNIEXPORT void JNICALL Java_hdbscan_Hdbscan_setMinClusterSizeImpl
+  (JNIEnv *, jobject, jint);
+
 /*
  * Class:     hdbscan_Hdbscan
  * Method:    cleanHdbscan
@@ -39,6 +55,38 @@ JNIEXPORT jintArray JNICALL Java_hdbscan_Hdbscan_reRunImpl
 JNIEXPORT void JNICALL Java_hdbscan_Hdbscan_cleanHdbscan
   (JNIEnv *, jobject);
 
+/*
+ * Class:     hdbscan_Hdbscan
+ * Method:    enableProfileImpl
+ * Signature: (Z)V
+ */
+JNIEXPORT void JNICALL Java_hdbscan_Hdbscan_enableProfileImpl
+  (JNIEnv *, jobject, jboolean);
+
+/*
+ * Class:     hdbscan_Hdbscan
+ * Method:    getPhaseNamesImpl
+ * Signature: ()[Ljava/lang/String;
+ */
+JNIEXPORT jobjectArray JNICALL Java_hdbscan_Hdbscan_getPhaseNamesImpl
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     hdbscan_Hdbscan
+ * Method:    getProfileImpl
+ * Signature: ()[[D
+ */
+JNIEXPORT jobjectArray JNICALL Java_hdbscan_Hdbscan_getProfileImpl
+  (JNIEnv *, jobject);
+
+/*
+ * Class:     hdbscan_Hdbscan
+ * Method:    cancelImpl
+ * Signature: ()V
+ */
+JNIEXPORT void JNICALL Java_hdbscan_Hdbscan_cancelImpl
+  (JNIEnv *, jobject);
+
 #ifdef __cplusplus
 }
 #endif
@@ -37,69 +37,69 @@
 extern "C" {
 #endif
 
+#include <stdint.h>
 #include "list.h"
 #include "set.h"
 #include "primes.h"
 #include "hdbscan/utils.h"
 
-/*!
- * \struct HTBL_ENTRY
- * \brief The entry into the buckets
- * 
- * This structure will be the wrapper for the data in the
- * hashtable. The structure is designed to handle any bucket
- * collisions by maintaining links to other  entries in the
- * same bucket.
- * 
- * \typedef hashtable_entry
- */
-typedef struct HTBL_ENTRY
-{
-    void* key;                  //! The key for the data
-    void* data;                 //! The data associated with the key
-    int32_t (*key_compare)(const void *a, const void *b);
-    struct HTBL_ENTRY *next;    //! The pointer to the next hashtable entry in case there are collisions in the bucket
-    struct HTBL_ENTRY *prev;    //! The pointer the the preceding entry if this entry is not the first one in the bucket
-} hashtable_entry;
-
 /**
  * \struct HASHTABLE_
  * \brief The structure of the hashtable. 
  * 
- * We are implementing this as a
- * chained hash table. The structure of the hashtable is such that
- * the buckects are made up of a pointer ArrayList. The contents 
- * of each bucket are linkedlist's in which each node contains a
- * a key which is an int and an Arraylist value whose content datatype
- * is determined by the HTYPES enum.
+ * We are implementing this as an open addressing table with Robin Hood
+ * linear probing. The entries are stored inline in one flat array of slots
+ * so there is no allocation per entry. A slot holds the key, the value at
+ * dataOffset and the probe distance at probeOffset, padded so that keys and
+ * values stay aligned, so a probe touches a single cache line. The probe
+ * distance is the number of slots the entry sits after its home slot plus
+ * one, with 0 marking an empty slot. An insert takes the slot of any entry
+ * that is closer to its home than the new one, which keeps the probe
+ * sequences short and lets a lookup stop as soon as it meets an entry that
+ * is closer to home than the key would be. The number of slots is a power
+ * of two and doubles when the table is more than 7/8 full.
+ * 
+ * Growing is incremental. The full slots are kept as the old table and
+ * every insert or remove moves a few of its entries to the new one, so no
+ * single insert pays for the whole rehash. Until the old table is empty a
+ * key is looked for in both. Lookups never move entries, so concurrent
+ * lookups are still safe.
  * 
  * \typedef hashtable
  */ 
 typedef struct HASHTABLE_
 {
-    size_t buckets;            //! Number of buckets in the table
+    size_t buckets;            //! Number of slots in the table, always a power of two
     size_t size;               //! The size of table
     enum HTYPES ktype;               //! The type of the data of the keys
     enum HTYPES dtype;               //! The type of the data of the values
-    hashtable_entry** table;           //! An array list for storing linked list pointers.
-    set_t* keys;                //! A set of all the keys in the table.
-    int32_t collisions;         //! For diagnostic information on the collision
+    size_t ksize;              //! The size of a key
+    size_t dsize;              //! The size of a value
+    size_t slotSize;           //! The size of a slot
+    size_t dataOffset;         //! Where the value starts in a slot
+    size_t probeOffset;        //! Where the probe distance byte is in a slot
+    char* slots;               //! The slots of the table
+    size_t oldBuckets;         //! Number of slots of the table that is being rehashed, 0 when there is none
+    char* oldSlots;            //! The slots of the table that is being rehashed
+    size_t rehashed;           //! The number of old slots that have been emptied
+    set_t* keys;                //! The keys of the table in sorted order, only up to date after hashtable_keys()
+    int32_t keysStale;          //! 1 when keys has not been rebuilt since the table last changed
+    int32_t collisions;         //! For diagnostic information, the number of inserts that did not land in their home slot
     int32_t (*key_compare)(const void *a, const void *b);
     void (*key_deallocate)(void *key);
-    size_t (*key_hash)(void* key, size_t buckets);
 } hashtable;
 
 /*!
- * \brief Initialise a chained hash table.
+ * \brief Initialise a hash table.
  * 
- * \param buckets - number of possible locations to hash to
+ * \param buckets - the expected number of entries, the table grows when it is exceeded
  * \param type    - the type of data
  * \return hashtable* 
  */ 
 hashtable* hashtable_init(size_t buckets, enum HTYPES ktype, enum HTYPES dtype, int32_t (*compare)(const void *a, const void *b));
 
 /*!
- * \brief Initialise a chained hash table with an actual number of buckets.
+ * \brief Initialise a hash table with at least buckets slots.
  * 
  * \param buckets 
  * \param ktype 
@@ -173,6 +173,20 @@ int32_t hashtable_destroy(hashtable* htbl, void (*key_destroy)(void *key), void
  */
 size_t hashtable_size(hashtable* htbl);
 
+/*!
+ * \brief Get the keys of the table in sorted order.
+ * 
+ * Inserts and removes do not keep the set up to date, it is rebuilt from
+ * the slots on the first call after the table changed, in O(n log n). The
+ * set belongs to the table and is valid until the next insert, remove or
+ * clear. Like inserts this is not safe to call concurrently, so call it
+ * before a parallel region that walks the keys.
+ * 
+ * \param htbl 
+ * \return set_t* NULL if the set could not be rebuilt
+ */
+set_t* hashtable_keys(hashtable* htbl);
+
 /*!
  * \brief Check if the hashtable is empty
  * 
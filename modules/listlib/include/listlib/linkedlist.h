@@ -53,6 +53,30 @@ typedef struct NODE
     void *data;
 } node; /**\typedef node */
 
+/**
+ * @brief Payloads of at most this many bytes are stored inline, right after
+ * their node in the same slab, instead of in their own allocation
+ */
+#define LINKEDLIST_INLINE_SIZE 64
+
+/**
+ * \struct NODE_POOL
+ * @brief The nodes of a linked list are carved out of slabs instead of being
+ * allocated one at a time. A slab holds twice as many nodes as the one
+ * before it, up to a limit, and starts with a pointer to the previous slab so
+ * they can all be freed together. Nodes that are removed from the list go on
+ * a free list and are handed out again before the slab is used.
+ */
+typedef struct NODE_POOL
+{
+    size_t nodeSize;    /// The size of a node and its inline payload
+    size_t slabNodes;   /// The number of nodes in the current slab
+    size_t used;        /// The number of nodes handed out of the current slab
+    char* slab;         /// The current slab
+    node* freeNodes;    /// Nodes that can be handed out again
+    int32_t inlineData; /// Whether payloads live in the node
+} node_pool; /**\typedef node_pool */
+
 /*****************************************************************************************
  * \struct LINKEDLIST
  * @brief Linked list implementation
@@ -64,6 +88,7 @@ typedef struct LINKEDLIST
     int32_t size;
     node* head;
     node* tail;
+    node_pool pool;
 } linkedlist; /**\typedef linkedlist */
 
 /**
@@ -138,6 +163,9 @@ node* linkedlist_lookup_helper(linkedlist *list, void* data, int32_t (*d_compare
 /**
  * @brief Find the key in the data
  * 
+ * The data of a node that is removed this way stays valid until
+ * the list is cleared or deleted.
+ * 
  * @param list 
  * @param key 
  * @param remove 
@@ -194,6 +222,9 @@ void linkedlist_delete(linkedlist* list);
 /**
  * @brief Clear the linked list of all the data
  * 
+ * With inline payloads the nodes are released a slab at a time
+ * without visiting them.
+ * 
  * @param list - the linkedlist to clear
  */ 
 void linkedlist_clear(linkedlist* list);
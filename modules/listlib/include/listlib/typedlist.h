@@ -0,0 +1,224 @@
+/**
+ * Copyright 2019 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*!
+ * \file typedlist.h
+ *
+ * Typed access to an ArrayList. The functions in list.h copy every
+ * element through a void* with memcpy(list->step) and order elements
+ * through the compare function pointer of the list, which is more than
+ * the hot loops need when the type of the elements is known. The macros
+ * in this file generate static inline functions for one element type
+ * that work on the same ArrayList structure, so a list made with
+ * array_list_init() can be used with both and is still freed with
+ * array_list_delete().
+ *
+ * LISTLIB_TYPED_LIST(name, type) generates
+ *
+ *   - name##_list_init(initial_size)
+ *   - name##_list_data(list)
+ *   - name##_list_at(list, pos)
+ *   - name##_list_set(list, pos, value)
+ *   - name##_list_reserve(list, size)
+ *   - name##_list_append(list, value)
+ *   - name##_list_pop(list, &value)
+ *
+ * and LISTLIB_ORDERED_LIST(name, type) adds name##_list_find() and
+ * name##_list_sort() for types that can be compared with < and ==.
+ */
+
+#ifndef TYPEDLIST_H_
+#define TYPEDLIST_H_
+
+#include "listlib/list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Ranges of at most this many elements are sorted with insertion sort
+ */
+#define LISTLIB_INSERTION_SORT_SIZE 16
+
+/**
+ * @brief Generate the typed access functions of lists of type.
+ *
+ * The list must have been created with a step of sizeof(type). Reading and
+ * writing are only checked with assert, like an array. Appending grows the
+ * list with array_list_grow(), doubling its capacity.
+ */
+#define LISTLIB_TYPED_LIST(name, type)                                              \
+static inline ArrayList* name##_list_init(size_t initial_size)                      \
+{                                                                                   \
+    return array_list_init(initial_size, sizeof(type), NULL);                       \
+}                                                                                   \
+                                                                                    \
+static inline type* name##_list_data(ArrayList* list)                               \
+{                                                                                   \
+    assert(list->step == sizeof(type));                                             \
+    return (type *)list->data;                                                      \
+}                                                                                   \
+                                                                                    \
+static inline type name##_list_at(ArrayList* list, size_t pos)                      \
+{                                                                                   \
+    assert(pos < list->size);                                                       \
+    return name##_list_data(list)[pos];                                             \
+}                                                                                   \
+                                                                                    \
+static inline void name##_list_set(ArrayList* list, size_t pos, type value)         \
+{                                                                                   \
+    assert(pos < list->size);                                                       \
+    name##_list_data(list)[pos] = value;                                            \
+}                                                                                   \
+                                                                                    \
+static inline int32_t name##_list_reserve(ArrayList* list, size_t size)             \
+{                                                                                   \
+    while(list->max_size < size)                                                    \
+    {                                                                               \
+        if(array_list_grow(list) < 0)                                               \
+        {                                                                           \
+            return 0;                                                               \
+        }                                                                           \
+    }                                                                               \
+                                                                                    \
+    return 1;                                                                       \
+}                                                                                   \
+                                                                                    \
+static inline int32_t name##_list_append(ArrayList* list, type value)               \
+{                                                                                   \
+    if(list->size == list->max_size && array_list_grow(list) < 0)                   \
+    {                                                                               \
+        return 0;                                                                   \
+    }                                                                               \
+                                                                                    \
+    name##_list_data(list)[list->size++] = value;                                   \
+    return 1;                                                                       \
+}                                                                                   \
+                                                                                    \
+static inline int32_t name##_list_pop(ArrayList* list, type* value)                 \
+{                                                                                   \
+    if(list == NULL || list->size == 0)                                             \
+    {                                                                               \
+        return -1;                                                                  \
+    }                                                                               \
+                                                                                    \
+    *value = name##_list_data(list)[--list->size];                                  \
+    return 1;                                                                       \
+}
+
+/**
+ * @brief Generate find and sort for lists of type, comparing the elements
+ * directly instead of through the compare function of the list. Needs the
+ * functions of LISTLIB_TYPED_LIST(name, type).
+ */
+#define LISTLIB_ORDERED_LIST(name, type)                                            \
+static inline int64_t name##_list_find(ArrayList* list, type value, int32_t sorted) \
+{                                                                                   \
+    type* data = name##_list_data(list);                                            \
+    if(sorted == 1)                                                                 \
+    {                                                                               \
+        size_t l = 0, r = list->size;                                               \
+        while(l < r)                                                                \
+        {                                                                           \
+            size_t mid = l + (r - l) / 2;                                           \
+            if(data[mid] < value)                                                   \
+            {                                                                       \
+                l = mid + 1;                                                        \
+            } else {                                                                \
+                r = mid;                                                            \
+            }                                                                       \
+        }                                                                           \
+                                                                                    \
+        return l < list->size && data[l] == value ? (int64_t)l : -1;                \
+    }                                                                               \
+                                                                                    \
+    for(size_t i = 0; i < list->size; i++)                                          \
+    {                                                                               \
+        if(data[i] == value)                                                        \
+        {                                                                           \
+            return (int64_t)i;                                                      \
+        }                                                                           \
+    }                                                                               \
+                                                                                    \
+    return -1;                                                                      \
+}                                                                                   \
+                                                                                    \
+static inline void name##_sort_range(type* data, size_t left, size_t right)         \
+{                                                                                   \
+    /* Quicksort the larger part in the loop and recurse into the smaller */        \
+    while(right - left > LISTLIB_INSERTION_SORT_SIZE)                               \
+    {                                                                               \
+        size_t mid = left + (right - left) / 2;                                     \
+        type a = data[left], b = data[mid], c = data[right - 1];                    \
+        type pivot = a < b ? (b < c ? b : (a < c ? c : a))                          \
+                           : (a < c ? a : (b < c ? c : b));                         \
+                                                                                    \
+        size_t i = left, j = right - 1;                                             \
+        for(;;)                                                                     \
+        {                                                                           \
+            while(data[i] < pivot) i++;                                             \
+            while(pivot < data[j]) j--;                                             \
+            if(i >= j)                                                              \
+            {                                                                       \
+                break;                                                              \
+            }                                                                       \
+                                                                                    \
+            type tmp = data[i];                                                     \
+            data[i++] = data[j];                                                    \
+            data[j--] = tmp;                                                        \
+        }                                                                           \
+                                                                                    \
+        /* data[left, j] <= pivot <= data[j + 1, right) */                          \
+        if(j + 1 - left < right - j - 1)                                            \
+        {                                                                           \
+            name##_sort_range(data, left, j + 1);                                   \
+            left = j + 1;                                                           \
+        } else {                                                                    \
+            name##_sort_range(data, j + 1, right);                                  \
+            right = j + 1;                                                          \
+        }                                                                           \
+    }                                                                               \
+                                                                                    \
+    for(size_t i = left + 1; i < right; i++)                                        \
+    {                                                                               \
+        type value = data[i];                                                       \
+        size_t j = i;                                                               \
+        for(; j > left && value < data[j - 1]; j--)                                 \
+        {                                                                           \
+            data[j] = data[j - 1];                                                  \
+        }                                                                           \
+        data[j] = value;                                                            \
+    }                                                                               \
+}                                                                                   \
+                                                                                    \
+static inline void name##_list_sort(ArrayList* list)                                \
+{                                                                                   \
+    name##_sort_range(name##_list_data(list), 0, list->size);                       \
+}
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* TYPEDLIST_H_ */
@@ -32,7 +32,7 @@
  * 
  * \author Onalenna Junior Makhura (ojmakhura@roguesystems.co.bw)
  * 
- * \brief Implementation of the chained hashtable
+ * \brief Implementation of the open addressing hashtable
  * 
  * \date 2019-06-10
  * 
@@ -48,47 +48,504 @@
 #ifdef _OPENMP
 #include <omp.h>
 #endif
+
+/**
+ * @brief The smallest number of slots in a table
+ */
+#define HASHTABLE_MIN_BUCKETS 8
+
+/**
+ * @brief The largest probe distance a slot can record
+ */
+#define HASHTABLE_MAX_PROBE UINT8_MAX
+
+/**
+ * @brief The number of entries a table of buckets slots can hold before it grows
+ */
+#define HASHTABLE_MAX_LOAD(buckets) ((buckets) - (buckets) / 8)
+
+/**
+ * @brief The number of old slots every insert or remove moves while rehashing.
+ * A rehash starts with the old table 7/8 full and the new one has room for
+ * 7/8 of the old size more, so anything above 1 finishes the move in time.
+ */
+#define HASHTABLE_REHASH_STEP 8
+
+/**
+ * @brief The number of words of the largest slot, an 8 byte key and value
+ * followed by the probe byte
+ */
+#define HASHTABLE_MAX_SLOT 3
+
+/**
+ * @brief One array of slots, either the table or the old table being rehashed
+ */
+typedef struct
+{
+    size_t buckets;
+    char* slots;
+} hashtable_slots;
+
 /**
- * @brief Create or set a hashtable entry data and key
+ * @brief The slots new entries go to
  * 
  * @param htbl 
- * @param entry 
- * @param key 
- * @param data 
- * @return hashtable_entry* 
+ * @return hashtable_slots 
  */
-hashtable_entry* hashtable_set_entry(hashtable* htbl, hashtable_entry *entry, void* key, void* data);
+static inline hashtable_slots hashtable_current(hashtable* htbl)
+{
+    hashtable_slots slots = {htbl->buckets, htbl->slots};
+    return slots;
+}
 
 /**
- * @brief Destroy a hashtable entry
+ * @brief The slots that are being rehashed
  * 
  * @param htbl 
- * @param entry 
+ * @return hashtable_slots 
+ */
+static inline hashtable_slots hashtable_old(hashtable* htbl)
+{
+    hashtable_slots slots = {htbl->oldBuckets, htbl->oldSlots};
+    return slots;
+}
+
+/**
+ * @brief The slot at pos
+ * 
+ * @param htbl 
+ * @param slots 
+ * @param pos 
+ * @return char* 
+ */
+static inline char* hashtable_slot(hashtable* htbl, hashtable_slots* slots, size_t pos)
+{
+    return slots->slots + pos * htbl->slotSize;
+}
+
+/**
+ * @brief The probe distance of a slot, 0 when the slot is empty
+ * 
+ * @param htbl 
+ * @param slot 
+ * @return uint8_t 
  */
-void hashtable_entry_destroy(hashtable_entry *entry, void* data, size_t dsize);
+static inline uint8_t hashtable_probe(hashtable* htbl, const char* slot)
+{
+    return *(const uint8_t *)(slot + htbl->probeOffset);
+}
+
+/**
+ * @brief Set the probe distance of a slot
+ * 
+ * @param htbl 
+ * @param slot 
+ * @param dist 
+ */
+static inline void hashtable_set_probe(hashtable* htbl, char* slot, uint32_t dist)
+{
+    *(uint8_t *)(slot + htbl->probeOffset) = (uint8_t)dist;
+}
 
 /**
- * @brief Look for the key in htbl
+ * @brief Hash the key. Integer and floating point keys are hashed straight from
+ * their value, strings from their characters and anything else from its bytes.
  * 
  * @param htbl 
  * @param key 
- * @return hashtable_entry* 
+ * @return size_t 
  */
-hashtable_entry* hashtable_lookup_entry(hashtable* htbl, void* key);
+static inline size_t hashtable_hash(hashtable* htbl, void* key)
+{
+    switch(htbl->ktype)
+    {
+        case H_INT:
+            return hash_mix((uint64_t)(uint32_t)*(int32_t *)key);
+        case H_LONG:
+            return hash_mix((uint64_t)*(long *)key);
+        case H_SHORT:
+            return hash_mix((uint64_t)(uint16_t)*(short *)key);
+        case H_CHAR:
+            return hash_mix((uint64_t)*(unsigned char *)key);
+        case H_DOUBLE:
+            return double_hash(key, SIZE_MAX);
+        case H_FLOAT:
+            return float_hash(key, SIZE_MAX);
+        case H_STRING:
+        {
+            // FNV-1a over the characters
+            uint64_t h = 14695981039346656037ULL;
+            for(const unsigned char* c = *(const unsigned char **)key; c != NULL && *c != '\0'; c++)
+            {
+                h = (h ^ *c) * 1099511628211ULL;
+            }
+            return hash_mix(h);
+        }
+        default:
+        {
+            uint64_t bits = 0;
+            memcpy(&bits, key, htbl->ksize < sizeof(bits) ? htbl->ksize : sizeof(bits));
+            return hash_mix(bits);
+        }
+    }
+}
 
 /**
- * @brief 
+ * @brief Check if two keys are equal. Integer keys are compared directly, the
+ * others with the compare function of the table.
  * 
+ * @param htbl 
  * @param a 
  * @param b 
  * @return int32_t 
  */
-int32_t hashtable_entry_compare(const void* a, const void* b)
+static inline int32_t hashtable_key_equals(hashtable* htbl, const void* a, const void* b)
+{
+    switch(htbl->ktype)
+    {
+        case H_INT:
+            return *(const int32_t *)a == *(const int32_t *)b;
+        case H_LONG:
+            return *(const long *)a == *(const long *)b;
+        case H_SHORT:
+            return *(const short *)a == *(const short *)b;
+        case H_CHAR:
+            return *(const char *)a == *(const char *)b;
+        default:
+            return htbl->key_compare(a, b) == 0;
+    }
+}
+
+/**
+ * @brief Allocate buckets empty slots.
+ * 
+ * @param htbl 
+ * @param slots 
+ * @param buckets A power of two
+ * @return int32_t 1 on success and 0 otherwise
+ */
+static int32_t hashtable_alloc_slots(hashtable* htbl, hashtable_slots* slots, size_t buckets)
+{
+    slots->buckets = buckets;
+    slots->slots = (char *)hdbscan_calloc(buckets, htbl->slotSize);
+
+    return slots->slots != NULL;
+}
+
+/**
+ * @brief Make slots the current slots of the table
+ * 
+ * @param htbl 
+ * @param slots 
+ */
+static void hashtable_set_current(hashtable* htbl, hashtable_slots* slots)
+{
+    htbl->buckets = slots->buckets;
+    htbl->slots = slots->slots;
+}
+
+/**
+ * @brief Forget the old slots without freeing them
+ * 
+ * @param htbl 
+ */
+static void hashtable_reset_old(hashtable* htbl)
+{
+    htbl->oldBuckets = 0;
+    htbl->oldSlots = NULL;
+    htbl->rehashed = 0;
+}
+
+/**
+ * @brief Find the slot of the key.
+ * 
+ * @param htbl 
+ * @param slots 
+ * @param key 
+ * @param hash The hash of the key
+ * @return int64_t The slot or -1 if the key is not in the slots
+ */
+static int64_t hashtable_find_slot(hashtable* htbl, hashtable_slots* slots, void* key, size_t hash)
+{
+    if(slots->buckets == 0)
+    {
+        return -1;
+    }
+
+    size_t mask = slots->buckets - 1;
+    size_t pos = hash & mask;
+    char* slot = hashtable_slot(htbl, slots, pos);
+
+    // Every entry met before an empty slot or an entry closer to its home than
+    // the key would be could be the key
+    for(uint32_t dist = 1; hashtable_probe(htbl, slot) >= dist; dist++)
+    {
+        if(hashtable_key_equals(htbl, slot, key))
+        {
+            return (int64_t)pos;
+        }
+
+        pos = (pos + 1) & mask;
+        slot = hashtable_slot(htbl, slots, pos);
+    }
+
+    return -1;
+}
+
+/**
+ * @brief Put an entry whose key is not in the slots into its slot, moving
+ * entries that are closer to their home slots further along. If an entry
+ * would end up more than HASHTABLE_MAX_PROBE slots from its home, it is left
+ * in entry to be placed after the table has grown.
+ * 
+ * @param htbl 
+ * @param slots 
+ * @param entry A slot sized buffer holding the key and value
+ * @param hash The hash of the key
+ * @return int32_t 1 if everything was placed and 0 otherwise
+ */
+static int32_t hashtable_place(hashtable* htbl, hashtable_slots* slots, char* entry, size_t hash)
+{
+    size_t mask = slots->buckets - 1;
+    size_t pos = hash & mask;
+    uint64_t tmp[HASHTABLE_MAX_SLOT];
+
+    hashtable_set_probe(htbl, entry, 1);
+    while(hashtable_probe(htbl, entry) < HASHTABLE_MAX_PROBE)
+    {
+        char* slot = hashtable_slot(htbl, slots, pos);
+
+        if(hashtable_probe(htbl, slot) == 0)
+        {
+            memcpy(slot, entry, htbl->slotSize);
+            return 1;
+        }
+
+        if(hashtable_probe(htbl, slot) < hashtable_probe(htbl, entry))
+        {
+            // Take the place of the richer entry and carry it on
+            memcpy(tmp, slot, htbl->slotSize);
+            memcpy(slot, entry, htbl->slotSize);
+            memcpy(entry, tmp, htbl->slotSize);
+        }
+
+        pos = (pos + 1) & mask;
+        hashtable_set_probe(htbl, entry, hashtable_probe(htbl, entry) + 1u);
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Empty the slot at pos, shifting the entries after it back until one
+ * that is in its home slot, so no tombstones are needed.
+ * 
+ * @param htbl 
+ * @param slots 
+ * @param pos 
+ */
+static void hashtable_remove_at(hashtable* htbl, hashtable_slots* slots, size_t pos)
+{
+    size_t mask = slots->buckets - 1;
+    char* slot = hashtable_slot(htbl, slots, pos);
+    char* next = hashtable_slot(htbl, slots, (pos + 1) & mask);
+
+    while(hashtable_probe(htbl, next) > 1)
+    {
+        memcpy(slot, next, htbl->slotSize);
+        hashtable_set_probe(htbl, slot, hashtable_probe(htbl, next) - 1u);
+
+        pos = (pos + 1) & mask;
+        slot = next;
+        next = hashtable_slot(htbl, slots, (pos + 1) & mask);
+    }
+
+    hashtable_set_probe(htbl, slot, 0);
+}
+
+/**
+ * @brief Put every entry of the table and of the old table into buckets new
+ * slots, doubling them until every entry fits. This is only needed when a key
+ * probes too far, the normal growth is incremental.
+ * 
+ * @param htbl 
+ * @param buckets 
+ * @return int32_t 1 on success and 0 otherwise
+ */
+static int32_t hashtable_rebuild(hashtable* htbl, size_t buckets)
+{
+    hashtable_slots from[2] = {hashtable_current(htbl), hashtable_old(htbl)};
+    hashtable_slots slots;
+    int32_t placed = 0;
+    uint64_t entry[HASHTABLE_MAX_SLOT];
+
+    while(!placed)
+    {
+        if(!hashtable_alloc_slots(htbl, &slots, buckets))
+        {
+            logger_write(FATAL, "Hash table slot memory allocation failed\n");
+            return 0;
+        }
+
+        placed = 1;
+        for(int32_t t = 0; t < 2 && placed; t++)
+        {
+            for(size_t i = 0; i < from[t].buckets && placed; i++)
+            {
+                char* slot = hashtable_slot(htbl, from + t, i);
+                if(hashtable_probe(htbl, slot) != 0)
+                {
+                    memcpy(entry, slot, htbl->slotSize);
+                    placed = hashtable_place(htbl, &slots, (char *)entry, hashtable_hash(htbl, entry));
+                }
+            }
+        }
+
+        // Some key still probes too far, so try again with more slots
+        if(!placed)
+        {
+            hdbscan_free(slots.slots);
+            buckets *= 2;
+        }
+    }
+
+    hdbscan_free(from[0].slots);
+    hdbscan_free(from[1].slots);
+
+    hashtable_set_current(htbl, &slots);
+    hashtable_reset_old(htbl);
+
+    return 1;
+}
+
+/**
+ * @brief Place the entry in the current slots, rebuilding the table with more
+ * slots for as long as it does not fit.
+ * 
+ * @param htbl 
+ * @param entry 
+ * @param hash The hash of the key in entry
+ * @return int32_t 1 on success and 0 otherwise
+ */
+static int32_t hashtable_place_or_rebuild(hashtable* htbl, char* entry, size_t hash)
+{
+    hashtable_slots slots = hashtable_current(htbl);
+
+    if(hashtable_place(htbl, &slots, entry, hash))
+    {
+        return 1;
+    }
+
+    // The rebuild takes every entry that is in the slots, the one that was
+    // left over is placed after it with its own hash
+    do
+    {
+        if(!hashtable_rebuild(htbl, htbl->buckets * 2))
+        {
+            return 0;
+        }
+
+        slots = hashtable_current(htbl);
+    } while(!hashtable_place(htbl, &slots, (char *)entry, hashtable_hash(htbl, entry)));
+
+    return 1;
+}
+
+/**
+ * @brief Move the entries of up to HASHTABLE_REHASH_STEP old slots to the
+ * current slots and free the old slots once they are empty.
+ * 
+ * @param htbl 
+ * @return int32_t 1 on success and 0 otherwise
+ */
+static int32_t hashtable_rehash_step(hashtable* htbl)
+{
+    uint64_t entry[HASHTABLE_MAX_SLOT];
+
+    for(int32_t step = 0; step < HASHTABLE_REHASH_STEP && htbl->oldBuckets > 0; step++)
+    {
+        if(htbl->rehashed == htbl->oldBuckets)
+        {
+            hdbscan_free(htbl->oldSlots);
+            hashtable_reset_old(htbl);
+            break;
+        }
+
+        hashtable_slots old = hashtable_old(htbl);
+        char* slot = hashtable_slot(htbl, &old, htbl->rehashed);
+        if(hashtable_probe(htbl, slot) == 0)
+        {
+            htbl->rehashed++;
+            continue;
+        }
+
+        // Removing the entry may shift the next one into this slot, so it is
+        // looked at again on the next step
+        memcpy(entry, slot, htbl->slotSize);
+        hashtable_remove_at(htbl, &old, htbl->rehashed);
+
+        if(!hashtable_place_or_rebuild(htbl, (char *)entry, hashtable_hash(htbl, entry)))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Make the current slots the old ones and start filling twice as many.
+ * 
+ * @param htbl 
+ * @return int32_t 1 on success and 0 otherwise
+ */
+static int32_t hashtable_start_rehash(hashtable* htbl)
+{
+    // A rehash that is still going is finished in one go first
+    while(htbl->oldBuckets > 0)
+    {
+        if(!hashtable_rehash_step(htbl))
+        {
+            return 0;
+        }
+    }
+
+    hashtable_slots slots;
+    if(!hashtable_alloc_slots(htbl, &slots, htbl->buckets * 2))
+    {
+        logger_write(FATAL, "Hash table slot memory allocation failed\n");
+        return 0;
+    }
+
+    htbl->oldBuckets = htbl->buckets;
+    htbl->oldSlots = htbl->slots;
+    htbl->rehashed = 0;
+    hashtable_set_current(htbl, &slots);
+
+    return 1;
+}
+
+/**
+ * @brief Find the key in the current or the old slots.
+ * 
+ * @param htbl 
+ * @param key 
+ * @param hash The hash of the key
+ * @param slots Set to the slots the key is in
+ * @return char* The slot of the key or NULL if the key is not in the table
+ */
+static char* hashtable_find(hashtable* htbl, void* key, size_t hash, hashtable_slots* slots)
 {
-    hashtable_entry* e1 = *(hashtable_entry **)a;
-    hashtable_entry* e2 = *(hashtable_entry **)b;
+    *slots = hashtable_current(htbl);
+    int64_t pos = hashtable_find_slot(htbl, slots, key, hash);
+
+    if(pos < 0 && htbl->oldBuckets > 0)
+    {
+        *slots = hashtable_old(htbl);
+        pos = hashtable_find_slot(htbl, slots, key, hash);
+    }
 
-    return e1->key_compare(e1->key, e2->key);
+    return pos < 0 ? NULL : hashtable_slot(htbl, slots, (size_t)pos);
 }
 
 /**
@@ -101,7 +558,8 @@ int32_t hashtable_entry_compare(const void* a, const void* b)
  */
 hashtable* hashtable_init(size_t buckets, enum HTYPES ktype, enum HTYPES dtype, int32_t (*compare)(const void *a, const void *b))
 {
-    return hashtable_init_size((size_t)find_prime_less_than((int32_t)buckets), ktype, dtype, compare);
+    // Leave room for the expected number of entries below the load limit
+    return hashtable_init_size(buckets + buckets / 7, ktype, dtype, compare);
 }
 
 /**
@@ -115,7 +573,7 @@ hashtable* hashtable_init(size_t buckets, enum HTYPES ktype, enum HTYPES dtype,
  */
 hashtable* hashtable_init_size(size_t buckets, enum HTYPES ktype, enum HTYPES dtype, int32_t (*compare)(const void *a, const void *b))
 {
-    hashtable* htbl = (hashtable *)malloc(sizeof(hashtable));
+    hashtable* htbl = (hashtable *)hdbscan_malloc(sizeof(hashtable));
 
     if(htbl == NULL)
     {
@@ -123,56 +581,40 @@ hashtable* hashtable_init_size(size_t buckets, enum HTYPES ktype, enum HTYPES dt
         return NULL;
     }
 
-    htbl->buckets = buckets;
-    if(buckets <= 0)
+    size_t size = HASHTABLE_MIN_BUCKETS;
+    while(size < buckets)
     {
-        htbl->buckets = 37;
+        size *= 2;
     }
 
     htbl->ktype = ktype;
     htbl->dtype = dtype;
-
-    // Make sure all buckets are NULL
-    htbl->table = calloc(htbl->buckets, sizeof(hashtable_entry *));
-    if(htbl->table == NULL)
+    htbl->ksize = get_htype_size(ktype);
+    htbl->dsize = get_htype_size(dtype);
+    // Keys and values are powers of two in size, so the value is aligned
+    // after padding the key to its size and the slot to the larger of both
+    size_t align = htbl->ksize > htbl->dsize ? htbl->ksize : htbl->dsize;
+    htbl->dataOffset = (htbl->ksize + htbl->dsize - 1) / htbl->dsize * htbl->dsize;
+    htbl->probeOffset = htbl->dataOffset + htbl->dsize;
+    htbl->slotSize = (htbl->probeOffset + align) / align * align;
+
+    hashtable_slots slots;
+    if(!hashtable_alloc_slots(htbl, &slots, size))
     {
-        logger_write(FATAL, "Hash table bucket memory allocation failed\n");
-        free(htbl);
+        logger_write(FATAL, "Hash table slot memory allocation failed\n");
+        hdbscan_free(htbl);
         return NULL;
     }
 
+    hashtable_set_current(htbl, &slots);
+    hashtable_reset_old(htbl);
+
     htbl->size = 0;
     htbl->collisions = 0;
     htbl->key_compare = compare;
-    htbl->keys = set_init(get_htype_size(htbl->ktype), compare);
-
-    /**
-     * @brief Determine the function to use for key hashing
-     * 
-     */
-    if(htbl->ktype == H_INT) 
-    {
-        htbl->key_hash = int_hash;
-    } else if(htbl->ktype == H_CHAR) 
-    {
-        htbl->key_hash = char_hash;
-    } else if(htbl->ktype == H_SHORT) 
-    {
-        htbl->key_hash = short_hash;
-    } else if(htbl->ktype == H_LONG) 
-    {
-        htbl->key_hash = long_hash;
-    } else if(htbl->ktype == H_DOUBLE) 
-    {
-        htbl->key_hash = double_hash;
-    } else if(htbl->ktype == H_FLOAT) 
-    {
-        htbl->key_hash = float_hash;
-    } else if(htbl->ktype == H_STRING) {
-        htbl->key_hash = str_hash;
-    } else {
-        htbl->key_hash = NULL;
-    }
+    htbl->key_deallocate = NULL;
+    htbl->keys = set_init(htbl->ksize, compare);
+    htbl->keysStale = 0;
 
     return htbl;
 }
@@ -182,75 +624,61 @@ hashtable* hashtable_init_size(size_t buckets, enum HTYPES ktype, enum HTYPES dt
  */ 
 int32_t hashtable_insert(hashtable* htbl, void *key, void* value)
 {
-    size_t bucket = htbl->key_hash(key, htbl->buckets); // hash the key
-    hashtable_entry* entry = hashtable_lookup_entry(htbl, key);
-
-    if(entry == NULL) /// The key is not in the table
+    if(!hashtable_rehash_step(htbl))
     {
-        entry = hashtable_set_entry(htbl, entry, key, value);
+        return 0;
+    }
 
-        // The bucket has at least one entry
-        if(htbl->table[bucket] != NULL)
-        {
-            htbl->collisions++;
-
-            // Always and to the front of the entry chain
-            entry->next = htbl->table[bucket];
-            htbl->table[bucket]->prev = entry;
-        } 
-
-        htbl->table[bucket] = entry;
-        htbl->size++;        
-        set_insert(htbl->keys, key);
-    } else { /// The key is in the table 
-        // In case the value memory is externally managed, we have to get the data
-        // in the entry before replacing it.
-        size_t dsize = get_htype_size(htbl->dtype);
-        void* tmp = malloc(dsize);
-        memcpy(tmp, entry->data, dsize);          // Copy the data to a tmp variable
-        memcpy(entry->data, value, dsize);        // Replace the data
-        memcpy(value, tmp, dsize);          // Copy the original data into value
-        free(tmp);
+    hashtable_slots slots;
+    size_t hash = hashtable_hash(htbl, key);
+    char* slot = hashtable_find(htbl, key, hash, &slots);
+
+    if(slot != NULL) /// The key is in the table 
+    {
+        // In case the value memory is externally managed, we have to give
+        // the old value back.
+        uint64_t tmp;
+        char* data = slot + htbl->dataOffset;
+        memcpy(&tmp, data, htbl->dsize);          // Copy the data to a tmp variable
+        memcpy(data, value, htbl->dsize);        // Replace the data
+        memcpy(value, &tmp, htbl->dsize);          // Copy the original data into value
 
         return -1;
     }
 
-    return 1;
-}
+    if(htbl->size + 1 > HASHTABLE_MAX_LOAD(htbl->buckets) && !hashtable_start_rehash(htbl))
+    {
+        return 0;
+    }
 
-/**
- * @brief Look for an entry that matches the key
- * 
- * @param htbl 
- * @param key 
- * @return htbl_entry* 
- */
-hashtable_entry* hashtable_lookup_entry(hashtable* htbl, void* key)
-{
-    size_t bucket = htbl->key_hash(key, htbl->buckets);    
-    hashtable_entry* entry = htbl->table[bucket];
-    
-    while(entry)
+    slots = hashtable_current(htbl);
+    if(hashtable_probe(htbl, hashtable_slot(htbl, &slots, hash & (htbl->buckets - 1))) != 0)
     {
-        if(htbl->key_compare(entry->key, key) == 0)
-        {
-            break;
-        }
+        htbl->collisions++;
+    }
 
-        entry = entry->next;
+    // The slots move entries around so work on a copy
+    uint64_t entry[HASHTABLE_MAX_SLOT];
+    memcpy(entry, key, htbl->ksize);
+    memcpy((char *)entry + htbl->dataOffset, value, htbl->dsize);
+    if(!hashtable_place_or_rebuild(htbl, (char *)entry, hash))
+    {
+        return 0;
     }
 
-    // Check that we actually found the data
-    return entry;
+    htbl->size++;        
+    htbl->keysStale = 1;
+
+    return 1;
 }
 
 /**
  * @brief Look for the ArrayList at the key location.
  * 
- * First we find the bucket then if it is not empty, we iterate
- * through the entries to find one that matches the key. If we find
- * the key in one of the entries, we then return the data in the
- * entry, otherwise we return NULL
+ * The key is probed from its home slot until it is found, or until an
+ * empty slot or an entry that is closer to its home than the key would
+ * be shows that it is not in the table. While the table is being rehashed
+ * the old slots are probed as well.
  * 
  * @param htbl 
  * @param key 
@@ -259,11 +687,11 @@ hashtable_entry* hashtable_lookup_entry(hashtable* htbl, void* key)
  */
 int32_t hashtable_lookup(hashtable* htbl, void* key, void* data)
 {
-    hashtable_entry* tmp = hashtable_lookup_entry(htbl, key);
-    if(tmp != NULL)
+    hashtable_slots slots;
+    char* slot = hashtable_find(htbl, key, hashtable_hash(htbl, key), &slots);
+    if(slot != NULL)
     {
-        size_t dsize = get_htype_size(htbl->dtype);
-        memcpy(data, tmp->data, dsize);
+        memcpy(data, slot + htbl->dataOffset, htbl->dsize);
         return 1;
     }
 
@@ -285,42 +713,24 @@ int32_t hashtable_remove(hashtable* htbl, void* key, void* data)
         return 0;
     }
 
-    size_t bucket = htbl->key_hash(key, htbl->buckets);
-    hashtable_entry* entry = hashtable_lookup_entry(htbl, key);
-
-    if(entry == NULL)
+    if(!hashtable_rehash_step(htbl))
     {
         return 0;
     }
 
-    // Get the previous entry to point to the next entry
-    if(entry->prev != NULL)
-    {
-        entry->prev->next = entry->next;
-        entry->prev = NULL;
-    } else { // this is the first entry
-        htbl->table[bucket] = entry->next;
-        if(htbl->table[bucket] != NULL)
-        {
-            htbl->table[bucket]->prev = NULL;
-        }
-    }
+    hashtable_slots slots;
+    char* slot = hashtable_find(htbl, key, hashtable_hash(htbl, key), &slots);
 
-    if(entry->next != NULL)
+    if(slot == NULL)
     {
-        entry->next->prev = entry->prev;
-        entry->next = NULL;
-    } else {
-        if(entry->prev != NULL)
-        {
-            entry->prev->next = NULL;
-        }
+        return 0;
     }
 
-    // destroy the node and get the data
-    hashtable_entry_destroy(entry, data, get_htype_size(htbl->ktype));
+    // Get the data and remove the key before the slot is overwritten
+    memcpy(data, slot + htbl->dataOffset, htbl->dsize);
+    hashtable_remove_at(htbl, &slots, (size_t)(slot - slots.slots) / htbl->slotSize);
     htbl->size--;    
-    set_remove(htbl->keys, key);
+    htbl->keysStale = 1;
 
     return 1;
 }
@@ -336,31 +746,20 @@ int32_t hashtable_remove(hashtable* htbl, void* key, void* data)
  */
 int32_t hashtable_clear(hashtable* htbl, void (*key_destroy)(void *key), void (*value_destroy)(void *value))
 {
-    void* key = malloc(get_htype_size(htbl->ktype));
-    size_t dsize = get_htype_size(htbl->dtype);
-    void* data = malloc(dsize);
-    hashtable_entry* entry = NULL;
-    hashtable_entry* tmp = NULL;
+    hashtable_slots all[2] = {hashtable_current(htbl), hashtable_old(htbl)};
 
-    for(size_t i = 0; i < set_size(htbl->keys); i++)
+    for(int32_t t = 0; t < 2; t++)
     {
-        set_value_at(htbl->keys, i, key);
-        size_t bucket = htbl->key_hash(key, htbl->buckets);
-        entry = htbl->table[bucket];
-        htbl->table[bucket] = NULL; /// unhook the entries from the bucket
-
-        /// The colliding entries will be removed as well 
-        /// so check to make sure we do not attempt to remove again.
-        if(entry == NULL)
+        for(size_t i = 0; i < all[t].buckets; i++)
         {
-            continue;
-        }
+            char* slot = hashtable_slot(htbl, all + t, i);
+            if(hashtable_probe(htbl, slot) == 0)
+            {
+                continue;
+            }
 
-        while(entry)
-        {
-            tmp = entry;
-            entry = entry->next;
-            hashtable_entry_destroy(tmp, data, dsize);
+            void* key = slot;
+            void* data = slot + htbl->dataOffset;
 
             if(key_destroy != NULL && *(void **)key != NULL)
             {
@@ -371,12 +770,20 @@ int32_t hashtable_clear(hashtable* htbl, void (*key_destroy)(void *key), void (*
             {
                 value_destroy(*(void **)data);
             }
+
+            hashtable_set_probe(htbl, slot, 0);
         }
     }
 
-    free(key);
-    free(data);
-    set_clear(htbl->keys);
+    // The cleared table does not need the old slots any more
+    if(htbl->oldBuckets > 0)
+    {
+        hdbscan_free(htbl->oldSlots);
+        hashtable_reset_old(htbl);
+    }
+
+    array_list_clear(htbl->keys, 0);
+    htbl->keysStale = 0;
     htbl->size = 0;
    
     return 1;
@@ -392,8 +799,8 @@ int32_t hashtable_destroy(hashtable* htbl, void (*key_destroy)(void *key), void
     if(hashtable_clear(htbl, key_destroy, value_destroy))
     {
         set_delete(htbl->keys);
-        free(htbl->table);
-        free(htbl);
+        hdbscan_free(htbl->slots);
+        hdbscan_free(htbl);
     } else {
         return 0;
     }
@@ -401,64 +808,40 @@ int32_t hashtable_destroy(hashtable* htbl, void (*key_destroy)(void *key), void
     return 1;
 }
 
-/**
- * @brief Initialise a table entry
- * 
- * @param key 
- * @param data 
- * @return htbl_entry* 
- */
-hashtable_entry* hashtable_set_entry(hashtable* htbl, hashtable_entry *entry, void* key, void* data)
+size_t hashtable_size(hashtable* htbl)
+{
+    assert(htbl != NULL);
+    return htbl->size;
+}
+
+set_t* hashtable_keys(hashtable* htbl)
 {
-    size_t ksize = get_htype_size(htbl->ktype);
-    size_t dsize = get_htype_size(htbl->dtype);
-    if(entry == NULL)
+    assert(htbl != NULL);
+    if(!htbl->keysStale)
     {
-        entry = (hashtable_entry *)malloc(sizeof(hashtable_entry));
+        return htbl->keys;
+    }
 
-        // Assign proper memory sizes.
-        // TODO: see if data and key memories can be allocated in a
-        // single contigous memory with the malloc above.
-        entry->data = malloc(dsize);
-        entry->key = malloc(ksize);
+    array_list_clear(htbl->keys, 0);
+    hashtable_slots all[2] = {hashtable_current(htbl), hashtable_old(htbl)};
 
-        // Make sure next and prev are NULL
-        entry->next = NULL;
-        entry->prev = NULL;
+    for(int32_t t = 0; t < 2; t++)
+    {
+        for(size_t i = 0; i < all[t].buckets; i++)
+        {
+            char* slot = hashtable_slot(htbl, all + t, i);
+            if(hashtable_probe(htbl, slot) != 0 && !array_list_append(htbl->keys, slot))
+            {
+                logger_write(FATAL, "hashtable_keys - Could not allocate memory for the keys\n");
+                return NULL;
+            }
+        }
     }
 
-    entry->key_compare = htbl->key_compare;
-    memcpy(entry->key, key, ksize);
-    memcpy(entry->data, data, dsize);
-    
-    return entry;
-}
+    set_sort(htbl->keys);
+    htbl->keysStale = 0;
 
-/**
- * @brief 
- * 
- * @param htbl 
- * @param entry 
- * @param key 
- * @param data 
- */
-void hashtable_entry_destroy(hashtable_entry *entry, void* data, size_t dsize)
-{
-    // In case the data are managed somewhere else
-    // We should copy them for proper deallocation
-    memcpy(data, entry->data, dsize);
-
-    // Release all malloc'd memory
-    free(entry->key);
-    free(entry->data);
-    free(entry);
-}
-
-size_t hashtable_size(hashtable* htbl)
-{
-    assert(htbl != NULL);
-    //printf("hashtable_size: size is %ld\n", htbl->size);
-    return htbl->keys->size;
+    return htbl->keys;
 }
 
 int32_t hashtable_empty(hashtable* htbl)
@@ -469,4 +852,4 @@ int32_t hashtable_empty(hashtable* htbl)
     }
 
     return 0;
-}
\ No newline at end of file
+}
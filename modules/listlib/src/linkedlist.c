@@ -50,12 +50,123 @@
 void linkedlist_node_unhook(linkedlist* list, node* nd);
 void arraylist_add_by_type(ArrayList* al, enum HTYPES type, void* value);
 
+/**
+ * @brief The number of nodes in the first slab of a list
+ */
+#define LINKEDLIST_FIRST_SLAB 16
+
+/**
+ * @brief The largest number of nodes in a slab
+ */
+#define LINKEDLIST_MAX_SLAB 4096
+
+/**
+ * @brief The room at the start of a slab for the pointer to the previous
+ * slab, kept a multiple of the node alignment
+ */
+#define LINKEDLIST_SLAB_HEADER (2 * sizeof(void *))
+
+/**
+ * @brief Set up an empty pool for nodes with step bytes of data. Nothing is
+ * allocated until the first node is needed.
+ * 
+ * @param pool 
+ * @param step 
+ */
+static void node_pool_init(node_pool* pool, size_t step)
+{
+    pool->inlineData = step <= LINKEDLIST_INLINE_SIZE;
+    pool->nodeSize = sizeof(node);
+    if(pool->inlineData)
+    {
+        // Keep the next node aligned
+        pool->nodeSize = (sizeof(node) + step + sizeof(void *) - 1) / sizeof(void *) * sizeof(void *);
+    }
+
+    pool->slabNodes = 0;
+    pool->used = 0;
+    pool->slab = NULL;
+    pool->freeNodes = NULL;
+}
+
+/**
+ * @brief Take a node from the free list, or from the current slab, starting a
+ * new slab when it is full.
+ * 
+ * @param pool 
+ * @return node* NULL if a new slab could not be allocated
+ */
+static node* node_pool_get(node_pool* pool)
+{
+    if(pool->freeNodes != NULL)
+    {
+        node* nd = pool->freeNodes;
+        pool->freeNodes = nd->next;
+        return nd;
+    }
+
+    if(pool->used == pool->slabNodes)
+    {
+        size_t slabNodes = pool->slabNodes == 0 ? LINKEDLIST_FIRST_SLAB : pool->slabNodes * 2;
+        if(slabNodes > LINKEDLIST_MAX_SLAB)
+        {
+            slabNodes = LINKEDLIST_MAX_SLAB;
+        }
+
+        char* slab = (char *)hdbscan_malloc(LINKEDLIST_SLAB_HEADER + slabNodes * pool->nodeSize);
+        if(slab == NULL)
+        {
+            return NULL;
+        }
+
+        *(char **)slab = pool->slab;
+        pool->slab = slab;
+        pool->slabNodes = slabNodes;
+        pool->used = 0;
+    }
+
+    return (node *)(pool->slab + LINKEDLIST_SLAB_HEADER + pool->used++ * pool->nodeSize);
+}
+
+/**
+ * @brief Give a node back to the pool
+ * 
+ * @param pool 
+ * @param nd 
+ */
+static void node_pool_put(node_pool* pool, node* nd)
+{
+    nd->next = pool->freeNodes;
+    pool->freeNodes = nd;
+}
+
+/**
+ * @brief Free every slab of the pool at once
+ * 
+ * @param pool 
+ */
+static void node_pool_release(node_pool* pool)
+{
+    char* slab = pool->slab;
+    while(slab != NULL)
+    {
+        char* previous = *(char **)slab;
+        hdbscan_free(slab);
+        slab = previous;
+    }
+
+    pool->slabNodes = 0;
+    pool->used = 0;
+    pool->slab = NULL;
+    pool->freeNodes = NULL;
+}
+
 /**
  * Initialise a linked list.
  */ 
 linkedlist *linkedlist_init(size_t step)
 {
-    linkedlist *list = (linkedlist *)malloc(sizeof(linkedlist));
+    linkedlist *list = (linkedlist *)hdbscan_malloc(sizeof(linkedlist));
 
     if(list == NULL)
     {
@@ -66,33 +177,21 @@ linkedlist *linkedlist_init(size_t step)
     list->head = NULL;
     list->tail = NULL;
     list->step = step;
+    node_pool_init(&list->pool, step);
 
     return list;
 }
 
-/**
- * @brief Sets the node data based on the type.
- * 
- * @param nd 
- * @param data 
- * @param type 
- */
-void node_set_data(node* nd, void* data, size_t step)
-{    
-    nd->data = malloc(step);
-    memcpy(nd->data, data, step);
-}
-
 /**
  * @brief Create a new node with the data
  * 
+ * @param list 
  * @param data 
- * @param type 
  * @return node* 
  */
-node* node_creator(void* data, enum HTYPES type)
+node* node_creator(linkedlist* list, void* data)
 {
-    node* nd = (node *)malloc(sizeof(node));
+    node* nd = node_pool_get(&list->pool);
 
     if(nd == NULL)
     {
@@ -102,27 +201,42 @@ node* node_creator(void* data, enum HTYPES type)
     nd->prev = NULL;
     nd->next = NULL;
 
-    node_set_data(nd, data, type);
+    if(list->pool.inlineData)
+    {
+        nd->data = (char *)nd + sizeof(node);
+    } else {
+        nd->data = hdbscan_malloc(list->step);
+        if(nd->data == NULL)
+        {
+            node_pool_put(&list->pool, nd);
+            return NULL;
+        }
+    }
+
+    memcpy(nd->data, data, list->step);
     
     return nd;
 }
 
 /**
- * @brief Destroy a node and deallocate all memory
+ * @brief Give the node back to the pool of the list
  * 
+ * @param list 
  * @param nd 
- * @param type 
  * @return int32_t 
  */
-int32_t node_destroy(node* nd, enum HTYPES type)
+int32_t node_destroy(linkedlist* list, node* nd)
 {
     if(nd == NULL)
     {
         return 0;
     }
-    free(nd->data);
-    free(nd);
-    nd = NULL;
+
+    if(!list->pool.inlineData)
+    {
+        hdbscan_free(nd->data);
+    }
+    node_pool_put(&list->pool, nd);
 
     return 1;
 }
@@ -133,7 +247,7 @@ int32_t node_destroy(node* nd, enum HTYPES type)
  */ 
 node* linkedlist_node_front_add(linkedlist* list, void* data)
 {
-    node* nd = node_creator(data, list->step);
+    node* nd = node_creator(list, data);
 
     if(nd == NULL)
     {
@@ -160,7 +274,7 @@ node* linkedlist_node_front_add(linkedlist* list, void* data)
  */ 
 node* linkedlist_node_tail_add(linkedlist* list, void* data)
 {
-    node* nd = node_creator(data, list->step);
+    node* nd = node_creator(list, data);
 
     if(nd == NULL)
     {
@@ -318,7 +432,7 @@ int32_t linkedlist_remove(linkedlist* list, void* data, int32_t (*d_compare)(con
         linkedlist_node_unhook(list, tmp);
 
         // destroy the node
-        node_destroy(tmp, list->step);
+        node_destroy(list, tmp);
     } else {
         return 0;
     }
@@ -336,33 +450,32 @@ void linkedlist_delete(linkedlist* list)
     linkedlist_clear(list); /// Clear the list first
 
     // Free the list memory
-    free(list);
+    hdbscan_free(list);
     list = NULL;
 }
 
 /**
- * Clear the linked list of all the data. We start removing from the
- * tail. We unhook the tail and then delete the node.
+ * Clear the linked list of all the data. Payloads that are not inline
+ * are freed node by node, then all the slabs are released together.
  * 
  * @param list - the linkedlist to clear
  */ 
 void linkedlist_clear(linkedlist* list)
 {
-    node* nd = list->head;
-    while(nd != NULL)
-    {   
-        node* tmp = nd;
-        nd = nd->next;     
-        // Unhook the last node from the list
-        linkedlist_node_unhook(list, tmp);
-        
-        // destroy the node
-        node_destroy(tmp, list->step);
+    if(!list->pool.inlineData)
+    {
+        for(node* nd = list->head; nd != NULL; nd = nd->next)
+        {
+            hdbscan_free(nd->data);
+        }
     }
 
+    node_pool_release(&list->pool);
+
     // set the head and tail to NULL
     list->head = NULL;
     list->tail = NULL;
+    list->size = 0;
 }
 
 /**
@@ -54,13 +54,13 @@
 ArrayList* array_list_init(size_t initial_size, size_t step, int32_t (*compare)(const void *a, const void *b))
 {
 	assert(initial_size > 0);
-	ArrayList* list = malloc(sizeof(ArrayList));
+	ArrayList* list = hdbscan_malloc(sizeof(ArrayList));
 
 	if(list != NULL){
-		list->data = calloc(initial_size, step); 
+		list->data = hdbscan_calloc(initial_size, step); 
 
 		if(list->data == NULL){
-			free(list);	// Since the data memory was no allocated, we should
+			hdbscan_free(list);	// Since the data memory was no allocated, we should
 						// clean up the memory allocated for the list.
 			return NULL;
 		}
@@ -119,7 +119,7 @@ int32_t array_list_value_at(ArrayList* list, size_t pos, void* data)
 int32_t array_list_grow(ArrayList* list){
 
 	size_t newmax = highestPowerof2(list->max_size*2);
-	list->data = realloc(list->data, newmax * list->step);
+	list->data = hdbscan_realloc(list->data, newmax * list->step);
 
 	if(list->data == NULL){
 		return -1;
@@ -139,10 +139,10 @@ int32_t array_list_grow(ArrayList* list){
 ArrayList* array_list_delete(ArrayList* list){
 	if(list != NULL){ /// Make sure the list is not NULL
 		if(list->data != NULL){
-			free(list->data);		/// Free the data pointer
+			hdbscan_free(list->data);		/// Free the data pointer
 		}
 
-		free(list);				/// Free the ArrayList structure
+		hdbscan_free(list);				/// Free the ArrayList structure
 		list = NULL;
 	}
 
@@ -280,7 +280,8 @@ void array_list_clear(ArrayList* list, int32_t resize)
 {
 	list->size = 0;
 	if(resize) {
-		list->data = realloc(list->data, list->step);
+		list->data = hdbscan_realloc(list->data, list->step);
+		list->max_size = 1;
 	}
 }
 
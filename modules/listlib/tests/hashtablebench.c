@@ -0,0 +1,208 @@
+/** 
+ * Copyright 2019 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file hashtablebench.c
+ * @author Onalenna Junior Makhura (ojmakhura@roguesystems.co.bw)
+ * @brief Microbenchmarks for the hashtable. Tables of 10 to 10M int keys are
+ * grown from the smallest size and the cost of inserts, of the slowest single
+ * insert, of hits and of misses is printed with the mean probe distance. The
+ * same keys are then inserted into a fresh table and removed again in a random
+ * order, so that the cost is not flattered by the keys arriving sorted.
+ * 
+ * Usage: listlib_hashtable_bench [max entries]
+ * 
+ * @date 2019-07-10
+ * 
+ * @copyright Copyright (c) 2019
+ * 
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "listlib/hashtable.h"
+
+/**
+ * @brief The number of lookups timed for every table size
+ */
+#define BENCH_LOOKUPS 4000000
+
+/**
+ * @brief Nanoseconds since an arbitrary point
+ * 
+ * @return double 
+ */
+static double bench_now()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/**
+ * @brief A cheap pseudo random number generator so that the lookups do not
+ * follow the insert order
+ * 
+ * @param state 
+ * @return uint32_t 
+ */
+static uint32_t bench_next(uint64_t* state)
+{
+    *state = *state * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (uint32_t)(*state >> 33);
+}
+
+/**
+ * @brief Fisher-Yates shuffle of the keys
+ * 
+ * @param keys 
+ * @param n 
+ * @param state 
+ */
+static void bench_shuffle(int32_t* keys, int32_t n, uint64_t* state)
+{
+    for(int32_t i = n - 1; i > 0; i--)
+    {
+        int32_t j = (int32_t)(bench_next(state) % (uint32_t)(i + 1));
+        int32_t tmp = keys[i];
+        keys[i] = keys[j];
+        keys[j] = tmp;
+    }
+}
+
+/**
+ * @brief Time one table of n entries
+ * 
+ * @param n 
+ */
+static void bench_table(int32_t n)
+{
+    hashtable* htbl = hashtable_init(1, H_INT, H_INT, int_compare);
+    double worst = 0;
+
+    double start = bench_now();
+    for(int32_t k = 0; k < n; k++)
+    {
+        int32_t v = k;
+        double t = bench_now();
+        hashtable_insert(htbl, &k, &v);
+        t = bench_now() - t;
+
+        if(t > worst)
+        {
+            worst = t;
+        }
+    }
+    double insert = (bench_now() - start) / n;
+
+    uint64_t state = 42;
+    int64_t sum = 0;
+    start = bench_now();
+    for(int32_t i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        int32_t k = (int32_t)(bench_next(&state) % (uint32_t)n);
+        int32_t v;
+        hashtable_lookup(htbl, &k, &v);
+        sum += v;
+    }
+    double hit = (bench_now() - start) / BENCH_LOOKUPS;
+
+    start = bench_now();
+    for(int32_t i = 0; i < BENCH_LOOKUPS; i++)
+    {
+        int32_t k = n + (int32_t)(bench_next(&state) % (uint32_t)n);
+        int32_t v;
+        sum += hashtable_lookup(htbl, &k, &v);
+    }
+    double miss = (bench_now() - start) / BENCH_LOOKUPS;
+
+    // Only the current slots, any rehash still going has few entries left
+    double probes = 0;
+    size_t used = 0;
+    for(size_t i = 0; i < htbl->buckets; i++)
+    {
+        uint8_t probe = (uint8_t)htbl->slots[i * htbl->slotSize + htbl->probeOffset];
+        if(probe != 0)
+        {
+            probes += probe;
+            used++;
+        }
+    }
+
+    size_t buckets = htbl->buckets;
+    hashtable_destroy(htbl, NULL, NULL);
+
+    // The same keys shuffled, inserted into a fresh table and removed in another order
+    int32_t* keys = (int32_t *)malloc((size_t)n * sizeof(int32_t));
+    if(keys == NULL)
+    {
+        printf("Could not allocate the keys for %d entries\n", n);
+        return;
+    }
+
+    for(int32_t k = 0; k < n; k++)
+    {
+        keys[k] = k;
+    }
+    bench_shuffle(keys, n, &state);
+
+    htbl = hashtable_init(1, H_INT, H_INT, int_compare);
+    start = bench_now();
+    for(int32_t i = 0; i < n; i++)
+    {
+        hashtable_insert(htbl, keys + i, keys + i);
+    }
+    double randomInsert = (bench_now() - start) / n;
+
+    bench_shuffle(keys, n, &state);
+    start = bench_now();
+    for(int32_t i = 0; i < n; i++)
+    {
+        int32_t v;
+        hashtable_remove(htbl, keys + i, &v);
+        sum += v;
+    }
+    double randomRemove = (bench_now() - start) / n;
+
+    printf("%10d %10zu %12.1f %16.1f %10.1f %10.1f %12.2f %12.1f %12.1f   (%ld)\n", n, buckets, insert, worst / 1000, hit, miss, used > 0 ? probes / (double)used : 0, randomInsert, randomRemove, (long)(sum & 1));
+    hashtable_destroy(htbl, NULL, NULL);
+    free(keys);
+}
+
+int main(int argc, char** argv)
+{
+    int32_t max = 10000000;
+    if(argc > 1)
+    {
+        max = atoi(argv[1]);
+    }
+
+    printf("%10s %10s %12s %16s %10s %10s %12s %12s %12s\n", "entries", "slots", "insert ns", "worst insert us", "hit ns", "miss ns", "mean probe", "rnd ins ns", "rnd rem ns");
+    for(int32_t n = 10; n <= max && n > 0; n *= 10)
+    {
+        bench_table(n);
+    }
+
+    return 0;
+}
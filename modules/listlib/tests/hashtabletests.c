@@ -76,19 +76,15 @@ void hash_table_int_test()
     CU_ASSERT_PTR_NOT_NULL(htbl);
     CU_ASSERT_PTR_NOT_NULL(htbl->buckets);
     CU_ASSERT_PTR_NOT_NULL(htbl->keys);
-    CU_ASSERT_PTR_NOT_NULL(htbl->table);
-    CU_ASSERT_EQUAL_FATAL(htbl->buckets, 43);
+    CU_ASSERT_PTR_NOT_NULL(htbl->slots);
+    CU_ASSERT_EQUAL_FATAL(htbl->buckets, 64);
     CU_ASSERT_EQUAL_FATAL(htbl->size, 0);
-    CU_ASSERT_EQUAL_FATAL(htbl->keys->size, 0);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 0);
     
-    // Test that each bucket has been properly created
-    // since we need to access each bucket through the 
-    // array_list_value_at() function, we hack the size
-    // to be the same as the number of buckets
+    // Test that every slot starts empty
     for(size_t i = 0; i < htbl->buckets; i++)
     {
-        hashtable_entry* tmp = htbl->table[i];
-        CU_ASSERT_PTR_NULL_FATAL(tmp);
+        CU_ASSERT_EQUAL_FATAL(htbl->slots[i * htbl->slotSize + htbl->probeOffset], 0);
     }
 
     // Test adding to the table
@@ -96,8 +92,8 @@ void hash_table_int_test()
     int32_t k = 55;
     CU_ASSERT_EQUAL_FATAL(1, hashtable_insert(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(htbl->size, 1);
-    printf("size is %d\n", (int32_t)set_size(htbl->keys));
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 1);
+    printf("size is %d\n", (int32_t)set_size(hashtable_keys(htbl)));
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 1);
     
     x = 0;     
     CU_ASSERT_EQUAL_FATAL(1, hashtable_lookup(htbl, &k, &x));
@@ -110,7 +106,7 @@ void hash_table_int_test()
     CU_ASSERT_EQUAL_FATAL(-1, hashtable_insert(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(23, x);
     CU_ASSERT_EQUAL_FATAL(1, htbl->size);
-    CU_ASSERT_EQUAL_FATAL(1, set_size(htbl->keys));
+    CU_ASSERT_EQUAL_FATAL(1, set_size(hashtable_keys(htbl)));
     CU_ASSERT_EQUAL_FATAL(1, hashtable_lookup(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(88, x);
 
@@ -119,7 +115,7 @@ void hash_table_int_test()
     CU_ASSERT_EQUAL_FATAL(-1, hashtable_insert(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(88, x);
     CU_ASSERT_EQUAL_FATAL(htbl->size, 1);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 1);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 1);
     x = 0;
     CU_ASSERT_EQUAL_FATAL(1, hashtable_lookup(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(9, x);
@@ -128,21 +124,21 @@ void hash_table_int_test()
     k = 34;
     CU_ASSERT_EQUAL_FATAL(0, hashtable_lookup(htbl, &k, &x));
 
-    // Testing new keys, one of which is 12 which will colide with 55
+    // Testing new keys
     x = 1;
     k = 12;
     CU_ASSERT_EQUAL_FATAL(1, hashtable_insert(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(htbl->size, 2);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 2);
-    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 1); // 12 collides with 55
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 2);
+    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 0); // 55, 12, 2, 5 and 48 all have their own home slot
 
     k = 12;
     x = 33;
     CU_ASSERT_EQUAL_FATAL(-1, hashtable_insert(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(1, x);
     CU_ASSERT_EQUAL_FATAL(htbl->size, 2);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 2);
-    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 1);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 2);
+    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 0);
 
     x = 0;
     k = 55;
@@ -153,8 +149,8 @@ void hash_table_int_test()
     k = 2;
     CU_ASSERT_EQUAL_FATAL(1, hashtable_insert(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(htbl->size, 3);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 3);
-    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 1);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 3);
+    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 0);
 
     x = 0;
     k = 55;
@@ -166,8 +162,8 @@ void hash_table_int_test()
     k = 5;
     CU_ASSERT_EQUAL_FATAL(1, hashtable_insert(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(htbl->size, 4);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 4);
-    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 1);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 4);
+    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 0);
 
     x = 0;
     k = 55;
@@ -179,8 +175,8 @@ void hash_table_int_test()
     CU_ASSERT_EQUAL_FATAL(-1, hashtable_insert(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(8, x);
     CU_ASSERT_EQUAL_FATAL(htbl->size, 4);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 4);
-    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 1);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 4);
+    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 0);
 
     x = 0;
     k = 55;
@@ -192,13 +188,13 @@ void hash_table_int_test()
     CU_ASSERT_EQUAL_FATAL(1, hashtable_lookup(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(100, x);
 
-    // test another collision
+    // test another key
     x = -2;
     k = 48;
     CU_ASSERT_EQUAL_FATAL(1, hashtable_insert(htbl, &k, &x));
     CU_ASSERT_EQUAL_FATAL(htbl->size, 5);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 5);
-    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 2);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 5);
+    CU_ASSERT_EQUAL_FATAL(htbl->collisions, 0);
 
     printf("\nHash table has %ld elements.\n", htbl->size);
     
@@ -206,10 +202,10 @@ void hash_table_int_test()
      * @brief Iteration over the hash table
      * 
      */
-    for(size_t i = 0; i < set_size(htbl->keys); i++)
+    for(size_t i = 0; i < set_size(hashtable_keys(htbl)); i++)
     {
         int32_t key;
-        set_value_at(htbl->keys, i, &key);
+        set_value_at(hashtable_keys(htbl), i, &key);
         int32_t value;
         hashtable_lookup(htbl, &key, &value);
         printf("%d -> %d\n", key, value);
@@ -238,22 +234,22 @@ void hash_table_str_test()
     CU_ASSERT_PTR_NOT_NULL(htbl);
     CU_ASSERT_PTR_NOT_NULL(htbl->buckets);
     CU_ASSERT_PTR_NOT_NULL(htbl->keys);
-    CU_ASSERT_PTR_NOT_NULL(htbl->table);
-    CU_ASSERT_EQUAL_FATAL(htbl->buckets, 43);
+    CU_ASSERT_PTR_NOT_NULL(htbl->slots);
+    CU_ASSERT_EQUAL_FATAL(htbl->buckets, 64);
     CU_ASSERT_EQUAL_FATAL(htbl->size, 0);
-    CU_ASSERT_EQUAL_FATAL(htbl->keys->size, 0);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 0);
 
     char* key = "junior";
     int32_t value = 34;
     CU_ASSERT_EQUAL_FATAL(1, hashtable_insert(htbl, &key, &value));
     CU_ASSERT_EQUAL_FATAL(htbl->size, 1);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 1);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 1);
 
     key = "michael";
     value = 7;
     CU_ASSERT_EQUAL_FATAL(1, hashtable_insert(htbl, &key, &value));
     CU_ASSERT_EQUAL_FATAL(htbl->size, 2);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 2);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 2);
 
     printf("\nHash table has %ld elements.\n", htbl->size);
     
@@ -261,11 +257,11 @@ void hash_table_str_test()
      * @brief Iteration over the hash table
      * 
      */
-    for(size_t i = 0; i <set_size(htbl->keys); i++)
+    for(size_t i = 0; i <set_size(hashtable_keys(htbl)); i++)
     {
         char* k = NULL;
         //array_list_value_at(htbl->keys, i, &k);
-        set_value_at(htbl->keys, i, &k);
+        set_value_at(hashtable_keys(htbl), i, &k);
         int32_t v;
         hashtable_lookup(htbl, &k, &v);
         printf("%s -> %d\n", (char*)k, v);
@@ -275,6 +271,62 @@ void hash_table_str_test()
     printf("\n********************************************************************************************\n");
 }
 
+/**
+ * @brief Test that the table grows past its initial size and that removing
+ * keys keeps the others reachable
+ * 
+ */
+void hash_table_grow_test()
+{
+    printf("\n");
+    hashtable* htbl = hashtable_init(4, H_INT, H_INT, int_compare);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(htbl);
+    CU_ASSERT_EQUAL_FATAL(htbl->buckets, 8);
+
+    for(int32_t k = 0; k < 10000; k++)
+    {
+        int32_t x = k * 3;
+        CU_ASSERT_EQUAL_FATAL(1, hashtable_insert(htbl, &k, &x));
+    }
+
+    CU_ASSERT_EQUAL_FATAL(htbl->size, 10000);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 10000);
+    CU_ASSERT_EQUAL_FATAL(htbl->buckets & (htbl->buckets - 1), 0);
+    CU_ASSERT(htbl->buckets >= 10000);
+
+    // Remove the even keys
+    for(int32_t k = 0; k < 10000; k += 2)
+    {
+        int32_t x = 0;
+        CU_ASSERT_EQUAL_FATAL(1, hashtable_remove(htbl, &k, &x));
+        CU_ASSERT_EQUAL_FATAL(k * 3, x);
+    }
+
+    CU_ASSERT_EQUAL_FATAL(htbl->size, 5000);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 5000);
+
+    for(int32_t k = 0; k < 10000; k++)
+    {
+        int32_t x = -1;
+        CU_ASSERT_EQUAL_FATAL(k % 2, hashtable_lookup(htbl, &k, &x));
+        if(k % 2)
+        {
+            CU_ASSERT_EQUAL_FATAL(k * 3, x);
+        }
+    }
+
+    // The keys are still in order
+    for(size_t i = 0; i < set_size(hashtable_keys(htbl)); i++)
+    {
+        int32_t key;
+        set_value_at(hashtable_keys(htbl), i, &key);
+        CU_ASSERT_EQUAL_FATAL(key, (int32_t)(2 * i + 1));
+    }
+
+    hashtable_destroy(htbl, NULL, NULL);
+    printf("\n********************************************************************************************\n");
+}
+
 /**
  * @brief Testing hashtable with int array list
  * 
@@ -287,10 +339,10 @@ void hash_table_str_test()
     CU_ASSERT_PTR_NOT_NULL(htbl);
     CU_ASSERT_PTR_NOT_NULL(htbl->buckets);
     CU_ASSERT_PTR_NOT_NULL(htbl->keys);
-    CU_ASSERT_PTR_NOT_NULL(htbl->table);
-    CU_ASSERT_EQUAL_FATAL(htbl->buckets, 43);
+    CU_ASSERT_PTR_NOT_NULL(htbl->slots);
+    CU_ASSERT_EQUAL_FATAL(htbl->buckets, 64);
     CU_ASSERT_EQUAL_FATAL(htbl->size, 0);
-    CU_ASSERT_EQUAL_FATAL(htbl->keys->size, 0);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 0);
 
     IntArrayList* list = int_array_list_init_exact_size(5);
     int_array_list_append(list, 23);
@@ -303,7 +355,7 @@ void hash_table_str_test()
     int32_t key = 12;
     CU_ASSERT_EQUAL_FATAL(1, hashtable_insert(htbl, &key, &list));
     CU_ASSERT_EQUAL_FATAL(htbl->size, 1);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 1);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 1);
 
     list = NULL;
     list = int_array_list_init_exact_size(5);
@@ -318,7 +370,7 @@ void hash_table_str_test()
     key = 45;
     CU_ASSERT_EQUAL_FATAL(1, hashtable_insert(htbl, &key, &list));
     CU_ASSERT_EQUAL_FATAL(htbl->size, 2);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 2);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 2);
 
     /// Replacing the list at key 12
     key = 12;
@@ -352,7 +404,7 @@ void hash_table_str_test()
     int_array_list_delete(list);
 
     CU_ASSERT_EQUAL_FATAL(htbl->size, 2);
-    CU_ASSERT_EQUAL_FATAL(set_size(htbl->keys), 2);
+    CU_ASSERT_EQUAL_FATAL(set_size(hashtable_keys(htbl)), 2);
 
 
     printf("\nHash table has %ld elements.\n", htbl->size);
@@ -416,6 +468,13 @@ int main()
         return CU_get_error();
     }
 
+    if ((NULL == CU_add_test(suite, "Test for growing the hashtable", hash_table_grow_test)))
+    {
+        printf("Could not add the test to the suite\n");
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
     /*if ((NULL == CU_add_test(suite, "Test for int:IntArrayList hashtable", hash_table_int_list_test)))
     {
         printf("Could not add the test to the suite\n");
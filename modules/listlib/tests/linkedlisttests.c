@@ -42,6 +42,7 @@
 #include "listlib/linkedlist.h"
 #include <CUnit/Basic.h>
 #include <stdio.h>
+#include <string.h>
 
 int init_linkedlist_suite(void)
 {
@@ -130,6 +131,56 @@ void int_linked_list_test()
     
 }
 
+/**
+ * @brief Test that nodes come from the pool of the list and are reused
+ * 
+ */
+void pooled_linked_list_test()
+{
+    linkedlist* list = linkedlist_init(sizeof(int32_t));
+    CU_ASSERT_PTR_NOT_NULL_FATAL(list);
+    CU_ASSERT_TRUE(list->pool.inlineData);
+
+    for(int32_t d = 0; d < 10000; d++)
+    {
+        CU_ASSERT_EQUAL_FATAL(1, linkedlist_tail_add(list, &d));
+    }
+    CU_ASSERT_EQUAL_FATAL(10000, list->size);
+
+    // The payload sits right after its node
+    CU_ASSERT_PTR_EQUAL(list->head->data, (char *)list->head + sizeof(node));
+
+    // A removed node is the next one handed out
+    int32_t d = 5000;
+    node* removed = linkedlist_lookup_helper(list, &d, int_compare);
+    CU_ASSERT_EQUAL_FATAL(1, linkedlist_remove(list, &d, int_compare));
+    d = -1;
+    CU_ASSERT_PTR_EQUAL(removed, linkedlist_node_front_add(list, &d));
+    CU_ASSERT_EQUAL(-1, *(int32_t *)linkedlist_head(list, 0));
+
+    linkedlist_clear(list);
+    CU_ASSERT_EQUAL_FATAL(0, list->size);
+    CU_ASSERT_PTR_NULL(list->pool.slab);
+
+    // The list can be used again after it was cleared
+    d = 7;
+    CU_ASSERT_EQUAL_FATAL(1, linkedlist_tail_add(list, &d));
+    CU_ASSERT_EQUAL(7, *(int32_t *)linkedlist_tail(list, 0));
+    linkedlist_delete(list);
+
+    // Payloads that are too large for the node get their own memory
+    char big[LINKEDLIST_INLINE_SIZE + 1];
+    list = linkedlist_init(sizeof(big));
+    CU_ASSERT_FALSE(list->pool.inlineData);
+    for(int32_t i = 0; i < 100; i++)
+    {
+        memset(big, i, sizeof(big));
+        CU_ASSERT_EQUAL_FATAL(1, linkedlist_front_add(list, big));
+    }
+    CU_ASSERT_EQUAL(99, ((char *)linkedlist_head(list, 0))[LINKEDLIST_INLINE_SIZE]);
+    linkedlist_delete(list);
+}
+
 int main()
 {
     CU_pSuite suite = NULL;
@@ -155,6 +206,13 @@ int main()
         return CU_get_error();
     }
 
+    if ((NULL == CU_add_test(suite, "Test for linkedlist node pool", pooled_linked_list_test)))
+    {
+        printf("Could not add the test to the suite\n");
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
     /* Run all tests using the CUnit Basic interface */
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();
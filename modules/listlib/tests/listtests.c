@@ -39,6 +39,7 @@
  */
 
 #include "listlib/list.h"
+#include "listlib/typedlist.h"
 #include "hdbscan/utils.h"
 #include <CUnit/Basic.h>
 #include <stdio.h>
@@ -217,6 +218,142 @@ void str_array_list_test()
     printf("\n********************************************************************************************\n");
 }
 
+LISTLIB_TYPED_LIST(int32, int32_t)
+LISTLIB_ORDERED_LIST(int32, int32_t)
+
+/**
+ * @brief Test the typed functions of typedlist.h against the generic ones
+ * 
+ */
+void typed_array_list_test()
+{
+    ArrayList* list = int32_list_init(1);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(list);
+    CU_ASSERT_EQUAL_FATAL(list->step, sizeof(int32_t));
+
+    // Appending grows the list like array_list_append
+    uint32_t state = 7;
+    for(int32_t i = 0; i < 1000; i++)
+    {
+        state = state * 1103515245u + 12345u;
+        CU_ASSERT_EQUAL_FATAL(int32_list_append(list, (int32_t)(state >> 16) % 100), 1);
+    }
+    CU_ASSERT_EQUAL_FATAL(list->size, 1000);
+    CU_ASSERT_TRUE(list->max_size >= 1000);
+
+    // Both sets of functions see the same elements
+    for(size_t i = 0; i < list->size; i++)
+    {
+        int32_t d;
+        array_list_value_at(list, i, &d);
+        CU_ASSERT_EQUAL_FATAL(int32_list_at(list, i), d);
+    }
+
+    list->compare = int_compare;
+    int32_t x = 42;
+    CU_ASSERT_EQUAL(int32_list_find(list, 42, 0), array_list_find(list, &x, 0));
+    CU_ASSERT_EQUAL(int32_list_find(list, 100, 0), -1);
+
+    int32_list_sort(list);
+    for(size_t i = 1; i < list->size; i++)
+    {
+        CU_ASSERT_TRUE_FATAL(int32_list_at(list, i - 1) <= int32_list_at(list, i));
+    }
+
+    int64_t pos = int32_list_find(list, 42, 1);
+    CU_ASSERT_TRUE_FATAL(pos >= 0);
+    CU_ASSERT_EQUAL(int32_list_at(list, (size_t)pos), 42);
+    CU_ASSERT_EQUAL(int32_list_find(list, -1, 1), -1);
+
+    int32_t last = int32_list_at(list, list->size - 1);
+    int32_t popped;
+    CU_ASSERT_EQUAL(int32_list_pop(list, &popped), 1);
+    CU_ASSERT_EQUAL(popped, last);
+    CU_ASSERT_EQUAL(list->size, 999);
+
+    CU_ASSERT_EQUAL(int32_list_reserve(list, 5000), 1);
+    CU_ASSERT_TRUE(list->max_size >= 5000);
+    CU_ASSERT_EQUAL(list->size, 999);
+
+    array_list_delete(list);
+}
+
+/**
+ * @brief Count the live allocations made through the allocator hooks
+ */
+static size_t live_allocations = 0;
+static size_t total_allocations = 0;
+
+static void* tracking_malloc(size_t size, void* ctx)
+{
+    void* ptr = malloc(size);
+    if(ptr != NULL)
+    {
+        (*(size_t*)ctx)++;
+        live_allocations++;
+    }
+    return ptr;
+}
+
+static void* tracking_realloc(void* ptr, size_t size, void* ctx)
+{
+    void* p = realloc(ptr, size);
+    if(p != NULL && ptr == NULL)
+    {
+        (*(size_t*)ctx)++;
+        live_allocations++;
+    }
+    return p;
+}
+
+static void tracking_free(void* ptr, void* ctx)
+{
+    (void)ctx;
+    live_allocations--;
+    free(ptr);
+}
+
+/**
+ * @brief Test that the lists allocate and release all their memory through
+ * the allocator installed with hdbscan_set_allocator
+ * 
+ */
+void allocator_array_list_test()
+{
+    hdbscan_allocator tracking = {tracking_malloc, NULL, tracking_realloc, tracking_free, NULL, &total_allocations};
+    hdbscan_allocator incomplete = tracking;
+    incomplete.free = NULL;
+
+    CU_ASSERT_EQUAL(hdbscan_set_allocator(&incomplete), 0);
+    CU_ASSERT_EQUAL_FATAL(hdbscan_set_allocator(&tracking), 1);
+    CU_ASSERT_PTR_EQUAL(hdbscan_get_allocator()->free, tracking_free);
+
+    ArrayList* list = int32_list_init(4);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(list);
+    for(int32_t i = 0; i < 1000; i++)
+    {
+        CU_ASSERT_EQUAL_FATAL(int32_list_append(list, i), 1);
+    }
+    CU_ASSERT_TRUE(total_allocations >= 2);
+    CU_ASSERT_TRUE(live_allocations >= 2);
+
+    // calloc and aligned_alloc fall back to malloc when they are not set
+    int32_t* zeros = (int32_t*)hdbscan_calloc(16, sizeof(int32_t));
+    CU_ASSERT_PTR_NOT_NULL_FATAL(zeros);
+    for(size_t i = 0; i < 16; i++)
+    {
+        CU_ASSERT_EQUAL(zeros[i], 0);
+    }
+    hdbscan_free(zeros);
+    hdbscan_free(hdbscan_aligned_alloc(64, 128));
+
+    array_list_delete(list);
+    CU_ASSERT_EQUAL(live_allocations, 0);
+
+    CU_ASSERT_EQUAL(hdbscan_set_allocator(NULL), 1);
+    CU_ASSERT_PTR_NOT_EQUAL(hdbscan_get_allocator()->free, tracking_free);
+}
+
 /**
  * @brief Run the tests
  * 
@@ -252,6 +389,19 @@ int main()
         return CU_get_error();
     }
 
+    if ((NULL == CU_add_test(suite, "Test for typed ArrayList functions", typed_array_list_test)))
+    {
+        printf("Could not add the Arraylist test to the suite\n");
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+    if ((NULL == CU_add_test(suite, "Test for ArrayList with allocator hooks", allocator_array_list_test)))
+    {
+        printf("Could not add the Arraylist test to the suite\n");
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
     /* Run all tests using the CUnit Basic interface */
     CU_basic_set_mode(CU_BRM_VERBOSE);
     CU_basic_run_tests();
@@ -62,6 +62,53 @@
 #endif
 
 hdbscan* scan = NULL;
+PyObject* progressCallable = NULL;
+
+/**
+ * @brief Progress callback of the runs. Ctrl-C and an exception or a true
+ * value from the Python callable cancel the run.
+ * 
+ * @param phase 
+ * @param fraction 
+ * @param data The Python callable or NULL
+ * @return int 
+ */
+static int PyHdbscan_progress(HDBSCAN_PHASE phase, double fraction, void* data){
+    if(PyErr_CheckSignals() < 0)
+        return PROGRESS_CANCEL;
+
+    PyObject* callable = (PyObject*)data;
+    if(callable != NULL){
+        PyObject* result = PyObject_CallFunction(callable, "sd", profile_phase_name(phase), fraction);
+        if(result == NULL)
+            return PROGRESS_CANCEL;
+
+        int stop = PyObject_IsTrue(result);
+        Py_DECREF(result);
+        if(stop != 0)
+            return PROGRESS_CANCEL;
+    }
+
+    return PROGRESS_CONTINUE;
+}
+
+/**
+ * @brief Raise the exception of a run that returned HDBSCAN_ERROR. Ctrl-C and
+ * an exception in the callback are already pending, a callback that returned
+ * a true value gets a RuntimeError.
+ * 
+ * @return PyObject* NULL
+ */
+static PyObject* PyHdbscan_runError(void){
+    if(!PyErr_Occurred()){
+        if(progress_cancelled(&scan->runProgress))
+            PyErr_SetString(PyExc_RuntimeError, "run cancelled");
+        else
+            PyErr_SetString(PyExc_RuntimeError, "run failed");
+    }
+
+    return NULL;
+}
 
 /**
  * @brief PyHdbscan object
@@ -72,7 +119,7 @@ typedef struct {
 	PyObject* labels;
     PyObject* clusterMap;
     PyObject* hierarchy;
-	index_t minPoints, cols, rows;
+	index_t minPoints, minClusterSize, cols, rows;
 } PyHdbscan;
 
 /**
@@ -107,6 +154,7 @@ PyHdbscan_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
         self->clusterMap = NULL;
         self->hierarchy = NULL;
 		self->minPoints = 0;
+		self->minClusterSize = 0;
 		self->rows = 0;
 		self->cols = 0;
     }
@@ -125,25 +173,33 @@ PyHdbscan_new(PyTypeObject *type, PyObject *args, PyObject *kwds)
 static int
 PyHdbscan_init(PyHdbscan *self, PyObject *args, PyObject *kwds)
 {
-    static char *kwlist[] = {"minPoints", NULL};
+    static char *kwlist[] = {"minPoints", "minClusterSize", NULL};
 
     char* c;
     if(sizeof(index_t) == sizeof(int)) {
-        c = "I";
+        c = "I|I";
     } else if(sizeof(index_t) == sizeof(long)) {
-        c = "k";
+        c = "k|k";
     } else {
-        c ="H";
+        c ="H|H";
     }
 
-    if (!PyArg_ParseTupleAndKeywords(args, kwds, c, kwlist, &self->minPoints))
+    if (!PyArg_ParseTupleAndKeywords(args, kwds, c, kwlist, &self->minPoints, &self->minClusterSize))
         return -1;
     
     if(self->minPoints < 2){
 		return -1;
 	} 
+
+    if(self->minClusterSize == 0){
+        self->minClusterSize = self->minPoints;
+    } else if(self->minClusterSize < 2){
+        return -1;
+    }
 	
     scan = hdbscan_init(NULL, self->minPoints);
+    scan->minClusterSize = self->minClusterSize;
+    hdbscan_set_progress_callback(scan, PyHdbscan_progress, progressCallable);
 	
     return 0;
 }
@@ -231,7 +287,15 @@ static PyObject *PyHdbscan_run(PyHdbscan *self, PyObject *args){
     }
 	
     void *dset = PyArray_DATA(d_arr); /// The contigous array
+
+    // the previous labels point into memory hdbscan_run is about to free
+    Py_XDECREF(self->labels);
+    self->labels = NULL;
 	int err = hdbscan_run(scan, dset, self->rows, self->cols, TRUE, datatype);
+    if(err == HDBSCAN_ERROR){
+        Py_XDECREF(dataset);
+        return PyHdbscan_runError();
+    }
 
     npy_intp dims[] = {self->rows, 1}; // Dimensions for the labels numpy array
     self->labels = PyArray_SimpleNewFromData(1, dims, NPY_INT, scan->clusterLabels);
@@ -250,16 +314,24 @@ static PyObject *PyHdbscan_run(PyHdbscan *self, PyObject *args){
  * @return PyObject* 
  */
 static PyObject* PyHdbscan_rerun(PyHdbscan *self, PyObject *args) {
-	Py_XDECREF(self->labels); 
-    if (!PyArg_ParseTuple(args, "i", &self->minPoints))
+    index_t minPoints;
+    if (!PyArg_ParseTuple(args, "i", &minPoints))
         return NULL;
     
-    if(self->minPoints < 2){
+    if(minPoints < 2){
         printf("minPts must be greater than 2.\n");
 		return NULL;
 	} 
+
+	Py_XDECREF(self->labels);
+	self->labels = NULL;
+	self->minPoints = minPoints;
 	
 	int err = hdbscan_rerun(scan, self->minPoints);
+    if(err == HDBSCAN_ERROR){
+        return PyHdbscan_runError();
+    }
+    self->minClusterSize = scan->minClusterSize;
 
     npy_intp dims[] = {self->rows, 1};
     enum NPY_TYPES tp = NPY_SHORT;
@@ -276,12 +348,165 @@ static PyObject* PyHdbscan_rerun(PyHdbscan *self, PyObject *args) {
 	return Py_BuildValue("i", err);
 }
 
-static PyObject* PyHdbscan_getClusterMap(PyHdbscan *self, PyObject *args) {
-    Py_XDECREF(self->clusterMap); 
-    int32_t begin, end;
-    if (!PyArg_ParseTuple(args, "ii", &begin, &end))
+/**
+ * @brief 
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_reselect(PyHdbscan *self, PyObject *args) {
+    index_t minClusterSize;
+    if (!PyArg_ParseTuple(args, "i", &minClusterSize))
+        return NULL;
+    
+    if(minClusterSize < 2){
+        printf("minClusterSize must be at least 2.\n");
+		return NULL;
+	} 
+
+	Py_XDECREF(self->labels);
+	self->labels = NULL;
+	self->minClusterSize = minClusterSize;
+	
+	int err = hdbscan_reselect(scan, self->minClusterSize);
+    if(err == HDBSCAN_ERROR){
+        return PyHdbscan_runError();
+    }
+
+    npy_intp dims[] = {self->rows, 1};
+    enum NPY_TYPES tp = NPY_SHORT;
+
+    if(sizeof(label_t) == sizeof(int)) {
+        tp = NPY_INT;
+    } else if (sizeof(label_t) == sizeof(long)) {
+        tp = NPY_LONG;
+    }
+
+    self->labels = PyArray_SimpleNewFromData(1, dims, tp, scan->clusterLabels);
+    Py_INCREF(self->labels);
+	
+	return Py_BuildValue("i", err);
+}
+
+/**
+ * @brief 
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_selectClusters(PyHdbscan *self, PyObject *args) {
+    int leaf = 0;
+    double epsilon = 0;
+    if (!PyArg_ParseTuple(args, "|pd", &leaf, &epsilon))
+        return NULL;
+
+    int err = hdbscan_select_clusters(scan, leaf ? SELECTION_LEAF : SELECTION_EOM, (distance_t)epsilon);
+
+    // The labels are updated in place, so self->labels is still valid
+	return Py_BuildValue("i", err);
+}
+
+/**
+ * @brief 
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_cutTree(PyHdbscan *self, PyObject *args) {
+    double cutDistance;
+    if (!PyArg_ParseTuple(args, "d", &cutDistance))
+        return NULL;
+
+    npy_intp dims[] = {self->rows};
+    enum NPY_TYPES tp = NPY_SHORT;
+
+    if(sizeof(label_t) == sizeof(int)) {
+        tp = NPY_INT;
+    } else if (sizeof(label_t) == sizeof(long)) {
+        tp = NPY_LONG;
+    }
+
+    PyObject* labels = PyArray_SimpleNew(1, dims, tp);
+    if(hdbscan_cut_tree(scan, (distance_t)cutDistance, (label_t *)PyArray_DATA((PyArrayObject *)labels)) == HDBSCAN_ERROR){
+        Py_DECREF(labels);
+        return NULL;
+    }
+
+    return labels;
+}
+
+/**
+ * @brief 
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_approximatePredict(PyHdbscan *self, PyObject *args) {
+    PyObject *points;
+    if (!PyArg_ParseTuple(args, "O", &points))
+        return NULL;
+
+    /// The new points are converted to the datatype of the training data
+    int typenum;
+    enum HTYPES datatype = scan->distanceFunction.datatype;
+    if(datatype == H_DOUBLE) {
+        typenum = NPY_DOUBLE;
+    } else if(datatype == H_FLOAT) {
+        typenum = NPY_FLOAT32;
+    } else if(datatype == H_INT) {
+        typenum = NPY_INT32;
+    } else if(datatype == H_LONG) {
+        typenum = NPY_LONG;
+    } else {
+        typenum = NPY_SHORT;
+    }
+
+    PyArrayObject* p_arr = (PyArrayObject*)PyArray_ContiguousFromAny(points, typenum, 1, 2);
+    if(p_arr == NULL)
+        return NULL;
+
+    npy_intp m = PyArray_NDIM(p_arr) == 1 ? 1 : PyArray_DIMS(p_arr)[0];
+    npy_intp dims[] = {m};
+    enum NPY_TYPES tp = NPY_SHORT;
+
+    if(sizeof(label_t) == sizeof(int)) {
+        tp = NPY_INT;
+    } else if (sizeof(label_t) == sizeof(long)) {
+        tp = NPY_LONG;
+    }
+
+    PyObject* labels = PyArray_SimpleNew(1, dims, tp);
+    PyObject* probabilities = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+
+    int err = hdbscan_approximate_predict(scan, PyArray_DATA(p_arr), (index_t)m, 
+                (label_t *)PyArray_DATA((PyArrayObject *)labels), (distance_t *)PyArray_DATA((PyArrayObject *)probabilities));
+    Py_DECREF(p_arr);
+
+    if(err == HDBSCAN_ERROR){
+        Py_DECREF(labels);
+        Py_DECREF(probabilities);
         return NULL;
+    }
+
+    return Py_BuildValue("NN", labels, probabilities);
+}
+
+/**
+ * @brief 
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_membershipVectors(PyHdbscan *self, PyObject *args) {
 
+    npy_intp k = (npy_intp)hdbscan_selected_clusters(scan, NULL);
+    npy_intp cdims[] = {k};
+    npy_intp mdims[] = {self->rows, k};
     enum NPY_TYPES tp = NPY_SHORT;
 
     if(sizeof(label_t) == sizeof(int)) {
@@ -290,22 +515,266 @@ static PyObject* PyHdbscan_getClusterMap(PyHdbscan *self, PyObject *args) {
         tp = NPY_LONG;
     }
 
+    PyObject* clusters = PyArray_SimpleNew(1, cdims, tp);
+    PyObject* memberships = PyArray_SimpleNew(2, mdims, NPY_DOUBLE);
+
+    hdbscan_selected_clusters(scan, (label_t *)PyArray_DATA((PyArrayObject *)clusters));
+    if(hdbscan_membership_vectors(scan, (distance_t *)PyArray_DATA((PyArrayObject *)memberships)) == HDBSCAN_ERROR){
+        Py_DECREF(clusters);
+        Py_DECREF(memberships);
+        return NULL;
+    }
+
+    return Py_BuildValue("NN", clusters, memberships);
+}
+
+/**
+ * @brief 
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_getOutlierScores(PyHdbscan *self, PyObject *args) {
+    if(scan->outlierScores == NULL){
+        Py_RETURN_NONE;
+    }
+
+    npy_intp dims[] = {self->rows};
+    PyObject* scores = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    memcpy(PyArray_DATA((PyArrayObject *)scores), scan->outlierScores, self->rows * sizeof(distance_t));
+
+    return scores;
+}
+
+/**
+ * @brief 
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_topOutliers(PyHdbscan *self, PyObject *args) {
+    unsigned int k;
+    if (!PyArg_ParseTuple(args, "I", &k))
+        return NULL;
+
+    outlier_score* top = (outlier_score *)malloc(k * sizeof(outlier_score));
+    if(top == NULL)
+        return PyErr_NoMemory();
+
+    index_t n = hdbscan_top_outliers(scan, k, top);
+    npy_intp dims[] = {n};
+    PyObject* ids = PyArray_SimpleNew(1, dims, NPY_LONG);
+    PyObject* scores = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+
+    for(index_t i = 0; i < n; i++){
+        ((long *)PyArray_DATA((PyArrayObject *)ids))[i] = (long)top[i].id;
+        ((double *)PyArray_DATA((PyArrayObject *)scores))[i] = top[i].score;
+    }
+    free(top);
+
+    return Py_BuildValue("NN", ids, scores);
+}
+
+/**
+ * @brief 
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_dbcv(PyHdbscan *self, PyObject *args) {
+
+    npy_intp dims[] = {(npy_intp)hdbscan_selected_clusters(scan, NULL)};
+    PyObject* clusterValidity = PyArray_SimpleNew(1, dims, NPY_DOUBLE);
+    distance_t validity;
+
+    if(hdbscan_dbcv(scan, &validity, (distance_t *)PyArray_DATA((PyArrayObject *)clusterValidity)) == HDBSCAN_ERROR){
+        Py_DECREF(clusterValidity);
+        return NULL;
+    }
+
+    return Py_BuildValue("dN", validity, clusterValidity);
+}
+
+/**
+ * @brief Set the Python callable that is called with the phase name and the
+ * fraction done during the runs, or None to remove it. The run is cancelled
+ * if the callable returns a true value or raises.
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_setProgressCallback(PyHdbscan *self, PyObject *args) {
+    PyObject* callable;
+    if (!PyArg_ParseTuple(args, "O", &callable))
+        return NULL;
+
+    if(callable == Py_None){
+        callable = NULL;
+    } else if(!PyCallable_Check(callable)){
+        PyErr_SetString(PyExc_TypeError, "The progress callback must be callable.");
+        return NULL;
+    }
+
+    Py_XINCREF(callable);
+    Py_XDECREF(progressCallable);
+    progressCallable = callable;
+
+    hdbscan_set_progress_callback(scan, PyHdbscan_progress, progressCallable);
+    Py_RETURN_NONE;
+}
+
+/**
+ * @brief Keep a copy of the training data in the next runs so that
+ * approximatePredict can be used.
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_enablePrediction(PyHdbscan *self, PyObject *args) {
+    int enabled = 1;
+    if (!PyArg_ParseTuple(args, "|i", &enabled))
+        return NULL;
+
+    hdbscan_enable_prediction(scan, enabled ? TRUE : FALSE);
+    Py_RETURN_NONE;
+}
+
+/**
+ * @brief Start or stop recording the time and memory of each phase of the runs.
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_enableProfile(PyHdbscan *self, PyObject *args) {
+    int enabled = 1;
+    if (!PyArg_ParseTuple(args, "|i", &enabled))
+        return NULL;
+
+    hdbscan_enable_profile(scan, enabled ? TRUE : FALSE);
+    Py_RETURN_NONE;
+}
+
+/**
+ * @brief Get the profile as a dictionary of the phase names to dictionaries of
+ * wallTime, cpuTime, bytesAllocated, peakBytes and calls.
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_getProfile(PyHdbscan *self, PyObject *args) {
+    PyObject* profile = PyDict_New();
+    if(profile == NULL)
+        return NULL;
+
+    for(int phase = 0; phase < HDBSCAN_NUM_PHASES; phase++){
+        phase_profile* p = scan->profile.phases + phase;
+        PyObject* values = Py_BuildValue("{s:d,s:d,s:n,s:n,s:I}",
+            "wallTime", p->wallTime, "cpuTime", p->cpuTime,
+            "bytesAllocated", (Py_ssize_t)p->bytesAllocated, "peakBytes", (Py_ssize_t)p->peakBytes,
+            "calls", (unsigned int)p->calls);
+
+        if(values == NULL || PyDict_SetItemString(profile, profile_phase_name((HDBSCAN_PHASE)phase), values) < 0){
+            Py_XDECREF(values);
+            Py_DECREF(profile);
+            return NULL;
+        }
+        Py_DECREF(values);
+    }
+
+    return profile;
+}
+
+/**
+ * @brief Build the membership index of the labels from begin to end as three
+ * numpy arrays: the labels, the offsets and the members.
+ * 
+ * @param begin 
+ * @param end 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_createClusterMembers(index_t begin, index_t end) {
+    cluster_members cm;
+    if(hdbscan_create_cluster_members(&cm, scan->clusterLabels, begin, end) == HDBSCAN_ERROR)
+        return PyErr_NoMemory();
+
+    enum NPY_TYPES ltp = NPY_SHORT;
+    if(sizeof(label_t) == sizeof(int)) {
+        ltp = NPY_UINT;
+    } else if (sizeof(label_t) == sizeof(long)) {
+        ltp = NPY_ULONG;
+    }
+
+    enum NPY_TYPES itp = sizeof(index_t) == sizeof(long) ? NPY_ULONG : NPY_UINT;
+
+    npy_intp ldims[] = {cm.numClusters};
+    npy_intp odims[] = {cm.numClusters + 1};
+    npy_intp mdims[] = {end > begin ? end - begin : 0};
+    PyObject* labels = PyArray_SimpleNew(1, ldims, ltp);
+    PyObject* offsets = PyArray_SimpleNew(1, odims, itp);
+    PyObject* members = PyArray_SimpleNew(1, mdims, itp);
+
+    if(cm.numClusters > 0){
+        memcpy(PyArray_DATA((PyArrayObject *)labels), cm.labels, cm.numClusters * sizeof(label_t));
+        memcpy(PyArray_DATA((PyArrayObject *)offsets), cm.offsets, (cm.numClusters + 1) * sizeof(index_t));
+        memcpy(PyArray_DATA((PyArrayObject *)members), cm.members, (end - begin) * sizeof(index_t));
+    } else{
+        ((index_t *)PyArray_DATA((PyArrayObject *)offsets))[0] = 0;
+    }
+    hdbscan_cluster_members_clean(&cm);
+
+    return Py_BuildValue("NNN", labels, offsets, members);
+}
+
+/**
+ * @brief 
+ * 
+ * @param self 
+ * @param args 
+ * @return PyObject* 
+ */
+static PyObject* PyHdbscan_getClusterMembers(PyHdbscan *self, PyObject *args) {
+    unsigned int begin = 0, end = self->rows;
+    if (!PyArg_ParseTuple(args, "|II", &begin, &end))
+        return NULL;
+
+    return PyHdbscan_createClusterMembers(begin, end);
+}
+
+static PyObject* PyHdbscan_getClusterMap(PyHdbscan *self, PyObject *args) {
+    Py_XDECREF(self->clusterMap); 
+    int32_t begin, end;
+    if (!PyArg_ParseTuple(args, "ii", &begin, &end))
+        return NULL;
+
     int err = 1;
-    hashtable* tmp = hdbscan_create_cluster_map(scan->clusterLabels, begin, end);
+    PyObject* index = PyHdbscan_createClusterMembers((index_t)begin, (index_t)end);
+    if(index == NULL)
+        return NULL;
+
+    PyArrayObject* labels = (PyArrayObject *)PyTuple_GetItem(index, 0);
+    PyArrayObject* offsets = (PyArrayObject *)PyTuple_GetItem(index, 1);
+    PyObject* members = PyTuple_GetItem(index, 2);
     self->clusterMap = PyDict_New();
-    label_t label;
 
-    for(size_t i = 0; i < tmp->size; i++) {
-        label = ((label_t *)tmp->keys->data)[i];
+    // Every cluster is a view into the members array
+    for(npy_intp k = 0; k < PyArray_DIM(labels, 0); k++) {
+        label_t label = ((label_t *)PyArray_DATA(labels))[k];
+        index_t* off = (index_t *)PyArray_DATA(offsets);
         PyObject* key = Py_BuildValue("i", label);
-        ArrayList* lst;
-        hashtable_lookup(tmp, &label, &lst);
-        npy_intp dims[] = {lst->size, 1};
-        label_t* labels = lst->data;
-        PyObject* value = PyArray_SimpleNewFromData(1, dims, tp, labels);
+        PyObject* value = PySequence_GetSlice(members, off[k], off[k + 1]);
         PyDict_SetItem(self->clusterMap, key, value);
+        Py_DECREF(key);
+        Py_DECREF(value);
     }
 
+    Py_DECREF(index);
     Py_INCREF(self->clusterMap);
     return Py_BuildValue("i", err);
 }
@@ -324,10 +793,11 @@ static PyObject* PyHdbscan_getHierarchies(PyHdbscan *self, PyObject *args) {
     self->hierarchy = PyDict_New();
     int64_t level;
 	hierarchy_entry* data;
+    set_t* levels = hashtable_keys(scan->hierarchy);
 
     for(size_t i = 0; i < hashtable_size(scan->hierarchy); i++) {
         
-		set_value_at(scan->hierarchy->keys, i, &level);
+		set_value_at(levels, i, &level);
         hashtable_lookup(scan->hierarchy, &level, &data);
         npy_intp dims[] = {scan->numPoints, 1};
         PyObject* value = PyArray_SimpleNewFromData(1, dims, tp, data->labels);
@@ -346,6 +816,19 @@ static PyObject* PyHdbscan_getHierarchies(PyHdbscan *self, PyObject *args) {
 static PyMethodDef PyHdbscan_methods[] = {
     {"run", (PyCFunction)PyHdbscan_run, METH_VARARGS, "Run the clustering algorithm and extract cluster labels."},
     {"rerun", (PyCFunction)PyHdbscan_rerun, METH_VARARGS, "Extract clusters using old dataset and new minPoints."},
+    {"reselect", (PyCFunction)PyHdbscan_reselect, METH_VARARGS, "Extract clusters from the last minimum spanning tree with a new minClusterSize."},
+    {"selectClusters", (PyCFunction)PyHdbscan_selectClusters, METH_VARARGS, "Select the clusters again from the cluster tree: selectClusters(leaf=False, epsilon=0.0)."},
+    {"cutTree", (PyCFunction)PyHdbscan_cutTree, METH_VARARGS, "Get the labels of the clustering at the given cut distance."},
+    {"approximatePredict", (PyCFunction)PyHdbscan_approximatePredict, METH_VARARGS, "Get the labels and membership probabilities of new points without running again, after a run with enablePrediction()."},
+    {"enablePrediction", (PyCFunction)PyHdbscan_enablePrediction, METH_VARARGS, "Keep a copy of the training data in the next runs for approximatePredict: enablePrediction(enabled=True)."},
+    {"membershipVectors", (PyCFunction)PyHdbscan_membershipVectors, METH_NOARGS, "Get the selected clusters and the soft membership of every point in each of them."},
+    {"getOutlierScores", (PyCFunction)PyHdbscan_getOutlierScores, METH_NOARGS, "Get the GLOSH outlier score of every point, in id order."},
+    {"topOutliers", (PyCFunction)PyHdbscan_topOutliers, METH_VARARGS, "Get the ids and scores of the k most outlying points."},
+    {"dbcv", (PyCFunction)PyHdbscan_dbcv, METH_NOARGS, "Get the DBCV validity index and the validity of every selected cluster."},
+    {"enableProfile", (PyCFunction)PyHdbscan_enableProfile, METH_VARARGS, "Start or stop recording the time and memory of each phase of the runs: enableProfile(enabled=True)."},
+    {"getProfile", (PyCFunction)PyHdbscan_getProfile, METH_NOARGS, "Get the wall time, CPU time, bytes allocated and peak bytes of each phase as a dict."},
+    {"setProgressCallback", (PyCFunction)PyHdbscan_setProgressCallback, METH_VARARGS, "Call callback(phase, fraction) during the runs; a true return value or an exception cancels the run."},
+    {"getClusterMembers", (PyCFunction)PyHdbscan_getClusterMembers, METH_VARARGS, "Get the cluster membership index as (labels, offsets, members) arrays."},
     {"getClusterMap", (PyCFunction)PyHdbscan_getClusterMap, METH_VARARGS, "Get a mapping of the cluster labels to the points."},
     {"getHierarchies", (PyCFunction)PyHdbscan_getHierarchies, METH_VARARGS, "Get the hierarchy data."},
     {NULL}  /* Sentinel */
@@ -359,7 +842,8 @@ static PyMemberDef PyHdbscan_members[] = {
     {"labels", T_OBJECT_EX, offsetof(PyHdbscan, labels), 0, "Cluster labels"},
     {"clusterMap", T_OBJECT_EX, offsetof(PyHdbscan, clusterMap), 0, "Dictionary of the clusters and the points"},
     {"hierarchy", T_OBJECT_EX, offsetof(PyHdbscan, hierarchy), 0, "Dictionary of the hierarchies"},
-    {"minPoints", T_INT, offsetof(PyHdbscan, minPoints), 0, "Minimum number of point in a cluster"},
+    {"minPoints", T_INT, offsetof(PyHdbscan, minPoints), 0, "Number of neighbours used for the core distances"},
+    {"minClusterSize", T_INT, offsetof(PyHdbscan, minClusterSize), 0, "Minimum number of point in a cluster"},
     {"rows", T_INT, offsetof(PyHdbscan, rows), 0, "number of data points"},
     {"cols", T_INT, offsetof(PyHdbscan, cols), 0, "The size of each data point"},
     {NULL}  /* Sentinel */
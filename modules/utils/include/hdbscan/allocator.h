@@ -0,0 +1,187 @@
+/**
+ * allocator.h
+ *
+ * Copyright 2019 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file allocator.h
+ *
+ * \brief The memory allocator used by hdbscan, listlib and utils.
+ *
+ * Every allocation the libraries make internally goes through the
+ * hdbscan_malloc() family of functions, which call the hooks of the current
+ * allocator. By default these are the C library functions. An application
+ * can install its own allocator with hdbscan_set_allocator(), for example
+ * to allocate from jemalloc arenas or huge pages, or to count and cap the
+ * memory used.
+ *
+ * The allocator is process-wide. It must be installed before any hdbscan
+ * object is created and must not be changed while memory allocated through
+ * it is still alive, because memory is always released through the free
+ * hook of the current allocator. The hooks are called from OpenMP worker
+ * threads and must be thread-safe.
+ */
+#ifndef HDBSCAN_ALLOCATOR_H_
+#define HDBSCAN_ALLOCATOR_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+
+/**
+ * \struct HDBSCAN_ALLOCATOR
+ *
+ * @brief The hooks of an allocator. Each hook gets the ctx of the allocator
+ * as its last argument.
+ *
+ * malloc, realloc and free are required. calloc may be NULL, in which case
+ * the memory is allocated with malloc and zeroed. aligned_alloc may be NULL,
+ * in which case aligned allocations fall back to malloc and only get the
+ * alignment that malloc guarantees. Memory returned by aligned_alloc is
+ * released with free.
+ *
+ * \typedef hdbscan_allocator
+ */
+typedef struct HDBSCAN_ALLOCATOR
+{
+	void* (*malloc)(size_t size, void* ctx);
+	void* (*calloc)(size_t n, size_t size, void* ctx);
+	void* (*realloc)(void* ptr, size_t size, void* ctx);
+	void (*free)(void* ptr, void* ctx);
+	void* (*aligned_alloc)(size_t alignment, size_t size, void* ctx);
+	void* ctx;
+} hdbscan_allocator;
+
+/**
+ * @brief Install the allocator used for all allocations of the library. The
+ * hooks are copied, so the structure does not have to outlive the call.
+ *
+ * @param allocator The allocator, or NULL to restore the C library allocator
+ * @return int 1 if the allocator was installed, 0 if one of the required
+ * hooks is missing
+ */
+int hdbscan_set_allocator(const hdbscan_allocator* allocator);
+
+/**
+ * @brief Get the current allocator.
+ *
+ * @return const hdbscan_allocator*
+ */
+const hdbscan_allocator* hdbscan_get_allocator();
+
+/**
+ * @brief Allocate size bytes with the current allocator.
+ *
+ * @param size
+ * @return void*
+ */
+void* hdbscan_malloc(size_t size);
+
+/**
+ * @brief Allocate n zeroed elements of size bytes with the current allocator.
+ *
+ * @param n
+ * @param size
+ * @return void*
+ */
+void* hdbscan_calloc(size_t n, size_t size);
+
+/**
+ * @brief Resize memory allocated with the current allocator.
+ *
+ * @param ptr
+ * @param size
+ * @return void*
+ */
+void* hdbscan_realloc(void* ptr, size_t size);
+
+/**
+ * @brief Release memory allocated with the current allocator. NULL is
+ * ignored.
+ *
+ * @param ptr
+ */
+void hdbscan_free(void* ptr);
+
+/**
+ * @brief Allocate size bytes aligned to alignment, a power of two, with the
+ * current allocator. The memory is released with hdbscan_free().
+ *
+ * @param alignment
+ * @param size
+ * @return void*
+ */
+void* hdbscan_aligned_alloc(size_t alignment, size_t size);
+
+/**
+ * @brief Start counting the bytes allocated. Calls nest, counting goes on
+ * until every hdbscan_memory_track_begin() has been matched by a call to
+ * hdbscan_memory_track_end().
+ *
+ * Counting needs the library to be compiled with HDBSCAN_PROFILE, which
+ * puts a small header in front of every allocation to remember its size.
+ * Otherwise the counters stay at 0. The counters are process-wide.
+ */
+void hdbscan_memory_track_begin();
+
+/**
+ * @brief Stop counting the bytes allocated. Memory allocated while counting
+ * is still taken off the live bytes when it is released.
+ */
+void hdbscan_memory_track_end();
+
+/**
+ * @brief Total number of bytes allocated while counting.
+ *
+ * @return size_t
+ */
+size_t hdbscan_memory_allocated();
+
+/**
+ * @brief Number of bytes allocated while counting that have not been
+ * released yet.
+ *
+ * @return size_t
+ */
+size_t hdbscan_memory_live();
+
+/**
+ * @brief Highest number of live bytes since the last call to
+ * hdbscan_memory_reset_peak().
+ *
+ * @return size_t
+ */
+size_t hdbscan_memory_peak();
+
+/**
+ * @brief Set the peak to the current number of live bytes.
+ */
+void hdbscan_memory_reset_peak();
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* HDBSCAN_ALLOCATOR_H_ */
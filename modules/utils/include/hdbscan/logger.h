@@ -44,22 +44,65 @@ enum LOGTYPE {
     WARN,       // Any circumstance that may not affect normal operation
     NONE        // Logging that does need the time and type of the message
 };
+
+/*!
+ * \brief Messages of a type after LOGGER_LEVEL in enum LOGTYPE are compiled
+ * out, for example -DLOGGER_LEVEL=ERROR keeps only FATAL and ERROR messages
+ * and drops the NONE dumps of the print functions.
+ */
+#ifndef LOGGER_LEVEL
+#define LOGGER_LEVEL NONE
+#endif
+
+/*!
+ * \brief Number of messages the ring buffer holds, a power of two. Writers
+ * wait for the flusher when it is full.
+ */
+#define LOGGER_BUFFER_SIZE 4096
+
+/*!
+ * \brief Number of bytes of a message held by one slot of the ring buffer.
+ * Longer messages take several slots.
+ */
+#define LOGGER_MESSAGE_SIZE 224
+
 /*!
- * \brief Initalise the logger. We can choose to open the log file if
- * the library was compiled with -D DEBUG_ENABLE=TRUE 
+ * \brief Initalise the logger and start the thread that writes the messages.
+ * The messages go to hdbscan.log if the library was compiled with
+ * -D DEBUG_ENABLE=TRUE and to stdout otherwise. Before logger_init() and
+ * after logger_close() messages are written synchronously.
  */
 void logger_init();
 
 /*!
- * \brief Write the log either 
+ * \brief Queue the message for writing. Only the type, the time and a copy
+ * of str are queued, without taking a lock; the date and the type are
+ * formatted by the flusher thread. FATAL messages are flushed before
+ * logger_write returns.
  * 
  * \param type 
  * \param str 
  */
 void logger_write(enum LOGTYPE type, const char* str);
+
+/*!
+ * \brief Filter the messages by LOGGER_LEVEL at compile time
+ */
+#define logger_write(type, str) ((type) <= LOGGER_LEVEL ? logger_write((type), (str)) : (void)0)
+
+/*!
+ * \brief Wait until every message queued so far has been written
+ */
+void logger_flush();
+
+/*!
+ * \brief Write the queued messages, stop the flusher thread and close the
+ * log file. Must not be called while other threads are still logging.
+ */
 void logger_close();
-#endif
+
 #ifdef __cplusplus
 }
+#endif
 
 #endif /* HDBSCAN_LOGGER_H_ */
@@ -38,8 +38,10 @@ extern "C" {
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdint.h>
 #include <math.h>
 #include "config.h"
+#include "hdbscan/allocator.h"
 
 #ifndef boolean
 typedef int boolean;
@@ -177,6 +179,24 @@ inline uint hostFistTriangleNum(uint p)
     return (uint)ceil((sqrt(8 * p + 1) - 1) / 2);
 }
 
+/**
+ * @brief Scramble the bits of x so that keys that differ in a few bits, like
+ * consecutive integers, spread over all the bits of the hash.
+ * 
+ * @param x 
+ * @return size_t 
+ */
+static inline size_t hash_mix(uint64_t x)
+{
+	x ^= x >> 30;
+	x *= 0xbf58476d1ce4e5b9ULL;
+	x ^= x >> 27;
+	x *= 0x94d049bb133111ebULL;
+	x ^= x >> 31;
+
+	return (size_t)x;
+}
+
 /**
  * @brief Create a hash of the key.
  * 
@@ -198,15 +218,6 @@ size_t float_hash(void* key, size_t buckets);
 
 size_t str_hash(void *key, size_t buckets);
 
-/**
- * @brief Compare hashtable entries using keys
- * 
- * @param a 
- * @param b 
- * @return int32_t 
- */
-int32_t hashtable_entry_compare(const void* a, const void* b);
-
 void distance_timsort();
 
 #ifdef __cplusplus
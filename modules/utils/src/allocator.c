@@ -0,0 +1,458 @@
+/**
+ * allocator.c
+ *
+ * Copyright 2019 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * \file allocator.c
+ *
+ * \brief Implementation of the functions in allocator.h
+ */
+
+#include "hdbscan/allocator.h"
+#include "config.h"
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+
+static void* default_malloc(size_t size, void* ctx)
+{
+	(void)ctx;
+	return malloc(size);
+}
+
+static void* default_calloc(size_t n, size_t size, void* ctx)
+{
+	(void)ctx;
+	return calloc(n, size);
+}
+
+static void* default_realloc(void* ptr, size_t size, void* ctx)
+{
+	(void)ctx;
+	return realloc(ptr, size);
+}
+
+static void default_free(void* ptr, void* ctx)
+{
+	(void)ctx;
+	free(ptr);
+}
+
+static void* default_aligned_alloc(size_t alignment, size_t size, void* ctx)
+{
+	(void)ctx;
+	void* ptr = NULL;
+
+	if(alignment < sizeof(void*))
+	{
+		alignment = sizeof(void*);
+	}
+
+	return posix_memalign(&ptr, alignment, size) == 0 ? ptr : NULL;
+}
+
+static const hdbscan_allocator default_allocator = {
+	default_malloc, default_calloc, default_realloc, default_free, default_aligned_alloc, NULL
+};
+
+static hdbscan_allocator current_allocator = {
+	default_malloc, default_calloc, default_realloc, default_free, default_aligned_alloc, NULL
+};
+
+/**
+ * @brief
+ *
+ */
+int hdbscan_set_allocator(const hdbscan_allocator* allocator)
+{
+	if(allocator == NULL)
+	{
+		current_allocator = default_allocator;
+		return 1;
+	}
+
+	if(allocator->malloc == NULL || allocator->realloc == NULL || allocator->free == NULL)
+	{
+		return 0;
+	}
+
+	current_allocator = *allocator;
+	return 1;
+}
+
+/**
+ * @brief
+ *
+ */
+const hdbscan_allocator* hdbscan_get_allocator()
+{
+	return &current_allocator;
+}
+
+#ifdef HDBSCAN_PROFILE
+/**
+ * Every allocation starts with a header of two size_t: the size of the
+ * allocation and the offset of the pointer handed out from the start of the
+ * block. The top bit of the size marks allocations that were counted.
+ */
+#define ALLOCATOR_HEADER_SIZE 16
+#define ALLOCATOR_COUNTED ((size_t)1 << (sizeof(size_t) * 8 - 1))
+
+static int tracking = 0;
+static size_t allocated_bytes = 0;
+static size_t live_bytes = 0;
+static size_t peak_bytes = 0;
+
+/**
+ * @brief Write the header of the allocation of size bytes at offset in
+ * block and count it if tracking is on.
+ */
+static void* allocator_track(void* block, size_t offset, size_t size)
+{
+	if(block == NULL)
+	{
+		return NULL;
+	}
+
+	size_t* ptr = (size_t*)((char*)block + offset);
+	if(__atomic_load_n(&tracking, __ATOMIC_RELAXED) > 0)
+	{
+		__atomic_fetch_add(&allocated_bytes, size, __ATOMIC_RELAXED);
+		size_t now = __atomic_add_fetch(&live_bytes, size, __ATOMIC_RELAXED);
+		size_t peak = __atomic_load_n(&peak_bytes, __ATOMIC_RELAXED);
+		while(now > peak && !__atomic_compare_exchange_n(&peak_bytes, &peak, now, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+		size |= ALLOCATOR_COUNTED;
+	}
+
+	ptr[-2] = size;
+	ptr[-1] = offset;
+
+	return ptr;
+}
+
+/**
+ * @brief Take the allocation at ptr off the live bytes if it was counted and
+ * return the start of its block.
+ */
+static void* allocator_untrack(void* ptr)
+{
+	size_t size = ((size_t*)ptr)[-2];
+	if(size & ALLOCATOR_COUNTED)
+	{
+		__atomic_fetch_sub(&live_bytes, size & ~ALLOCATOR_COUNTED, __ATOMIC_RELAXED);
+	}
+
+	return (char*)ptr - ((size_t*)ptr)[-1];
+}
+
+/**
+ * @brief
+ *
+ */
+void* hdbscan_malloc(size_t size)
+{
+	if(size > SIZE_MAX - ALLOCATOR_HEADER_SIZE)
+	{
+		return NULL;
+	}
+
+	return allocator_track(current_allocator.malloc(size + ALLOCATOR_HEADER_SIZE, current_allocator.ctx), ALLOCATOR_HEADER_SIZE, size);
+}
+
+/**
+ * @brief
+ *
+ */
+void* hdbscan_calloc(size_t n, size_t size)
+{
+	if(size != 0 && n > (SIZE_MAX - ALLOCATOR_HEADER_SIZE) / size)
+	{
+		return NULL;
+	}
+
+	size *= n;
+	if(current_allocator.calloc != NULL)
+	{
+		return allocator_track(current_allocator.calloc(1, size + ALLOCATOR_HEADER_SIZE, current_allocator.ctx), ALLOCATOR_HEADER_SIZE, size);
+	}
+
+	void* ptr = hdbscan_malloc(size);
+	if(ptr != NULL)
+	{
+		memset(ptr, 0, size);
+	}
+
+	return ptr;
+}
+
+/**
+ * @brief
+ *
+ */
+void* hdbscan_realloc(void* ptr, size_t size)
+{
+	if(ptr == NULL)
+	{
+		return hdbscan_malloc(size);
+	}
+
+	if(size > SIZE_MAX - ALLOCATOR_HEADER_SIZE)
+	{
+		return NULL;
+	}
+
+	size_t old = ((size_t*)ptr)[-2] & ~ALLOCATOR_COUNTED;
+	if(((size_t*)ptr)[-1] != ALLOCATOR_HEADER_SIZE)
+	{
+		// Aligned blocks can not be resized in place without losing the alignment
+		void* p = hdbscan_malloc(size);
+		if(p != NULL)
+		{
+			memcpy(p, ptr, old < size ? old : size);
+			hdbscan_free(ptr);
+		}
+
+		return p;
+	}
+
+	void* block = current_allocator.realloc((char*)ptr - ALLOCATOR_HEADER_SIZE, size + ALLOCATOR_HEADER_SIZE, current_allocator.ctx);
+	if(block == NULL)
+	{
+		return NULL;
+	}
+
+	size_t* p = (size_t*)((char*)block + ALLOCATOR_HEADER_SIZE);
+	allocator_untrack(p);
+
+	return allocator_track(block, ALLOCATOR_HEADER_SIZE, size);
+}
+
+/**
+ * @brief
+ *
+ */
+void hdbscan_free(void* ptr)
+{
+	if(ptr != NULL)
+	{
+		current_allocator.free(allocator_untrack(ptr), current_allocator.ctx);
+	}
+}
+
+/**
+ * @brief
+ *
+ */
+void* hdbscan_aligned_alloc(size_t alignment, size_t size)
+{
+	if(current_allocator.aligned_alloc == NULL)
+	{
+		return hdbscan_malloc(size);
+	}
+
+	size_t offset = alignment > ALLOCATOR_HEADER_SIZE ? alignment : ALLOCATOR_HEADER_SIZE;
+	if(size > SIZE_MAX - offset)
+	{
+		return NULL;
+	}
+
+	return allocator_track(current_allocator.aligned_alloc(alignment, size + offset, current_allocator.ctx), offset, size);
+}
+
+/**
+ * @brief
+ *
+ */
+void hdbscan_memory_track_begin()
+{
+	__atomic_fetch_add(&tracking, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief
+ *
+ */
+void hdbscan_memory_track_end()
+{
+	__atomic_fetch_sub(&tracking, 1, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief
+ *
+ */
+size_t hdbscan_memory_allocated()
+{
+	return __atomic_load_n(&allocated_bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief
+ *
+ */
+size_t hdbscan_memory_live()
+{
+	return __atomic_load_n(&live_bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief
+ *
+ */
+size_t hdbscan_memory_peak()
+{
+	return __atomic_load_n(&peak_bytes, __ATOMIC_RELAXED);
+}
+
+/**
+ * @brief
+ *
+ */
+void hdbscan_memory_reset_peak()
+{
+	__atomic_store_n(&peak_bytes, hdbscan_memory_live(), __ATOMIC_RELAXED);
+}
+
+#else
+/**
+ * @brief
+ *
+ */
+void* hdbscan_malloc(size_t size)
+{
+	return current_allocator.malloc(size, current_allocator.ctx);
+}
+
+/**
+ * @brief
+ *
+ */
+void* hdbscan_calloc(size_t n, size_t size)
+{
+	if(current_allocator.calloc != NULL)
+	{
+		return current_allocator.calloc(n, size, current_allocator.ctx);
+	}
+
+	if(size != 0 && n > SIZE_MAX / size)
+	{
+		return NULL;
+	}
+
+	void* ptr = current_allocator.malloc(n * size, current_allocator.ctx);
+	if(ptr != NULL)
+	{
+		memset(ptr, 0, n * size);
+	}
+
+	return ptr;
+}
+
+/**
+ * @brief
+ *
+ */
+void* hdbscan_realloc(void* ptr, size_t size)
+{
+	return current_allocator.realloc(ptr, size, current_allocator.ctx);
+}
+
+/**
+ * @brief
+ *
+ */
+void hdbscan_free(void* ptr)
+{
+	if(ptr != NULL)
+	{
+		current_allocator.free(ptr, current_allocator.ctx);
+	}
+}
+
+/**
+ * @brief
+ *
+ */
+void* hdbscan_aligned_alloc(size_t alignment, size_t size)
+{
+	if(current_allocator.aligned_alloc != NULL)
+	{
+		return current_allocator.aligned_alloc(alignment, size, current_allocator.ctx);
+	}
+
+	return current_allocator.malloc(size, current_allocator.ctx);
+}
+
+/**
+ * @brief
+ *
+ */
+void hdbscan_memory_track_begin()
+{
+}
+
+/**
+ * @brief
+ *
+ */
+void hdbscan_memory_track_end()
+{
+}
+
+/**
+ * @brief
+ *
+ */
+size_t hdbscan_memory_allocated()
+{
+	return 0;
+}
+
+/**
+ * @brief
+ *
+ */
+size_t hdbscan_memory_live()
+{
+	return 0;
+}
+
+/**
+ * @brief
+ *
+ */
+size_t hdbscan_memory_peak()
+{
+	return 0;
+}
+
+/**
+ * @brief
+ *
+ */
+void hdbscan_memory_reset_peak()
+{
+}
+#endif /* HDBSCAN_PROFILE */
@@ -44,24 +44,190 @@
 #include <string.h>
 #include <assert.h>
 #include <time.h>
+#include <sched.h>
+#include <pthread.h>
 
-static FILE* log_file;
-static char* getDateString() {
-    // Initialize and get current time
-    time_t t = time( NULL );
+/**
+ * Milliseconds the flusher sleeps when the ring buffer is empty
+ */
+#define LOGGER_FLUSH_INTERVAL 10
+
+/**
+ * \struct LogRecord
+ * 
+ * @brief A slot of the ring buffer. A message longer than
+ * LOGGER_MESSAGE_SIZE is queued in consecutive records, of which only the
+ * first has the header with the date and the type.
+ */
+typedef struct LogRecord {
+    size_t sequence;                    /// The position the slot can be written (sequence == position) or read (sequence == position + 1) at
+    enum LOGTYPE type;
+    int header;
+    time_t time;
+    size_t length;
+    char text[LOGGER_MESSAGE_SIZE];
+} log_record;
+
+#ifdef DEBUG
+static FILE* log_file = NULL;
+#endif
+
+/**
+ * The ring buffer is a bounded multi-producer, single-consumer queue:
+ * writers claim a position with a compare and swap on head and publish the
+ * record through its sequence, the flusher thread reads them in order.
+ */
+static log_record ring[LOGGER_BUFFER_SIZE];
+static size_t head = 0;                 /// Next position to write
+static size_t tail = 0;                 /// Next position to read, only changed by the flusher
+static size_t flushed = 0;              /// Every position before this one has been written out
+static int running = 0;
+static int registered = 0;
+static pthread_t flusher;
+static pthread_mutex_t wake_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t wake = PTHREAD_COND_INITIALIZER;
+
+static FILE* logger_output() {
+#ifdef DEBUG
+    assert(log_file != NULL);
+    return log_file;
+#else
+    return stdout;
+#endif
+}
+
+static const char* logger_type_name(enum LOGTYPE type) {
+    if(type == FATAL) {
+        return "FATAL";
+    } else if (type == ERROR) {
+        return "ERROR";
+    } else if (type == INFO) {
+        return "INFO";
+    } else if (type == WARN)  {
+        return "WARN";
+    } else {
+        return "";
+    }
+}
+
+static void logger_format_date(time_t t, char* date, size_t size) {
+    struct tm tm;
+    localtime_r(&t, &tm);
+    strftime(date, size, "[%F %T]", &tm);
+}
+
+/**
+ * @brief Write the header of a message from the flusher, formatting the
+ * date only when the second has changed since the last message
+ */
+static void logger_write_header(FILE* out, enum LOGTYPE type, time_t t) {
+    static time_t last = (time_t)-1;
+    static char date[32];
+
+    if(t != last) {
+        logger_format_date(t, date, sizeof(date));
+        last = t;
+    }
+
+    fprintf(out, "%s %s: ", date, logger_type_name(type));
+}
+
+static void logger_wake() {
+    pthread_mutex_lock(&wake_lock);
+    pthread_cond_signal(&wake);
+    pthread_mutex_unlock(&wake_lock);
+}
+
+/**
+ * @brief Claim count consecutive slots of the ring buffer, waiting for the
+ * flusher if the buffer is full. The flusher frees the slots in order, so
+ * they are all free once the last one is.
+ */
+static size_t logger_claim(size_t count) {
+    size_t pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+
+    for(;;) {
+        size_t last = pos + count - 1;
+        size_t seq = __atomic_load_n(&ring[last & (LOGGER_BUFFER_SIZE - 1)].sequence, __ATOMIC_ACQUIRE);
+
+        if(seq == last) {
+            if(__atomic_compare_exchange_n(&head, &pos, pos + count, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+                return pos;
+            }
+        } else {
+            if(seq < last) {
+                /// Full, the flusher has not read this slot yet
+                logger_wake();
+                sched_yield();
+            }
+            pos = __atomic_load_n(&head, __ATOMIC_RELAXED);
+        }
+    }
+}
+
+/**
+ * @brief Write out the published records and return how many there were
+ */
+static size_t logger_drain(FILE* out) {
+    size_t count = 0;
+
+    for(;;) {
+        log_record* r = ring + (tail & (LOGGER_BUFFER_SIZE - 1));
+        if(__atomic_load_n(&r->sequence, __ATOMIC_ACQUIRE) != tail + 1) {
+            return count;
+        }
 
-    // Allocate space for date string
-    char* date = (char*)malloc( 100 );
+        if(r->header && r->type != NONE) {
+            logger_write_header(out, r->type, r->time);
+        }
+        fwrite(r->text, 1, r->length, out);
+
+        __atomic_store_n(&r->sequence, tail + LOGGER_BUFFER_SIZE, __ATOMIC_RELEASE);
+        __atomic_store_n(&tail, tail + 1, __ATOMIC_RELEASE);
+        count++;
+    }
+}
+
+static void* logger_flusher(void* arg) {
+    (void)arg;
+    FILE* out = logger_output();
+
+    for(;;) {
+        if(logger_drain(out) > 0) {
+            fflush(out);
+            __atomic_store_n(&flushed, tail, __ATOMIC_RELEASE);
+            continue;
+        }
+
+        /// Stop once everything claimed has been written
+        if(!__atomic_load_n(&running, __ATOMIC_ACQUIRE) && __atomic_load_n(&head, __ATOMIC_ACQUIRE) == tail) {
+            return NULL;
+        }
 
-    // Format the time correctly
-    strftime(date, 100, "[%F %T]", localtime(&t));
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_nsec += LOGGER_FLUSH_INTERVAL * 1000000L;
+        if(until.tv_nsec >= 1000000000L) {
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000L;
+        }
+
+        pthread_mutex_lock(&wake_lock);
+        pthread_cond_timedwait(&wake, &wake_lock, &until);
+        pthread_mutex_unlock(&wake_lock);
+    }
+}
 
-    return date;
+static void logger_exit() {
+    logger_close();
 }
 
 void logger_init()
 {
-    log_file = NULL; //! Make sure the log file pointer is null
+    if(__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        return;
+    }
+
     /*!
      * \brief Only open the file if the library was compiled for debugging
      * 
@@ -73,56 +239,106 @@ void logger_init()
 
         if(log_file == NULL) {
             printf("Log file not opened.");
+            return;
         }
     }
 #endif
+
+    for(size_t i = 0; i < LOGGER_BUFFER_SIZE; i++) {
+        ring[i].sequence = i;
+    }
+    head = tail = flushed = 0;
+
+    __atomic_store_n(&running, 1, __ATOMIC_RELEASE);
+    if(pthread_create(&flusher, NULL, logger_flusher, NULL) != 0) {
+        /// Fall back to writing synchronously
+        __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+        return;
+    }
+
+    /// Write whatever is still queued when the program exits
+    if(!registered) {
+        registered = 1;
+        atexit(logger_exit);
+    }
 }
 
-void logger_write(enum LOGTYPE type, const char* str) {
+void (logger_write)(enum LOGTYPE type, const char* str) {
 
-    /** Must check the file is open if we logging to it */
-#ifdef DEBUG
-    assert(log_file != NULL);
-#endif
+    time_t t = type == NONE ? 0 : time(NULL);
 
-    char* date = getDateString();
-    const char* tp;
+    if(!__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        FILE* out = logger_output();
+
+        /** If the LOGTYPE is none, we do not add the timestamp information to the log */
+        if(type != NONE) {
+            char date[32];
+            logger_format_date(t, date, sizeof(date));
+            fprintf(out, "%s %s: %s", date, logger_type_name(type), str);
+        } else {
+            fputs(str, out);
+        }
+        return;
+    }
+
+    size_t length = strlen(str);
+    int header = 1;
+
+    do {
+        /// Claim the slots of the whole message at once so that it is not
+        /// interleaved with the messages of other threads
+        size_t count = length == 0 ? 1 : (length + LOGGER_MESSAGE_SIZE - 1) / LOGGER_MESSAGE_SIZE;
+        if(count > LOGGER_BUFFER_SIZE) {
+            count = LOGGER_BUFFER_SIZE;
+        }
+
+        size_t position = logger_claim(count);
+        for(size_t i = 0; i < count; i++) {
+            log_record* r = ring + ((position + i) & (LOGGER_BUFFER_SIZE - 1));
+            size_t n = length < LOGGER_MESSAGE_SIZE ? length : LOGGER_MESSAGE_SIZE;
+
+            r->type = type;
+            r->header = header;
+            r->time = t;
+            r->length = n;
+            memcpy(r->text, str, n);
+            __atomic_store_n(&r->sequence, position + i + 1, __ATOMIC_RELEASE);
+
+            str += n;
+            length -= n;
+            header = 0;
+        }
+    } while(length > 0);
 
     if(type == FATAL) {
-        tp = "FATAL";
-    } else if (type == ERROR) {
-        tp = "ERROR";
-    } else if (type == INFO) {
-        tp = "INFO";
-    } else if (type == WARN)  {
-        tp = "WARN";
-    } else {
-        tp = "";
-    }
-    
-    /** If the LOGTYPE is none, we do not add the timestamp information to the log */
-    if(type != NONE) {
-        size_t sz = strlen(date) + strlen(tp) + strlen(str) + 10;
-        char buffer[sz];
-        sprintf(buffer, "%s %s: %s", date, tp, str);
-    #ifdef DEBUG
-        fprintf(log_file, "%s", buffer);
-    #else
-        printf("%s", buffer);
-    #endif
-    } else {
-    #ifdef DEBUG
-        fprintf(log_file, "%s", str);
-    #else
-        printf("%s", str);
-    #endif
+        logger_flush();
+    }
+}
+
+void logger_flush() {
+    if(!__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        fflush(logger_output());
+        return;
+    }
+
+    size_t target = __atomic_load_n(&head, __ATOMIC_ACQUIRE);
+    while(__atomic_load_n(&flushed, __ATOMIC_ACQUIRE) < target) {
+        logger_wake();
+        sched_yield();
     }
-    free(date);
 }
 
 void logger_close() {
+    if(__atomic_load_n(&running, __ATOMIC_ACQUIRE)) {
+        __atomic_store_n(&running, 0, __ATOMIC_RELEASE);
+        logger_wake();
+        pthread_join(flusher, NULL);
+    }
+
 #ifdef DEBUG
-    assert(log_file != NULL);
-    fclose(log_file);
+    if(log_file != NULL) {
+        fclose(log_file);
+        log_file = NULL;
+    }
 #endif
 }
@@ -316,43 +316,42 @@ size_t get_htype_size(enum HTYPES type)
 size_t int_hash(void* key, size_t buckets)
 {
 	int32_t k = (*(int32_t *)key);
-	size_t tmp = (size_t)k;
-    return tmp % buckets;
+    return hash_mix((uint64_t)(uint32_t)k) % buckets;
 }
 
 size_t long_hash(void* key, size_t buckets)
 {
 	long k = (*(long *)key);
-	size_t tmp = (size_t)k;
-    return tmp % buckets;
+    return hash_mix((uint64_t)k) % buckets;
 }
 
 size_t short_hash(void* key, size_t buckets)
 {
 	short k = (*(short *)key);
-	size_t tmp = (size_t)k;
-    return tmp % buckets;
+    return hash_mix((uint64_t)(uint16_t)k) % buckets;
 }
 
 size_t char_hash(void* key, size_t buckets)
 {
     char *db = (char *)key;
-	size_t tmp = (size_t)(*db);
-    return tmp % buckets;
+    return hash_mix((uint64_t)(unsigned char)(*db)) % buckets;
 }
 
 size_t double_hash(void* key, size_t buckets)
 {
-    double *db = (double *)key;
-	size_t tmp = (size_t)(*db);
-    return tmp % buckets;
+	// Adding 0 turns -0.0 into 0.0 so that both hash the same
+    double db = *(double *)key + 0.0;
+	uint64_t bits;
+	memcpy(&bits, &db, sizeof(bits));
+    return hash_mix(bits) % buckets;
 }
 
 size_t float_hash(void* key, size_t buckets)
 {
-    float *db = (float *)key;
-	size_t tmp = (size_t)(*db);
-    return tmp % buckets;
+    float db = *(float *)key + 0.0f;
+	uint32_t bits;
+	memcpy(&bits, &db, sizeof(bits));
+    return hash_mix((uint64_t)bits) % buckets;
 }
 
 size_t str_hash(void *key, size_t buckets)
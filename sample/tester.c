@@ -154,9 +154,10 @@ int main(int argc, char** argv){
 				sorted->compare = short_compare;
 			}
 
-			for(size_t i = 0; i < set_size(clusterTable->keys); i++){
+			set_t* keys = hashtable_keys(clusterTable);
+			for(size_t i = 0; i < set_size(keys); i++){
 				label_t k;
-				set_value_at(clusterTable->keys, i, &k);
+				set_value_at(keys, i, &k);
 				array_list_append(sorted, &k);
 			}
 
@@ -197,7 +198,10 @@ int main(int argc, char** argv){
 			}
 			logger_write(NONE, "]\n\n");
 			
-			hdbscan_print_outlier_scores(scan->outlierScores, scan->numPoints);
+			outlier_score* outliers = (outlier_score*)malloc(scan->numPoints * sizeof(outlier_score));
+			index_t numOutliers = hdbscan_top_outliers(scan, scan->numPoints, outliers);
+			hdbscan_print_outlier_scores(outliers, numOutliers);
+			free(outliers);
 						
 			hdbscan_destroy_distance_map(dMap);
 			hdbscan_destroy_cluster_map(clusterTable);
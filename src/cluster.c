@@ -54,7 +54,7 @@
 cluster* cluster_init(cluster* cl, label_t label, cluster* parent, distance_t birthLevel, index_t numPoints){
 	
 	if(cl == NULL){
-		cl = (cluster*)malloc(sizeof(cluster));
+		cl = (cluster*)hdbscan_malloc(sizeof(cluster));
 	}
 	if(cl == NULL){
 		logger_write(ERROR, "cluster_init - Could not allocate memory for cluster.");	
@@ -105,7 +105,7 @@ void cluster_destroy(cluster* cl){
 			array_list_delete(cl->propagatedDescendants);
 			cl->propagatedDescendants = NULL;
 		}
-		free(cl);
+		hdbscan_free(cl);
 	}
 } 
 
@@ -161,18 +161,18 @@ void cluster_propagate(cluster* cl){
 		if (cl->hasChildren == FALSE || cl->numConstraintsSatisfied > cl->propagatedNumConstraintsSatisfied) {
 			cl->parent->propagatedNumConstraintsSatisfied = (index_t) (cl->parent->propagatedNumConstraintsSatisfied + cl->numConstraintsSatisfied);
 			cl->parent->propagatedStability += cl->stability;
-			array_list_append(cl->parent->propagatedDescendants, &cl);
+			ptr_list_append(cl->parent->propagatedDescendants, cl);
 		}
 		else if (cl->numConstraintsSatisfied < cl->propagatedNumConstraintsSatisfied) {
 
 			cl->parent->propagatedNumConstraintsSatisfied = (index_t) (cl->parent->propagatedNumConstraintsSatisfied + cl->propagatedNumConstraintsSatisfied);
 			cl->parent->propagatedStability += cl->propagatedStability;
 
+			ArrayList* descendants = cl->parent->propagatedDescendants;
+			ptr_list_reserve(descendants, descendants->size + cl->propagatedDescendants->size);
 			for(index_t i = 0; i < cl->propagatedDescendants->size; i++)
 			{
-				cluster* c = NULL;
-				array_list_value_at(cl->propagatedDescendants, i, &c);
-				array_list_append(cl->parent->propagatedDescendants, &c);
+				ptr_list_append(descendants, ptr_list_at(cl->propagatedDescendants, i));
 			}
 		}
 		else if (cl->numConstraintsSatisfied == cl->propagatedNumConstraintsSatisfied) {
@@ -180,18 +180,18 @@ void cluster_propagate(cluster* cl){
 			if (cl->stability >= cl->propagatedStability) {
 				cl->parent->propagatedNumConstraintsSatisfied = (index_t)(cl->parent->propagatedNumConstraintsSatisfied + cl->numConstraintsSatisfied);
 				cl->parent->propagatedStability += cl->stability;
-				array_list_append(cl->parent->propagatedDescendants, &cl);
+				ptr_list_append(cl->parent->propagatedDescendants, cl);
 			}
 
 			else {
 				cl->parent->propagatedNumConstraintsSatisfied = (index_t)(cl->parent->propagatedNumConstraintsSatisfied + cl->propagatedNumConstraintsSatisfied);
 				cl->parent->propagatedStability += cl->propagatedStability;
 
+				ArrayList* descendants = cl->parent->propagatedDescendants;
+				ptr_list_reserve(descendants, descendants->size + cl->propagatedDescendants->size);
 				for(index_t i = 0; i < cl->propagatedDescendants->size; i++)
 				{
-					cluster *c = NULL;
-					array_list_value_at(cl->propagatedDescendants, i, &c);
-					array_list_append(cl->parent->propagatedDescendants, &c);
+					ptr_list_append(descendants, ptr_list_at(cl->propagatedDescendants, i));
 				}
 			}
 		}
@@ -257,4 +257,285 @@ int32_t cluster_compare(const void* a, const void* b)
 	}
 	
 	return -1;
-}
\ No newline at end of file
+}
+cluster_pool* cluster_pool_init(cluster_pool* pool){
+	if(pool == NULL){
+		pool = (cluster_pool*)hdbscan_malloc(sizeof(cluster_pool));
+	}
+
+	if(pool == NULL){
+		logger_write(ERROR, "cluster_pool_init - Could not allocate memory for cluster pool.");
+	} else {
+		pool->size = 0;
+		pool->capacity = 0;
+		pool->numVertices = 0;
+		pool->birthLevel = NULL;
+		pool->deathLevel = NULL;
+		pool->numPoints = NULL;
+		pool->offset = NULL;
+		pool->stability = NULL;
+		pool->propagatedStability = NULL;
+		pool->propagatedLowestChildDeathLevel = NULL;
+		pool->numConstraintsSatisfied = NULL;
+		pool->propagatedNumConstraintsSatisfied = NULL;
+		pool->parent = NULL;
+		pool->hasChildren = NULL;
+		pool->selected = NULL;
+		pool->solution = NULL;
+		pool->chosen = NULL;
+		pool->ancestor = NULL;
+		pool->virtualChildOf = NULL;
+		pool->noiseLevel = NULL;
+	}
+
+	return pool;
+}
+
+/**
+ * @brief Resize one of the pool arrays. The old array is kept if realloc fails.
+ * 
+ * @param array 
+ * @param elementSize 
+ * @param count 
+ * @return int 
+ */
+static int cluster_pool_resize(void** array, size_t elementSize, size_t count){
+	void* tmp = hdbscan_realloc(*array, elementSize * count);
+	if(tmp == NULL){
+		return CLUSTER_ERROR;
+	}
+
+	*array = tmp;
+	return CLUSTER_SUCCESS;
+}
+
+int cluster_pool_reserve(cluster_pool* pool, label_t capacity, index_t numVertices){
+
+	if(capacity > pool->capacity){
+		size_t c = capacity;
+		int ok = cluster_pool_resize((void**)&pool->birthLevel, sizeof(distance_t), c) &&
+				cluster_pool_resize((void**)&pool->deathLevel, sizeof(distance_t), c) &&
+				cluster_pool_resize((void**)&pool->numPoints, sizeof(index_t), c) &&
+				cluster_pool_resize((void**)&pool->offset, sizeof(int64_t), c) &&
+				cluster_pool_resize((void**)&pool->stability, sizeof(distance_t), c) &&
+				cluster_pool_resize((void**)&pool->propagatedStability, sizeof(distance_t), c) &&
+				cluster_pool_resize((void**)&pool->propagatedLowestChildDeathLevel, sizeof(distance_t), c) &&
+				cluster_pool_resize((void**)&pool->numConstraintsSatisfied, sizeof(index_t), c) &&
+				cluster_pool_resize((void**)&pool->propagatedNumConstraintsSatisfied, sizeof(index_t), c) &&
+				cluster_pool_resize((void**)&pool->parent, sizeof(label_t), c) &&
+				cluster_pool_resize((void**)&pool->hasChildren, sizeof(boolean), c) &&
+				cluster_pool_resize((void**)&pool->selected, sizeof(boolean), c) &&
+				cluster_pool_resize((void**)&pool->solution, sizeof(label_t), c) &&
+				cluster_pool_resize((void**)&pool->chosen, sizeof(boolean), c) &&
+				cluster_pool_resize((void**)&pool->ancestor, sizeof(label_t), c);
+
+		if(!ok){
+			logger_write(ERROR, "cluster_pool_reserve - Could not allocate memory for the clusters.");
+			return CLUSTER_ERROR;
+		}
+		pool->capacity = capacity;
+	}
+
+	if(numVertices > pool->numVertices){
+		if(!cluster_pool_resize((void**)&pool->virtualChildOf, sizeof(label_t), numVertices) ||
+				!cluster_pool_resize((void**)&pool->noiseLevel, sizeof(distance_t), numVertices)){
+			logger_write(ERROR, "cluster_pool_reserve - Could not allocate memory for the virtual child clusters.");
+			return CLUSTER_ERROR;
+		}
+		pool->numVertices = numVertices;
+	}
+
+	return CLUSTER_SUCCESS;
+}
+
+void cluster_pool_clear(cluster_pool* pool){
+	pool->size = 0;
+}
+
+void cluster_pool_clean(cluster_pool* pool){
+	hdbscan_free(pool->birthLevel);
+	hdbscan_free(pool->deathLevel);
+	hdbscan_free(pool->numPoints);
+	hdbscan_free(pool->offset);
+	hdbscan_free(pool->stability);
+	hdbscan_free(pool->propagatedStability);
+	hdbscan_free(pool->propagatedLowestChildDeathLevel);
+	hdbscan_free(pool->numConstraintsSatisfied);
+	hdbscan_free(pool->propagatedNumConstraintsSatisfied);
+	hdbscan_free(pool->parent);
+	hdbscan_free(pool->hasChildren);
+	hdbscan_free(pool->selected);
+	hdbscan_free(pool->solution);
+	hdbscan_free(pool->chosen);
+	hdbscan_free(pool->ancestor);
+	hdbscan_free(pool->virtualChildOf);
+	hdbscan_free(pool->noiseLevel);
+	cluster_pool_init(pool);
+}
+
+label_t cluster_pool_add(cluster_pool* pool, label_t parent, distance_t birthLevel, index_t numPoints){
+
+	if(pool->size == pool->capacity){
+		label_t capacity = pool->capacity < 8 ? 8 : (label_t)(pool->capacity * 2);
+		if(cluster_pool_reserve(pool, capacity, 0) == CLUSTER_ERROR){
+			return CLUSTER_INVALID_LABEL;
+		}
+	}
+
+	label_t label = pool->size;
+	pool->size++;
+
+	pool->birthLevel[label] = birthLevel;
+	pool->deathLevel[label] = 0;
+	pool->numPoints[label] = numPoints;
+	pool->offset[label] = 0;
+	pool->stability[label] = 0;
+	pool->propagatedStability[label] = 0;
+	pool->propagatedLowestChildDeathLevel[label] = D_MAX;
+	pool->numConstraintsSatisfied[label] = 0;
+	pool->propagatedNumConstraintsSatisfied[label] = 0;
+	pool->parent[label] = parent;
+	pool->hasChildren[label] = FALSE;
+	pool->selected[label] = FALSE;
+	pool->solution[label] = 0;
+
+	if(parent != 0){
+		pool->hasChildren[parent] = TRUE;
+	}
+
+	return label;
+}
+
+int cluster_pool_detach_points(cluster_pool* pool, label_t label, index_t numPoints, distance_t level){
+
+	if (numPoints > pool->numPoints[label]){
+
+		char s[100];
+		sprintf(s, "cluster_pool_detach_points - Cluster %d has only %d points.\n", label, pool->numPoints[label]);
+		logger_write(FATAL, s);
+		return CLUSTER_ERROR;
+	}
+
+	pool->numPoints[label] = (index_t)(pool->numPoints[label] - numPoints);
+	pool->stability[label] += (numPoints * (1 / level - 1 / pool->birthLevel[label]));
+
+	if (pool->numPoints[label] == 0)
+		pool->deathLevel[label] = level;
+
+	return CLUSTER_SUCCESS;
+}
+
+void cluster_pool_propagate(cluster_pool* pool, label_t label){
+
+	label_t parent = pool->parent[label];
+	if (parent != 0) {
+		//Propagate lowest death level of any descendants:
+		if (pool->propagatedLowestChildDeathLevel[label] == D_MAX){
+			pool->propagatedLowestChildDeathLevel[label] = pool->deathLevel[label];
+		}
+
+		if (pool->propagatedLowestChildDeathLevel[label] < pool->propagatedLowestChildDeathLevel[parent]){
+			pool->propagatedLowestChildDeathLevel[parent] = pool->propagatedLowestChildDeathLevel[label];
+		}
+
+		boolean propagateSelf;
+		if (pool->hasChildren[label] == FALSE || pool->numConstraintsSatisfied[label] > pool->propagatedNumConstraintsSatisfied[label]) {
+			propagateSelf = TRUE;
+		} else if (pool->numConstraintsSatisfied[label] < pool->propagatedNumConstraintsSatisfied[label]) {
+			propagateSelf = FALSE;
+		} else {
+			//Chose the parent over descendants if there is a tie in stability:
+			propagateSelf = pool->stability[label] >= pool->propagatedStability[label];
+		}
+
+		pool->selected[label] = propagateSelf;
+		if(propagateSelf){
+			pool->propagatedNumConstraintsSatisfied[parent] = (index_t)(pool->propagatedNumConstraintsSatisfied[parent] + pool->numConstraintsSatisfied[label]);
+			pool->propagatedStability[parent] += pool->stability[label];
+		} else {
+			pool->propagatedNumConstraintsSatisfied[parent] = (index_t)(pool->propagatedNumConstraintsSatisfied[parent] + pool->propagatedNumConstraintsSatisfied[label]);
+			pool->propagatedStability[parent] += pool->propagatedStability[label];
+		}
+	}
+}
+
+label_t cluster_pool_collect_solution(cluster_pool* pool, boolean leaves, distance_t epsilon){
+	label_t count = 0;
+
+	if(pool->size == 0){
+		return 0;
+	}
+	pool->solution[0] = 0;
+
+	//Parents have smaller labels than their children, so walking the labels upwards
+	//is a top-down traversal and the parent's entry is always final when it is read.
+	for(label_t label = 1; label < pool->size; label++){
+		label_t parent = pool->parent[label];
+		boolean candidate = leaves ? !pool->hasChildren[label] : pool->selected[label];
+
+		if(parent == 0){
+			pool->solution[label] = 0;
+		} else if(pool->solution[parent] != 0){
+			pool->solution[label] = pool->solution[parent];
+		} else if(candidate){
+			pool->solution[label] = label;
+			count++;
+		} else{
+			pool->solution[label] = 0;
+		}
+	}
+
+	if(epsilon <= 0){
+		return count;
+	}
+
+	//Find the deepest ancestor born above epsilon for every cluster and mark the
+	//cluster each candidate is replaced with.
+	for(label_t label = 1; label < pool->size; label++){
+		label_t parent = pool->parent[label];
+		pool->chosen[label] = FALSE;
+
+		if(parent == 0){
+			pool->ancestor[label] = 0;
+		} else if(pool->parent[parent] == 0 || pool->birthLevel[label] > epsilon){
+			pool->ancestor[label] = label;
+		} else{
+			pool->ancestor[label] = pool->ancestor[parent];
+		}
+
+		if(pool->solution[label] == label){
+			label_t target = pool->birthLevel[label] < epsilon ? pool->ancestor[label] : label;
+			pool->chosen[target] = TRUE;
+		}
+	}
+
+	//Redo the solution from the chosen clusters, the topmost one wins on every path
+	count = 0;
+	for(label_t label = 1; label < pool->size; label++){
+		label_t parent = pool->parent[label];
+
+		if(parent == 0){
+			pool->solution[label] = 0;
+		} else if(pool->solution[parent] != 0){
+			pool->solution[label] = pool->solution[parent];
+		} else if(pool->chosen[label]){
+			pool->solution[label] = label;
+			count++;
+		} else{
+			pool->solution[label] = 0;
+		}
+	}
+
+	return count;
+}
+
+void cluster_pool_add_points_to_virtual_child(cluster_pool* pool, label_t label, set_t* points){
+	index_t* data = (index_t*)points->data;
+	for(index_t i = 0; i < points->size; i++){
+		pool->virtualChildOf[data[i]] = label;
+	}
+}
+
+boolean cluster_pool_virtual_child_contains_point(cluster_pool* pool, label_t label, index_t point){
+	return pool->virtualChildOf[point] == label;
+}
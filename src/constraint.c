@@ -36,6 +36,7 @@
  * 
  */
 #include "hdbscan/constraint.h"
+#include "hdbscan/allocator.h"
 #include <stdio.h>
 #ifdef DEBUG
 #include "hdbscan/logger.h"
@@ -43,7 +44,7 @@
 
 constraint* constraint_create(constraint* c, int pointA, int pointB, CONSTRAINT_TYPE type){
 	if(c == NULL)
-		c = (constraint*)malloc(sizeof(constraint));
+		c = (constraint*)hdbscan_malloc(sizeof(constraint));
 
 	if(c == NULL){
 	#ifdef DEBUG
@@ -62,6 +63,6 @@ constraint* constraint_create(constraint* c, int pointA, int pointB, CONSTRAINT_
 
 void constraint_destroy(constraint* c){
 	if(c != NULL)
-		free(c);
+		hdbscan_free(c);
 }
 
@@ -58,7 +58,7 @@
  */
 distance* distance_init(distance* dis, calculator cal, enum HTYPES datatype) {
 	if(dis == NULL)
-		dis = (distance*)malloc(sizeof(distance));
+		dis = (distance*)hdbscan_malloc(sizeof(distance));
 
 	if(dis == NULL){
 		logger_write(FATAL, "distance_init - Failed to allocate memory for distance");
@@ -68,6 +68,7 @@ distance* distance_init(distance* dis, calculator cal, enum HTYPES datatype) {
 		dis->coreDistances = NULL;
 		dis->distances = NULL;
 		dis->datatype = datatype;
+		dis->runProgress = NULL;
 
 	}
 	return dis;
@@ -81,7 +82,7 @@ distance* distance_init(distance* dis, calculator cal, enum HTYPES datatype) {
 void distance_destroy(distance* d) {
 	distance_clean(d);
 	if(d != NULL)
-		free(d);
+		hdbscan_free(d);
 }
 
 /**
@@ -91,12 +92,12 @@ void distance_destroy(distance* d) {
  */
 void distance_clean(distance* d){
 	if(d->distances != NULL){
-		free(d->distances);
+		hdbscan_free(d->distances);
 		d->distances = NULL;
 	}
 
 	if(d->coreDistances != NULL){
-		free(d->coreDistances);
+		hdbscan_free(d->coreDistances);
 		d->coreDistances = NULL;
 	}
 }
@@ -124,6 +125,43 @@ distance_t distance_get(distance* dis, index_t row, index_t col) {
 	return dis->distances[idx];
 }
 
+/**
+ * @brief Get the euclidean distance between row i of dataA and row j of dataB.
+ * Both datasets must have dis->cols columns of type dis->datatype.
+ * 
+ * @param dis 
+ * @param dataA 
+ * @param i 
+ * @param dataB 
+ * @param j 
+ * @return distance_t 
+ */
+distance_t distance_between(distance* dis, void* dataA, index_t i, void* dataB, index_t j){
+	distance_t sum = 0, diff;
+	size_t a = (size_t)i * dis->cols;
+	size_t b = (size_t)j * dis->cols;
+
+	for (size_t k = 0; k < dis->cols; k++) {
+		if(dis->datatype == H_DOUBLE) {
+			diff = (distance_t)(((double*)dataA)[a + k] - ((double*)dataB)[b + k]);
+		} else if(dis->datatype == H_FLOAT) {
+			diff = (distance_t)(((float*)dataA)[a + k] - ((float*)dataB)[b + k]);
+		} else if(dis->datatype == H_INT) {
+			diff = (distance_t)(((int*)dataA)[a + k] - ((int*)dataB)[b + k]);
+		} else if(dis->datatype == H_LONG) {
+			diff = (distance_t)(((long*)dataA)[a + k] - ((long*)dataB)[b + k]);
+		} else if(dis->datatype == H_SHORT) {
+			diff = (distance_t)(((short*)dataA)[a + k] - ((short*)dataB)[b + k]);
+		} else {
+			diff = (distance_t)(((char*)dataA)[a + k] - ((char*)dataB)[b + k]);
+		}
+
+		sum += (diff * diff);
+	}
+
+	return (distance_t)sqrt(sum);
+}
+
 /**
  * @brief Compute the euclidean distance. We also calculate the size 
  * of the distance matrix using (rows * rows -rows)/2
@@ -140,14 +178,20 @@ void distance_compute(distance* dis, void* dataset, index_t rows, index_t cols,
 	dis->rows = rows;
     dis->cols = cols;
     size_t sub = (size_t)(rows * rows -rows)/2;
-    dis->distances = (distance_t *)malloc(sub * sizeof(distance_t));
-    dis->coreDistances = (distance_t *)malloc(dis->rows * sizeof(distance_t));
+    dis->distances = (distance_t *)hdbscan_malloc(sub * sizeof(distance_t));
+    dis->coreDistances = (distance_t *)hdbscan_malloc(dis->rows * sizeof(distance_t));
 	distance_t sum, diff;
+	size_t done = 0;
 
 #ifdef _OPENMP
 #pragma omp parallel for private(sum, diff)   /// Use omp to speed up calculations
 #endif
 	for (size_t i = 0; i < dis->rows; i++) {
+		/// Skip the remaining rows once the run is cancelled
+		if(progress_cancelled(dis->runProgress)){
+			continue;
+		}
+
 		for (size_t j = i + 1; j < dis->rows; j++) {
 			diff = 0.0;
 			sum = 0;
@@ -195,7 +239,22 @@ void distance_compute(distance* dis, void* dataset, index_t rows, index_t cols,
 			size_t c = offset - TRIANGULAR_H((uint)i + 1);		
 			dis->distances[c] = sum;			
 		}
+
+		if(dis->runProgress != NULL){
+			size_t d = __atomic_add_fetch(&done, dis->rows - i - 1, __ATOMIC_RELAXED);
+
+			/// Only the thread that started the run calls back
+		#ifdef _OPENMP
+			if(omp_get_thread_num() == 0)
+		#endif
+				progress_report(dis->runProgress, PHASE_DISTANCES, (double)d / (double)sub);
+		}
+	}
+
+	if(progress_report(dis->runProgress, PHASE_DISTANCES, 1.0)){
+		return;
 	}
+
 	distance_get_core_distances(dis);
 }
 
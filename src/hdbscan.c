@@ -47,6 +47,17 @@
 #include <omp.h>
 #endif
 
+/**
+ * @brief Number of rows of a cluster handled by one task in hdbscan_cluster_members_min_max
+ */
+#define HDBSCAN_STATS_BLOCK 64
+
+/**
+ * @brief Number of clusters above which hdbscan_calculate_stats_helper accumulates
+ * the moments on all the threads
+ */
+#define HDBSCAN_STATS_PARALLEL_MIN 64
+
 /**
  * @brief Calculation of the size of the dataset based on whether it is
  * rowwise or not. If it rowwise, then each row is one value as a vector,
@@ -71,12 +82,13 @@ index_t hdbscan_get_dataset_size(index_t rows, index_t cols, boolean rowwise){
  * 
  * @param points The set of points to be in the new Cluster
  * @param clusterLabels An array of cluster labels, which will be modified
- * @param parentCluster The parent Cluster of the new Cluster being created
+ * @param parentCluster The label of the parent Cluster of the new Cluster being created
  * @param clusterLabel The label of the new Cluster
  * @param edgeWeight The edge weight at which to remove the points from their previous Cluster
- * @return cluster*
+ * @return label_t The label of the new cluster, 0 for noise or CLUSTER_INVALID_LABEL if
+ * the cluster could not be added to the pool
  */
-cluster* hdbscan_create_new_cluster(hdbscan* sc, set_t* points, label_t* clusterLabels, cluster* parentCluster, label_t clusterLabel, distance_t edgeWeight){
+label_t hdbscan_create_new_cluster(hdbscan* sc, set_t* points, label_t* clusterLabels, label_t parentCluster, label_t clusterLabel, distance_t edgeWeight){
 	
 	index_t d ;
 	#ifdef _OPENMP
@@ -88,13 +100,12 @@ cluster* hdbscan_create_new_cluster(hdbscan* sc, set_t* points, label_t* cluster
 		clusterLabels[d] = clusterLabel;
 	}
 
-	cluster_detach_points(parentCluster, (index_t)points->size, edgeWeight);
+	cluster_pool_detach_points(&sc->clusters, parentCluster, (index_t)points->size, edgeWeight);
 	if (clusterLabel != 0) {
-		cluster* new = cluster_init(NULL, clusterLabel, parentCluster, edgeWeight, (index_t)points->size);
-		return new;
+		return cluster_pool_add(&sc->clusters, parentCluster, edgeWeight, (index_t)points->size);
 	} else{
-		cluster_add_points_to_virtual_child_cluster(parentCluster, points);
-		return NULL;
+		cluster_pool_add_points_to_virtual_child(&sc->clusters, parentCluster, points);
+		return 0;
 	}
 
 }
@@ -111,44 +122,77 @@ hdbscan* hdbscan_init(hdbscan* sc, index_t minPoints){
 	assert(minPoints > 1);
 
 	if(sc == NULL)
-		sc = (hdbscan*) malloc(sizeof(hdbscan));
+		sc = (hdbscan*) hdbscan_malloc(sizeof(hdbscan));
 
 	if(sc == NULL){
 		logger_write(FATAL, "hdbscan_init - Could not allocate memory for HDBSCAN.\n");
 		
 	} else{
 		sc->minPoints = minPoints;
+		sc->minClusterSize = minPoints;
+		sc->selectionMethod = SELECTION_EOM;
+		sc->clusterSelectionEpsilon = 0;
 		sc->selfEdges = TRUE;
 		sc->hierarchy = NULL;
 		sc->clusterStabilities = NULL;
 
 		sc->constraints = NULL;
 		sc->clusterLabels = NULL;
-		sc->clusters = NULL;
+		cluster_pool_init(&sc->clusters);
 		sc->coreDistances = NULL;
 		sc->outlierScores = NULL;
+		sc->mst = NULL;
+		distance_init(&sc->distanceFunction, _EUCLIDEAN, H_DOUBLE);
+		sc->keepDataSet = FALSE;
+		sc->dataSet = NULL;
+		workspace_init(&sc->scratch);
+		profile_init(&sc->profile);
+		progress_init(&sc->runProgress);
 	}
 
 	return sc;
 }
 
 /**
- * @brief 
+ * @brief Free everything that is derived from the MST (the hierarchy, the cluster
+ * tree, the labels and the outlier scores) but keep the MST itself.
  * 
  * @param sc 
  */
-void hdbscan_minimal_clean(hdbscan* sc){
+static void hdbscan_clean_selection(hdbscan* sc){
 
 	if(sc->clusterLabels != NULL){
-		free(sc->clusterLabels);
+		hdbscan_free(sc->clusterLabels);
 		sc->clusterLabels = NULL;
 	}
 
 	if(sc->outlierScores != NULL){
-		free(sc->outlierScores);
+		hdbscan_free(sc->outlierScores);
 		sc->outlierScores = NULL;
 	}
 
+	if(sc->hierarchy != NULL){
+		hashtable_destroy(sc->hierarchy, NULL, (void (*)(void *))hdbscan_destroy_hierarchical_entry);
+		sc->hierarchy = NULL;
+	}
+
+	cluster_pool_clear(&sc->clusters);
+
+	if(sc->clusterStabilities != NULL){
+
+		hashtable_clear(sc->clusterStabilities, NULL, NULL);
+	}
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ */
+void hdbscan_minimal_clean(hdbscan* sc){
+
+	hdbscan_clean_selection(sc);
+
 	if(sc->mst != NULL){
 		graph_destroy(sc->mst);
 		sc->mst = NULL;
@@ -166,28 +210,6 @@ void hdbscan_minimal_clean(hdbscan* sc){
 		array_list_delete(sc->constraints);
 		sc->constraints = NULL;
 	}
-
-	if(sc->hierarchy != NULL){
-		hashtable_destroy(sc->hierarchy, NULL, (void (*)(void *))hdbscan_destroy_hierarchical_entry);
-		sc->hierarchy = NULL;
-	}
-
-	if(sc->clusters != NULL){
-
-		for(size_t i = 0; i < sc->clusters->size; i++)
-		{
-			cluster* cl;
-			array_list_value_at(sc->clusters, i, &cl);
-			cluster_destroy(cl);
-		}
-
-		array_list_clear(sc->clusters, 0);
-	}
-
-	if(sc->clusterStabilities != NULL){
-
-		hashtable_clear(sc->clusterStabilities, NULL, NULL);
-	}
 }
 
 /**
@@ -200,17 +222,20 @@ void hdbscan_clean(hdbscan* sc){
 	distance_clean(&sc->distanceFunction);
 	hdbscan_minimal_clean(sc);
 
-	if(sc->clusters != NULL)
-	{
-		array_list_delete(sc->clusters);
-		sc->clusters = NULL;
-	}
+	cluster_pool_clean(&sc->clusters);
 
 	if(sc->clusterStabilities != NULL){
 
 		hashtable_destroy(sc->clusterStabilities, NULL, NULL);
 		sc->clusterStabilities = NULL;
 	}
+
+	workspace_clean(&sc->scratch);
+
+	if(sc->dataSet != NULL){
+		hdbscan_free(sc->dataSet);
+		sc->dataSet = NULL;
+	}
 }
 
 /**
@@ -222,18 +247,85 @@ void hdbscan_destroy(hdbscan* sc){
 	hdbscan_clean(sc);
 
 	if(sc != NULL){
-		free(sc);
+		hdbscan_free(sc);
 	}
 
 }
 
 /**
- * @brief 
+ * @brief Free everything a cancelled run has computed, so that sc is left as
+ * if it had not been run.
+ * 
+ * @param sc 
+ * @return int HDBSCAN_ERROR
+ */
+static int hdbscan_cancelled(hdbscan* sc){
+#ifdef DEBUG
+	logger_write(INFO, "hdbscan - The run was cancelled.\n");
+#endif
+
+	hdbscan_minimal_clean(sc);
+	distance_clean(&sc->distanceFunction);
+	workspace_reset(&sc->scratch);
+
+	if(sc->dataSet != NULL){
+		hdbscan_free(sc->dataSet);
+		sc->dataSet = NULL;
+	}
+
+	return HDBSCAN_ERROR;
+}
+
+/**
+ * @brief Number of bytes of scratch memory needed by one run on numPoints points.
+ * 
+ * The last clusters live for the whole run while the MST and the hierarchy
+ * release their buffers when they are done, so only the larger of those two
+ * is counted. The noise levels are kept in the cluster pool.
+ * 
+ * @param numPoints 
+ * @return size_t 
+ */
+static size_t hdbscan_workspace_size(index_t numPoints){
+	size_t run = workspace_aligned_size(numPoints * sizeof(label_t));
+	size_t hierarchy = 2 * workspace_aligned_size(numPoints * sizeof(label_t));
+	size_t mst = workspace_aligned_size(numPoints * sizeof(boolean));
+
+	return run + (hierarchy > mst ? hierarchy : mst);
+}
+
+/**
+ * @brief Reserve the cluster pool and the stability table for sc->numPoints points.
  * 
  * @param sc 
  * @return int 
  */
-int hdbscan_do_run(hdbscan* sc){
+static int hdbscan_reserve_clusters(hdbscan* sc){
+	index_t csize = sc->numPoints/5;
+	if(csize < 4)
+	{
+		csize = (index_t)(csize * 4);
+	}
+
+	if(cluster_pool_reserve(&sc->clusters, csize, sc->numPoints) == CLUSTER_ERROR){
+		return HDBSCAN_ERROR;
+	}
+
+	if(sc->clusterStabilities == NULL){
+		sc->clusterStabilities = hashtable_init(csize, H_INT, H_PTR, int_compare);
+	}
+
+	return HDBSCAN_SUCCESS;
+}
+
+/**
+ * @brief Build the hierarchy and the cluster tree from the sorted MST, then select
+ * the flat clustering and compute the outlier scores.
+ * 
+ * @param sc 
+ * @return int 
+ */
+static int hdbscan_do_select(hdbscan* sc){
 	index_t csize = sc->numPoints/5;
 	if(csize < 4)
 	{
@@ -241,32 +333,87 @@ int hdbscan_do_run(hdbscan* sc){
 	}
 	
 	sc->hierarchy = hashtable_init(csize, H_LONG, H_PTR, long_compare);
-	int err = hdbscan_construct_mst(sc);
-	
-	if(err == HDBSCAN_ERROR){
+
+	workspace_reset(&sc->scratch);
+	if(workspace_reserve(&sc->scratch, hdbscan_workspace_size(sc->numPoints)) == WORKSPACE_ERROR){
 	#ifdef DEBUG
-		logger_write(FATAL, "hdbscan_do_run - Could not construct the minimum spanning tree.\n");
+		logger_write(FATAL, "hdbscan_do_select - Could not allocate the workspace.\n");
 	#else
-		printf("FATAL: hdbscan_do_run - Could not construct the minimum spanning tree.\n");
+		printf("FATAL: hdbscan_do_select - Could not allocate the workspace.\n");
 	#endif
-	
+
 		return HDBSCAN_ERROR;
 	}
 
-	graph_quicksort_by_edge_weight(sc->mst);
-	
-	distance_t pointNoiseLevels[sc->numPoints];
-	label_t pointLastClusters[sc->numPoints];
+	distance_t* pointNoiseLevels = sc->clusters.noiseLevel;
+	label_t* pointLastClusters = workspace_alloc(&sc->scratch, sc->numPoints * sizeof(label_t));
+
+	PROFILE_BEGIN(&sc->profile, hierarchy);
+	int err = hdbscan_compute_hierarchy_and_cluster_tree(sc, 0, pointNoiseLevels, pointLastClusters);
+	PROFILE_END(&sc->profile, PHASE_HIERARCHY, hierarchy);
 
-	hdbscan_compute_hierarchy_and_cluster_tree(sc, 0, pointNoiseLevels, pointLastClusters);
+	if(err == HDBSCAN_ERROR){
+		workspace_reset(&sc->scratch);
+		return HDBSCAN_ERROR;
+	}
+
+	PROFILE_BEGIN(&sc->profile, propagation);
 	int infiniteStability = hdbscan_propagate_tree(sc);
 	hdbscan_find_prominent_clusters(sc, infiniteStability);
+	PROFILE_END(&sc->profile, PHASE_PROPAGATION, propagation);
 
+	PROFILE_BEGIN(&sc->profile, outliers);
 	hdbscsan_calculate_outlier_scores(sc, pointNoiseLevels, pointLastClusters, infiniteStability);
+	PROFILE_END(&sc->profile, PHASE_OUTLIER_SCORES, outliers);
+	workspace_reset(&sc->scratch);
 
 	return HDBSCAN_SUCCESS;
 }
 
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @return int 
+ */
+int hdbscan_do_run(hdbscan* sc){
+
+	workspace_reset(&sc->scratch);
+	if(workspace_reserve(&sc->scratch, hdbscan_workspace_size(sc->numPoints)) == WORKSPACE_ERROR){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_do_run - Could not allocate the workspace.\n");
+	#else
+		printf("FATAL: hdbscan_do_run - Could not allocate the workspace.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
+	PROFILE_BEGIN(&sc->profile, mst);
+	int err = hdbscan_construct_mst(sc);
+	PROFILE_END(&sc->profile, PHASE_MST, mst);
+
+	if(progress_cancelled(&sc->runProgress)){
+		return HDBSCAN_ERROR;
+	}
+	
+	if(err == HDBSCAN_ERROR){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_do_run - Could not construct the minimum spanning tree.\n");
+	#else
+		printf("FATAL: hdbscan_do_run - Could not construct the minimum spanning tree.\n");
+	#endif
+	
+		return HDBSCAN_ERROR;
+	}
+
+	PROFILE_BEGIN(&sc->profile, sort);
+	graph_radix_sort_by_edge_weight(sc->mst);
+	PROFILE_END(&sc->profile, PHASE_SORT, sort);
+
+	return hdbscan_do_select(sc);
+}
+
 /**
  * @brief 
  * 
@@ -275,6 +422,8 @@ int hdbscan_do_run(hdbscan* sc){
  * @return int 
  */
 int hdbscan_rerun(hdbscan* sc, index_t minPts){
+	progress_start(&sc->runProgress);
+
 	// clean the hdbscan
 	hdbscan_minimal_clean(sc);
 	
@@ -283,11 +432,66 @@ int hdbscan_rerun(hdbscan* sc, index_t minPts){
 	sc->clusterLabels = NULL;
 	sc->coreDistances = NULL;
 	sc->outlierScores = NULL;
+
+	// Keep a minClusterSize that was set apart from minPoints
+	if(sc->minClusterSize == sc->minPoints){
+		sc->minClusterSize = minPts;
+	}
 	sc->minPoints = minPts;
 	sc->distanceFunction.numNeighbors = (index_t)(minPts - 1);
+
+	PROFILE_BEGIN(&sc->profile, distances);
 	distance_get_core_distances(&(sc->distanceFunction));
+	PROFILE_END(&sc->profile, PHASE_DISTANCES, distances);
+
+	if(hdbscan_do_run(sc) == HDBSCAN_ERROR){
+		return progress_cancelled(&sc->runProgress) ? hdbscan_cancelled(sc) : HDBSCAN_ERROR;
+	}
+
+	return HDBSCAN_SUCCESS;
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param minClusterSize 
+ * @return int 
+ */
+int hdbscan_reselect(hdbscan* sc, index_t minClusterSize){
+
+	if(sc->mst == NULL){
+	#ifdef DEBUG
+		logger_write(ERROR, "hdbscan_reselect - hdbscan_run must be called first.\n");
+	#else
+		printf("ERROR: hdbscan_reselect - hdbscan_run must be called first.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
+	if(minClusterSize < 2){
+	#ifdef DEBUG
+		logger_write(ERROR, "hdbscan_reselect - minClusterSize must be at least 2.\n");
+	#else
+		printf("ERROR: hdbscan_reselect - minClusterSize must be at least 2.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
+	progress_start(&sc->runProgress);
+	hdbscan_clean_selection(sc);
+	sc->minClusterSize = minClusterSize;
+
+	// The hierarchy removes the MST edges as it goes, put them back
+	graph_reset_edges(sc->mst);
+
+	if(hdbscan_do_select(sc) == HDBSCAN_ERROR){
+		return progress_cancelled(&sc->runProgress) ? hdbscan_cancelled(sc) : HDBSCAN_ERROR;
+	}
 
-	return hdbscan_do_run(sc);
+	return HDBSCAN_SUCCESS;
 }
 
 /**
@@ -313,82 +517,422 @@ int hdbscan_run(hdbscan* sc, void* dataset, index_t rows, index_t cols, boolean
 		return HDBSCAN_ERROR;
 	}
 	
+	progress_start(&sc->runProgress);
+
+	// release whatever a previous run on this object left behind
+	distance_clean(&sc->distanceFunction);
+	hdbscan_minimal_clean(sc);
+	
 	distance_init(&sc->distanceFunction, _EUCLIDEAN, datatype);
+	sc->distanceFunction.runProgress = &sc->runProgress;
 
 	sc->numPoints = hdbscan_get_dataset_size(rows, cols, rowwise);
+
+	PROFILE_BEGIN(&sc->profile, distances);
 	distance_compute(&(sc->distanceFunction), dataset, rows, cols, (index_t)(sc->minPoints-1));
+	PROFILE_END(&sc->profile, PHASE_DISTANCES, distances);
 
-	index_t csize = sc->numPoints/5;
-	if(csize < 4)
-	{
-		csize = (index_t)(csize * 4);
+	if(progress_cancelled(&sc->runProgress)){
+		return hdbscan_cancelled(sc);
+	}
+
+	//Keep the training data so that new points can be measured against it
+	if(sc->keepDataSet == TRUE){
+		size_t dsize = (size_t)rows * cols * get_htype_size(datatype);
+		void* data = hdbscan_realloc(sc->dataSet, dsize);
+		if(data == NULL){
+		#ifdef DEBUG
+			logger_write(FATAL, "hdbscan_run - Could not allocate memory for the training data.\n");
+		#else
+			printf("FATAL: hdbscan_run - Could not allocate memory for the training data.\n");
+		#endif
+
+			return HDBSCAN_ERROR;
+		}
+		memcpy(data, dataset, dsize);
+		sc->dataSet = data;
+	} else if(sc->dataSet != NULL){
+		hdbscan_free(sc->dataSet);
+		sc->dataSet = NULL;
+	}
+
+	if(hdbscan_reserve_clusters(sc) == HDBSCAN_ERROR){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_run - Could not allocate the cluster pool.\n");
+	#else
+		printf("FATAL: hdbscan_run - Could not allocate the cluster pool.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
 	}
-	sc->clusters = ptr_array_list_init(csize, cluster_compare);
-	sc->clusterStabilities = hashtable_init(csize, H_INT, H_PTR, int_compare);
 	
-	return hdbscan_do_run(sc);
+	if(hdbscan_do_run(sc) == HDBSCAN_ERROR){
+		return progress_cancelled(&sc->runProgress) ? hdbscan_cancelled(sc) : HDBSCAN_ERROR;
+	}
+
+	return HDBSCAN_SUCCESS;
 }
 
 /**
- * @brief Calculates the number of constraints satisfied by the new clusters and virtual children of the
+ * @brief 
  * 
  * @param sc 
- * @param newClusterLabels 
- * @param currentClusterLabels 
+ * @param enabled 
  */
-void hdbscan_calculate_num_constraints_satisfied(hdbscan* sc, set_t* newClusterLabels, label_t* currentClusterLabels){
+void hdbscan_enable_prediction(hdbscan* sc, boolean enabled){
+	sc->keepDataSet = enabled;
+	if(enabled == FALSE && sc->dataSet != NULL){
+		hdbscan_free(sc->dataSet);
+		sc->dataSet = NULL;
+	}
+}
 
-	if(array_list_size(sc->constraints) == 0)
-	{
-		return;
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param enabled 
+ */
+void hdbscan_enable_profile(hdbscan* sc, boolean enabled){
+	if(enabled){
+		profile_reset(&sc->profile);
 	}
+
+	sc->profile.enabled = enabled;
 }
 
 /**
  * @brief 
  * 
  * @param sc 
- * @param compactHierarchy 
- * @param pointNoiseLevels 
- * @param pointLastClusters 
- * @return int 
+ * @param callback 
+ * @param data 
  */
-int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy, distance_t* pointNoiseLevels, label_t* pointLastClusters){
+void hdbscan_set_progress_callback(hdbscan* sc, progress_callback callback, void* data){
+	progress_set_callback(&sc->runProgress, callback, data);
+}
 
-	int64_t lineCount = 0; // Indicates the number of lines written into hierarchyFile.
+/**
+ * @brief 
+ * 
+ * @param sc 
+ */
+void hdbscan_cancel(hdbscan* sc){
+	progress_cancel(&sc->runProgress);
+}
 
-	//The current edge being removed from the MST:
-	// NOTE: This should always be a signed long
-	int64_t currentEdgeIndex = (int64_t)sc->mst->edgeWeights->size - 1;
+/**
+ * @brief Number of minPts values in a row that have to score below the best one
+ * before hdbscan_select_min_pts stops the sweep
+ */
+#define HDBSCAN_SWEEP_PATIENCE 3
 
-	label_t nextClusterLabel = 2;
-	boolean nextLevelSignificant = TRUE;
-	//The previous and current cluster numbers of each point in the data set:
-	index_t numVertices = sc->mst->numVertices;
-	label_t previousClusterLabels[numVertices];
-	label_t currentClusterLabels[numVertices];
+/**
+ * @brief Fill knn with the k smallest distances of every point in ascending order,
+ * the point itself included, so that row i of knn holds the core distance of i for
+ * every minPts up to k.
+ * 
+ * @param dis 
+ * @param k 
+ * @param knn 
+ */
+static void hdbscan_knn_cache(distance* dis, index_t k, distance_t* knn){
 
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
-	for(index_t i = 0; i < numVertices; i++){
-		previousClusterLabels[i] = 1;
-		currentClusterLabels[i] = 1;
-	}
+	for(index_t i = 0; i < dis->rows; i++){
+		distance_t* row = knn + (size_t)i * k;
 
-	//A list of clusters in the cluster tree, with the 0th cluster (noise) null:
-	cluster* c = NULL;
-	array_list_append(sc->clusters, &c);
+		for(index_t j = 0; j < k; j++){
+			row[j] = D_MAX;
+		}
 
-	c = cluster_init(NULL, 1, NULL, NAN, numVertices);
-	array_list_append(sc->clusters, &c);
+		for(index_t j = 0; j < dis->rows; j++){
+			distance_t t = distance_get(dis, i, j);
 
-	//Sets for the clusters and vertices that are affected by the edge(s) being removed:
-	set_t* affectedClusterLabels = set_init(sizeof(label_t), NULL);
+			if(t >= row[k - 1]){
+				continue;
+			}
 
-	if(sizeof(label_t) == sizeof(int)) {
-		affectedClusterLabels->compare = int_compare;
-	} else if(sizeof(label_t) == sizeof(long)) {
+			index_t pos = (index_t)(k - 1);
+			while(pos > 0 && row[pos - 1] > t){
+				row[pos] = row[pos - 1];
+				pos--;
+			}
+			row[pos] = t;
+		}
+	}
+}
+
+/**
+ * @brief Score the flat clustering of sc with hdbscan_dbcv. A clustering without
+ * clusters gets -1, the lowest possible index.
+ * 
+ * @param sc 
+ * @param score 
+ * @param numClusters 
+ * @return int 
+ */
+static int hdbscan_sweep_score(hdbscan* sc, distance_t* score, int32_t* numClusters){
+
+	*numClusters = (int32_t)hdbscan_selected_clusters(sc, NULL);
+	if(*numClusters == 0){
+		*score = -1;
+		return HDBSCAN_SUCCESS;
+	}
+
+	return hdbscan_dbcv(sc, score, NULL);
+}
+
+/**
+ * @brief Run HDBSCAN with minPts on the distances of shared, taking the core
+ * distances from the kNN cache, and score the result. shared is only read so
+ * several candidates can run at the same time.
+ * 
+ * @param shared 
+ * @param knn 
+ * @param k 
+ * @param minPts 
+ * @param score 
+ * @param numClusters 
+ * @return int 
+ */
+static int hdbscan_sweep_candidate(distance* shared, distance_t* knn, index_t k, index_t minPts, distance_t* score, int32_t* numClusters){
+
+	hdbscan sc;
+	hdbscan_init(&sc, minPts);
+	sc.numPoints = shared->rows;
+	sc.distanceFunction = *shared;
+	sc.distanceFunction.numNeighbors = (index_t)(minPts - 1);
+	sc.distanceFunction.coreDistances = (distance_t *)hdbscan_malloc(sc.numPoints * sizeof(distance_t));
+
+	int err = HDBSCAN_ERROR;
+	if(sc.distanceFunction.coreDistances != NULL && hdbscan_reserve_clusters(&sc) == HDBSCAN_SUCCESS){
+
+		for(index_t i = 0; i < sc.numPoints; i++){
+			sc.distanceFunction.coreDistances[i] = knn[(size_t)i * k + minPts - 1];
+		}
+
+		if(hdbscan_do_run(&sc) == HDBSCAN_SUCCESS){
+			err = hdbscan_sweep_score(&sc, score, numClusters);
+		}
+	}
+
+	// The distances belong to shared
+	sc.distanceFunction.distances = NULL;
+	hdbscan_clean(&sc);
+
+	return err;
+}
+
+/**
+ * @brief 
+ * 
+ * @param min 
+ * @param max 
+ * @param dataset 
+ * @param rows 
+ * @param cols 
+ * @param datatype 
+ * @param selection 
+ * @param val 
+ * @param numClusters 
+ * @return int32_t 
+ */
+int32_t hdbscan_select_min_pts(int32_t min, int32_t max, void* dataset, index_t rows, index_t cols, int32_t datatype, hashtable* selection, int32_t *val, int32_t *numClusters){
+
+	if(min < 2 || max < min || (index_t)max > rows){
+	#ifdef DEBUG
+		logger_write(ERROR, "hdbscan_select_min_pts - min must be at least 2 and max between min and the number of rows.\n");
+	#else
+		printf("ERROR: hdbscan_select_min_pts - min must be at least 2 and max between min and the number of rows.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
+	distance shared;
+	distance_init(&shared, _EUCLIDEAN, datatype);
+	distance_compute(&shared, dataset, rows, cols, (index_t)(max - 1));
+
+	//The core distances of every candidate are read from here instead of
+	//scanning the whole distance matrix again
+	index_t k = (index_t)max;
+	int32_t count = max - min + 1;
+	distance_t* knn = (distance_t *)hdbscan_malloc((size_t)rows * k * sizeof(distance_t));
+	distance_t* scores = (distance_t *)hdbscan_malloc((size_t)count * sizeof(distance_t));
+	int32_t* clusters = (int32_t *)hdbscan_malloc((size_t)count * sizeof(int32_t));
+
+	if(knn == NULL || scores == NULL || clusters == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_select_min_pts - Could not allocate memory for the sweep.\n");
+	#else
+		printf("FATAL: hdbscan_select_min_pts - Could not allocate memory for the sweep.\n");
+	#endif
+
+		hdbscan_free(knn);
+		hdbscan_free(scores);
+		hdbscan_free(clusters);
+		distance_clean(&shared);
+		return HDBSCAN_ERROR;
+	}
+
+	hdbscan_knn_cache(&shared, k, knn);
+
+	int numThreads = 1;
+#ifdef _OPENMP
+	numThreads = omp_get_max_threads();
+#endif
+
+	//The candidates are evaluated in waves of one per thread, the sweep stops
+	//when the last HDBSCAN_SWEEP_PATIENCE candidates did not beat the best one
+	int err = HDBSCAN_SUCCESS;
+	int32_t best = -1;
+	int32_t sinceBest = 0;
+	int32_t done = 0;
+
+	while(done < count && sinceBest < HDBSCAN_SWEEP_PATIENCE && err == HDBSCAN_SUCCESS){
+		int32_t wave = count - done < numThreads ? count - done : numThreads;
+
+	#ifdef _OPENMP
+	#pragma omp parallel for schedule(dynamic) num_threads(wave)
+	#endif
+		for(int32_t w = 0; w < wave; w++){
+			int32_t c = done + w;
+
+			if(hdbscan_sweep_candidate(&shared, knn, k, (index_t)(min + c), scores + c, clusters + c) == HDBSCAN_ERROR){
+			#ifdef _OPENMP
+			#pragma omp atomic write
+			#endif
+				err = HDBSCAN_ERROR;
+			}
+		}
+
+		if(err == HDBSCAN_ERROR){
+			break;
+		}
+
+		for(int32_t c = done; c < done + wave; c++){
+			if(selection != NULL){
+				int32_t minPts = min + c;
+				distance_t s = scores[c];
+				hashtable_insert(selection, &minPts, &s);
+			}
+
+			if(best < 0 || scores[c] > scores[best]){
+				best = c;
+				sinceBest = 0;
+			} else{
+				sinceBest++;
+			}
+		}
+
+		done += wave;
+	}
+
+	if(err == HDBSCAN_SUCCESS){
+		*val = min + best;
+		*numClusters = clusters[best];
+	} else{
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_select_min_pts - Could not evaluate a candidate.\n");
+	#else
+		printf("FATAL: hdbscan_select_min_pts - Could not evaluate a candidate.\n");
+	#endif
+	}
+
+	hdbscan_free(knn);
+	hdbscan_free(scores);
+	hdbscan_free(clusters);
+	distance_clean(&shared);
+
+	return err;
+}
+
+/**
+ * @brief Calculates the number of constraints satisfied by the new clusters and virtual children of the
+ * 
+ * @param sc 
+ * @param newClusterLabels 
+ * @param currentClusterLabels 
+ */
+void hdbscan_calculate_num_constraints_satisfied(hdbscan* sc, set_t* newClusterLabels, label_t* currentClusterLabels){
+
+	if(array_list_size(sc->constraints) == 0)
+	{
+		return;
+	}
+}
+
+/**
+ * @brief Free the sets hdbscan_compute_hierarchy_and_cluster_tree uses to explore
+ * the clusters split by each level
+ */
+static void hdbscan_delete_exploration_sets(set_t* examinedVertices, set_t* firstChildCluster, set_t* unexploredFirstChildClusterPoints, 
+												set_t* constructingSubCluster, ArrayList* unexploredSubClusterPoints){
+	set_delete(constructingSubCluster);
+	array_list_delete(unexploredSubClusterPoints);
+	set_delete(examinedVertices);
+	set_delete(firstChildCluster);
+	set_delete(unexploredFirstChildClusterPoints);
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param compactHierarchy 
+ * @param pointNoiseLevels 
+ * @param pointLastClusters 
+ * @return int 
+ */
+int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy, distance_t* pointNoiseLevels, label_t* pointLastClusters){
+
+	int64_t lineCount = 0; // Indicates the number of lines written into hierarchyFile.
+
+	//The current edge being removed from the MST:
+	// NOTE: This should always be a signed long
+	int64_t currentEdgeIndex = (int64_t)sc->mst->edgeWeights->size - 1;
+
+	label_t nextClusterLabel = 2;
+	boolean nextLevelSignificant = TRUE;
+	//The previous and current cluster numbers of each point in the data set:
+	index_t numVertices = sc->mst->numVertices;
+	size_t scratchMark = workspace_mark(&sc->scratch);
+	label_t* previousClusterLabels = workspace_alloc(&sc->scratch, numVertices * sizeof(label_t));
+	label_t* currentClusterLabels = workspace_alloc(&sc->scratch, numVertices * sizeof(label_t));
+
+	if(previousClusterLabels == NULL || currentClusterLabels == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_compute_hierarchy_and_cluster_tree - Could not allocate the cluster labels\n");
+	#else
+		printf("FATAL: hdbscan_compute_hierarchy_and_cluster_tree - Could not allocate the cluster labels\n");
+	#endif
+		workspace_release(&sc->scratch, scratchMark);
+
+		return HDBSCAN_ERROR;
+	}
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(index_t i = 0; i < numVertices; i++){
+		previousClusterLabels[i] = 1;
+		currentClusterLabels[i] = 1;
+		sc->clusters.virtualChildOf[i] = 0;
+	}
+
+	//The clusters in the cluster tree, with the 0th cluster (noise) as a placeholder:
+	cluster_pool_add(&sc->clusters, 0, NAN, 0);
+	cluster_pool_add(&sc->clusters, 0, NAN, numVertices);
+
+	//Sets for the clusters and vertices that are affected by the edge(s) being removed:
+	set_t* affectedClusterLabels = set_init(sizeof(label_t), NULL);
+
+	if(sizeof(label_t) == sizeof(int)) {
+		affectedClusterLabels->compare = int_compare;
+	} else if(sizeof(label_t) == sizeof(long)) {
 		affectedClusterLabels->compare = long_compare;
 	} else {
 		affectedClusterLabels->compare = short_compare;
@@ -404,11 +948,55 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 		affectedVertices->compare = short_compare;
 	}
 	
-	ArrayList* newClusters = array_list_init(2, sizeof(cluster *), cluster_compare);
+	/** 
+	 * Initialise all the sets to avoid recreating them every loop. Also making sure that we
+	 * do not call realloc a lot
+	 */
+	label_t examinedClusterLabel;
+	set_t* examinedVertices = set_init(sizeof(index_t), NULL);
+	set_t* firstChildCluster = set_init(sizeof(index_t), NULL);
+	set_t* unexploredFirstChildClusterPoints = set_init(sizeof(index_t), NULL);
+	set_t* constructingSubCluster = set_init(sizeof(index_t), NULL);
+	ArrayList* unexploredSubClusterPoints = index_list_init(examinedVertices->max_size);
+
+	if(sizeof(index_t) == sizeof(int)) {
+		examinedVertices->compare = int_compare;
+		firstChildCluster->compare = int_compare;
+		unexploredFirstChildClusterPoints->compare = int_compare;
+		constructingSubCluster->compare = int_compare;
+		unexploredSubClusterPoints->compare = int_compare;
+	} else if(sizeof(index_t) == sizeof(long)) {
+		examinedVertices->compare = long_compare;
+		firstChildCluster->compare = long_compare;
+		unexploredFirstChildClusterPoints->compare = long_compare;
+		constructingSubCluster->compare = long_compare;
+		unexploredSubClusterPoints->compare = long_compare;
+	} else {
+		examinedVertices->compare = short_compare;
+		firstChildCluster->compare = short_compare;
+		unexploredFirstChildClusterPoints->compare = short_compare;
+		constructingSubCluster->compare = short_compare;
+		unexploredSubClusterPoints->compare = short_compare;
+	}
+	
+	ArrayList* newClusters = label_list_init(2);
 	index_t i;
 	distance_t currentEdgeWeight, tmp_w;
+	double numEdges = (double)sc->mst->edgeWeights->size;
+
+	boolean failed = FALSE;
 
 	while (currentEdgeIndex >= 0) {
+
+		if(progress_report(&sc->runProgress, PHASE_HIERARCHY, 1.0 - (double)(currentEdgeIndex + 1) / numEdges)){
+			array_list_delete(newClusters);
+			set_delete(affectedClusterLabels);
+			set_delete(affectedVertices);
+			hdbscan_delete_exploration_sets(examinedVertices, firstChildCluster, unexploredFirstChildClusterPoints, constructingSubCluster, unexploredSubClusterPoints);
+			workspace_release(&sc->scratch, scratchMark);
+
+			return HDBSCAN_ERROR;
+		}
 		
 		currentEdgeWeight = ((distance_t *)sc->mst->edgeWeights->data)[currentEdgeIndex];
 		
@@ -449,39 +1037,8 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 			continue;
 		}
 		
-		/** 
-		 * Initialise all the sets to avoid recreating them every loop. Also making sure that we
-		 * do not call realloc a lot
-		 */
-		label_t examinedClusterLabel;
-		set_t* examinedVertices = set_init(sizeof(index_t), NULL);
-		set_t* firstChildCluster = set_init(sizeof(index_t), NULL);
-		set_t* unexploredFirstChildClusterPoints = set_init(sizeof(index_t), NULL);
-		set_t* constructingSubCluster = set_init(sizeof(index_t), NULL);
-		ArrayList* unexploredSubClusterPoints = array_list_init(examinedVertices->max_size, sizeof(index_t), NULL);
-
-		if(sizeof(index_t) == sizeof(int)) {
-			examinedVertices->compare = int_compare;
-			firstChildCluster->compare = int_compare;
-			unexploredFirstChildClusterPoints->compare = int_compare;
-			constructingSubCluster->compare = int_compare;
-			unexploredSubClusterPoints->compare = int_compare;
-		} else if(sizeof(index_t) == sizeof(long)) {
-			examinedVertices->compare = long_compare;
-			firstChildCluster->compare = long_compare;
-			unexploredFirstChildClusterPoints->compare = long_compare;
-			constructingSubCluster->compare = long_compare;
-			unexploredSubClusterPoints->compare = long_compare;
-		} else {
-			examinedVertices->compare = short_compare;
-			firstChildCluster->compare = short_compare;
-			unexploredFirstChildClusterPoints->compare = short_compare;
-			constructingSubCluster->compare = short_compare;
-			unexploredSubClusterPoints->compare = short_compare;
-		}
-
 		//Check each cluster affected for a possible split:
-		while(affectedClusterLabels->size > 0){
+		while(affectedClusterLabels->size > 0 && failed == FALSE){
 
 			set_remove_at(affectedClusterLabels, affectedClusterLabels->size-1, &examinedClusterLabel);
 
@@ -509,7 +1066,7 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 			 * split, otherwise, only spurious components are fully explored, in order to label
 			 * them noise.
 			 */
-			while (examinedVertices->size > 0) {
+			while (examinedVertices->size > 0 && failed == FALSE) {
 
 				boolean anyEdges = FALSE;
 				boolean incrementedChildCount = FALSE;
@@ -517,30 +1074,31 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 
 				set_remove_at(examinedVertices, examinedVertices->size-1, &rootVertex);
 				set_insert(constructingSubCluster, &rootVertex);
-				array_list_append(unexploredSubClusterPoints, &rootVertex);
+				index_list_append(unexploredSubClusterPoints, rootVertex);
 				
 				//Explore this potential child cluster as long as there are unexplored points:
 				while (unexploredSubClusterPoints->size > 0) {
 					index_t vertexToExplore;
-					array_list_pop(unexploredSubClusterPoints, &vertexToExplore);
+					index_list_pop(unexploredSubClusterPoints, &vertexToExplore);
 
-					ArrayList* v = sc->mst->edges[vertexToExplore];
+					index_t numNeighbours;
+					index_t* v = graph_get_neighbours(sc->mst, vertexToExplore, &numNeighbours);
 					index_t neighbor;
 					
-					for(i = 0; i < v->size; i++){
+					for(i = 0; i < numNeighbours; i++){
 						
-						neighbor = ((index_t*)v->data)[i];
+						neighbor = v[i];
 						anyEdges = TRUE;
 						boolean p = set_insert(constructingSubCluster, &neighbor);
 
 						if(p){
-							array_list_append(unexploredSubClusterPoints, &neighbor);
+							index_list_append(unexploredSubClusterPoints, neighbor);
 							set_remove(examinedVertices, &neighbor);
 						}
 					}
 
 					//Check if this potential child cluster is a valid cluster:
-					if(incrementedChildCount == FALSE && constructingSubCluster->size >= sc->minPoints && anyEdges == TRUE){
+					if(incrementedChildCount == FALSE && constructingSubCluster->size >= sc->minClusterSize && anyEdges == TRUE){
 						incrementedChildCount = TRUE;
 						numChildClusters++;
 
@@ -553,7 +1111,7 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 							}
 
 							for(i = 0; i < unexploredSubClusterPoints->size; i++){
-								d = ((index_t*)unexploredSubClusterPoints->data)[i];
+								d = index_list_at(unexploredSubClusterPoints, i);
 								set_insert(unexploredFirstChildClusterPoints, &d);
 							}
 							break;
@@ -561,9 +1119,8 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 					}
 				}
 				
-				cluster* examinedCluster = NULL;
 				//If there could be a split, and this child cluster is valid:
-				if(numChildClusters >= 2 && constructingSubCluster->size >= sc->minPoints && anyEdges == TRUE){
+				if(numChildClusters >= 2 && constructingSubCluster->size >= sc->minClusterSize && anyEdges == TRUE){
 
 					//Check this child cluster is not equal to the unexplored first child cluster:
 					index_t firstChildClusterMember = ((index_t*)firstChildCluster->data)[firstChildCluster->size-1];
@@ -575,21 +1132,21 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 					//Otherwise, create a new cluster:
 					else {
 						
-						examinedCluster = ((cluster**)sc->clusters->data)[examinedClusterLabel];
-						cluster* newCluster = hdbscan_create_new_cluster(sc, constructingSubCluster, currentClusterLabels, 
-																			examinedCluster, nextClusterLabel, currentEdgeWeight);
-						array_list_append(newClusters, &newCluster);
-						nextClusterLabel++;
-						array_list_append(sc->clusters, &newCluster);
+						label_t newCluster = hdbscan_create_new_cluster(sc, constructingSubCluster, currentClusterLabels, 
+																			examinedClusterLabel, nextClusterLabel, currentEdgeWeight);
+						if(newCluster == CLUSTER_INVALID_LABEL){
+							failed = TRUE;
+						} else {
+							label_list_append(newClusters, newCluster);
+							nextClusterLabel++;
+						}
 					}
 				}
 
 				//If this child cluster is not valid cluster, assign it to noise:
-				else if(constructingSubCluster->size < sc->minPoints || anyEdges == FALSE){
+				else if(constructingSubCluster->size < sc->minClusterSize || anyEdges == FALSE){
 
-					examinedCluster = ((cluster**)sc->clusters->data)[examinedClusterLabel];
-					
-					cluster* newCluster = hdbscan_create_new_cluster(sc, constructingSubCluster, currentClusterLabels, examinedCluster, 0, currentEdgeWeight);
+					hdbscan_create_new_cluster(sc, constructingSubCluster, currentClusterLabels, examinedClusterLabel, 0, currentEdgeWeight);
 					index_t point;
 					#ifdef _OPENMP
 					#pragma omp parallel for private(point)
@@ -601,8 +1158,6 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 						pointLastClusters[point] = examinedClusterLabel;
 					}
 
-					cluster_destroy(newCluster);
-
 				}
 				/*************************************
 				 * Clean up constructing subcluster
@@ -616,44 +1171,54 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 			index_t neighbor;
 			index_t vertexToExplore;	
 
-			if (numChildClusters >= 2 && currentClusterLabels[dd] == examinedClusterLabel) {
+			if (failed == FALSE && numChildClusters >= 2 && currentClusterLabels[dd] == examinedClusterLabel) {
 				while(unexploredFirstChildClusterPoints->size > 0){
 					
 					set_remove_at(unexploredFirstChildClusterPoints, unexploredFirstChildClusterPoints->size-1, &vertexToExplore);
-					ArrayList* v = (sc->mst->edges)[vertexToExplore];
+					index_t numNeighbours;
+					index_t* v = graph_get_neighbours(sc->mst, vertexToExplore, &numNeighbours);
 
-					for (i = 0; i < v->size; i++) {
-						neighbor = ((index_t*)v->data)[i];
+					for (i = 0; i < numNeighbours; i++) {
+						neighbor = v[i];
 						if (set_insert(firstChildCluster, &neighbor)) {
 							set_insert(unexploredFirstChildClusterPoints, &neighbor);
 						}
 					}
 				}
 
-				cluster* examinedCluster = NULL;
-				examinedCluster = ((cluster**)sc->clusters->data)[examinedClusterLabel];
-				
-				cluster* newCluster = hdbscan_create_new_cluster(sc, firstChildCluster, currentClusterLabels, examinedCluster, nextClusterLabel, currentEdgeWeight);
-				array_list_append(newClusters, &newCluster);
-				nextClusterLabel++;
-				array_list_append(sc->clusters, &newCluster);
+				label_t newCluster = hdbscan_create_new_cluster(sc, firstChildCluster, currentClusterLabels, examinedClusterLabel, nextClusterLabel, currentEdgeWeight);
+				if(newCluster == CLUSTER_INVALID_LABEL){
+					failed = TRUE;
+				} else {
+					label_list_append(newClusters, newCluster);
+					nextClusterLabel++;
+				}
 			}
 			
 			firstChildCluster->size = 0;
 			unexploredFirstChildClusterPoints->size = 0;
 			examinedVertices->size = 0;
 		}
-		set_delete(constructingSubCluster);
-		array_list_delete(unexploredSubClusterPoints);
-		set_delete(examinedVertices);
-		set_delete(firstChildCluster);
-		set_delete(unexploredFirstChildClusterPoints);
+		if(failed == TRUE){
+		#ifdef DEBUG
+			logger_write(FATAL, "hdbscan_compute_hierarchy_and_cluster_tree - Could not create a new cluster.\n");
+		#else
+			printf("FATAL: hdbscan_compute_hierarchy_and_cluster_tree - Could not create a new cluster.\n");
+		#endif
+			array_list_delete(newClusters);
+			set_delete(affectedClusterLabels);
+			set_delete(affectedVertices);
+			hdbscan_delete_exploration_sets(examinedVertices, firstChildCluster, unexploredFirstChildClusterPoints, constructingSubCluster, unexploredSubClusterPoints);
+			workspace_release(&sc->scratch, scratchMark);
+
+			return HDBSCAN_ERROR;
+		}
 
 		if (compactHierarchy == FALSE || nextLevelSignificant == TRUE || array_list_size(newClusters) > 0) {
 			lineCount++;
 			hierarchy_entry* entry = hdbscan_create_hierarchy_entry();
 			entry->edgeWeight = currentEdgeWeight;
-			entry->labels = (label_t*)malloc(numVertices * sizeof(label_t));
+			entry->labels = (label_t*)hdbscan_malloc(numVertices * sizeof(label_t));
 
 			#ifdef _OPENMP
 			#pragma omp parallel for
@@ -667,15 +1232,13 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 		}
 
 		// Assign offsets and calculate the number of constraints satisfied:
-		cluster* newCluster = NULL;
-		
 		#ifdef _OPENMP
 		#pragma omp parallel for
 		#endif
 		for(i = 0; i < array_list_size(newClusters); i++)
 		{
-			newCluster = ((cluster**)newClusters->data)[i];
-			newCluster->offset = lineCount;
+			label_t newCluster = label_list_at(newClusters, i);
+			sc->clusters.offset[newCluster] = lineCount;
 		}
 		
 		#ifdef _OPENMP
@@ -697,7 +1260,7 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 
 	hierarchy_entry* entry = hdbscan_create_hierarchy_entry();
 	entry->edgeWeight = 0.0;
-	entry->labels = (label_t*) malloc(numVertices * sizeof(label_t));
+	entry->labels = (label_t*) hdbscan_malloc(numVertices * sizeof(label_t));
 	
 	#ifdef _OPENMP
 	#pragma omp parallel for
@@ -714,6 +1277,9 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
 
 	set_delete(affectedClusterLabels);
 	set_delete(affectedVertices);
+	hdbscan_delete_exploration_sets(examinedVertices, firstChildCluster, unexploredFirstChildClusterPoints, constructingSubCluster, unexploredSubClusterPoints);
+	workspace_release(&sc->scratch, scratchMark);
+	progress_report(&sc->runProgress, PHASE_HIERARCHY, 1.0);
 
 	return HDBSCAN_SUCCESS;
 }
@@ -724,7 +1290,7 @@ int hdbscan_compute_hierarchy_and_cluster_tree(hdbscan* sc, int compactHierarchy
  * @return hierarchy_entry* 
  */
 hierarchy_entry* hdbscan_create_hierarchy_entry(){
-	hierarchy_entry* entry = (hierarchy_entry *) malloc(sizeof(hierarchy_entry));
+	hierarchy_entry* entry = (hierarchy_entry *) hdbscan_malloc(sizeof(hierarchy_entry));
 	entry->labels = NULL;
 	entry->edgeWeight = 0.0;
 	return entry;
@@ -817,7 +1383,19 @@ int hdbscan_construct_mst(hdbscan* sc){
 	}
 
 	//One bit is set (true) for each attached point, or unset (false) for unattached points:
-	boolean attachedPoints[size];
+	size_t scratchMark = workspace_mark(&sc->scratch);
+	boolean* attachedPoints = workspace_alloc(&sc->scratch, size * sizeof(boolean));
+
+	if(attachedPoints == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_construct_mst - Could not allocate attachedPoints\n");
+	#else
+		printf("FATAL: hdbscan_construct_mst - Could not allocate attachedPoints\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
@@ -843,6 +1421,7 @@ int hdbscan_construct_mst(hdbscan* sc){
 	printf("FATAL: hdbscan_construct_mst - Could not construct nearestMRDNeighbors\n");
 #endif
 		
+		workspace_release(&sc->scratch, scratchMark);
 		return HDBSCAN_ERROR;
 	}
 
@@ -853,6 +1432,7 @@ int hdbscan_construct_mst(hdbscan* sc){
 		printf("FATAL: hdbscan_construct_mst - Could not construct otherVertexIndices\n");
 	#endif
 		
+		workspace_release(&sc->scratch, scratchMark);
 		return HDBSCAN_ERROR;
 	}
 
@@ -901,11 +1481,21 @@ int hdbscan_construct_mst(hdbscan* sc){
 		printf("FATAL: hdbscan_construct_mst - Could not construct nearestMRDDistances\n");
 	#endif
 		
+		workspace_release(&sc->scratch, scratchMark);
 		return HDBSCAN_ERROR;
 	}
 
 	//Continue attaching points to the MST until all points are attached:
 	for (index_t numAttachedPoints = 1; numAttachedPoints < size; numAttachedPoints++) {
+		if(progress_report(&sc->runProgress, PHASE_MST, (double)numAttachedPoints / size)){
+			array_list_delete(nearestMRDNeighbors);
+			array_list_delete(otherVertexIndices);
+			array_list_delete(nearestMRDDistances);
+			workspace_release(&sc->scratch, scratchMark);
+
+			return HDBSCAN_ERROR;
+		}
+
 		int32_t nearestMRDPoint = -1;
 		distance_t nearestMRDDistance = D_MAX;
 
@@ -948,6 +1538,7 @@ int hdbscan_construct_mst(hdbscan* sc){
 		others[numAttachedPoints] = numAttachedPoints;
 		currentPoint = (index_t)nearestMRDPoint;
 	}
+	progress_report(&sc->runProgress, PHASE_MST, 1.0);
 
 	//If necessary, attach self edges:
 	if (sc->selfEdges == TRUE) {
@@ -964,7 +1555,8 @@ int hdbscan_construct_mst(hdbscan* sc){
 		}
 	}
 
-	sc->mst = graph_init(NULL, size, nearestMRDNeighbors, otherVertexIndices, nearestMRDDistances);
+	workspace_release(&sc->scratch, scratchMark);
+	sc->mst = graph_init_csr(NULL, size, nearestMRDNeighbors, otherVertexIndices, nearestMRDDistances);
 	
 	if(sc->mst == NULL){
 	#ifdef DEBUG
@@ -987,63 +1579,17 @@ int hdbscan_construct_mst(hdbscan* sc){
  */
 boolean hdbscan_propagate_tree(hdbscan* sc){
 
-	set_t* clustersToExamine = set_init(sizeof(label_t), NULL);
-	
-	if(sizeof(label_t) == sizeof(int)) {
-		clustersToExamine->compare = int_compare;
-	} else if(sizeof(label_t) == sizeof(long)) {
-		clustersToExamine->compare = long_compare;
-	} else {
-		clustersToExamine->compare = short_compare;
-	}
-
-	boolean addedToExaminationList[sc->clusters->size];
+	cluster_pool* pool = &sc->clusters;
 	boolean infiniteStability = FALSE;
-	size_t i;
-
-	#ifdef _OPENMP
-		#pragma omp parallel for
-	#endif
-	for(i = 0; i < sc->clusters->size; i++){
-		addedToExaminationList[i] = FALSE;
-	}
-
-	#ifdef _OPENMP
-		#pragma omp parallel for
-	#endif
-	for(i = 0; i < sc->clusters->size; i++){
 
-		cluster* cl = ((cluster**)sc->clusters->data)[i];
-		if(cl != NULL && cl->hasChildren == FALSE){
-			#ifdef _OPENMP
-				#pragma omp critical
-			#endif
-			{
-			set_insert(clustersToExamine, &cl->label);
-			addedToExaminationList[cl->label] = TRUE;
-			}
-		}
-	}
-
-	label_t x;
-	cluster* currentCluster;
-	while(!set_empty(clustersToExamine)){
-		
-		set_remove_at(clustersToExamine, clustersToExamine->size-1, &x);
-		currentCluster = ((cluster **)sc->clusters->data)[x];
-		cluster_propagate(currentCluster);
+	//A child is always created after its parent and so has a larger label.
+	//Walking the labels downwards visits every child before its parent.
+	for(label_t label = (label_t)(pool->size - 1); label > 0; label--){
+		cluster_pool_propagate(pool, label);
 
-		if(currentCluster->stability == D_MAX){
+		if(pool->stability[label] == D_MAX){
 			infiniteStability = TRUE;
 		}
-		if(currentCluster->parent != NULL){
-			cluster *parent = currentCluster->parent;
-
-			if(addedToExaminationList[parent->label] == FALSE){
-				set_insert(clustersToExamine, &parent->label);
-				addedToExaminationList[parent->label] = TRUE;
-			}
-		}
 	}
 
 	if(infiniteStability){
@@ -1062,8 +1608,6 @@ boolean hdbscan_propagate_tree(hdbscan* sc){
 		printf("%s", message);
 	#endif
 	}
-	currentCluster = NULL;
-	set_delete(clustersToExamine);
 
 	return infiniteStability;
 }
@@ -1076,244 +1620,1403 @@ boolean hdbscan_propagate_tree(hdbscan* sc){
  */
 void hdbscan_find_prominent_clusters(hdbscan* sc, int infiniteStability){
 	
-	cluster* cl = ((cluster **) sc->clusters->data)[1];
-	ArrayList *solution = cl->propagatedDescendants;
-	
-	hashtable *significant = hashtable_init(array_list_size(solution), H_LONG, H_PTR, long_compare);
-	int32_t ret;
-	cluster* c = NULL;
+	cluster_pool* pool = &sc->clusters;
+	cluster_pool_collect_solution(pool, sc->selectionMethod == SELECTION_LEAF, sc->clusterSelectionEpsilon);
 
-	#ifdef _OPENMP
-		#pragma omp parallel for private(ret, c)
+	if(sc->clusterLabels == NULL){
+		sc->clusterLabels = (label_t *)hdbscan_malloc(sc->numPoints * sizeof(label_t));
+	}
+
+	if(sc->clusterLabels == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_find_prominent_clusters - Could not allocate memory for cluster labels.\n");
+	#else
+		printf("FATAL: hdbscan_find_prominent_clusters - Could not allocate memory for cluster labels.\n");
 	#endif
-	for(size_t i = 0; i < solution->size; i++){
-		
-		#ifdef _OPENMP
-			#pragma omp critical
-		#endif
-		{
-		ret = array_list_value_at(solution, i, &c);
-
-		if(ret != 0){
-			ArrayList* clusterList = NULL;
-			ret = hashtable_lookup(significant, &c->offset, &clusterList);
-
-			if(clusterList == NULL){
-				clusterList = array_list_init(16, sizeof(label_t), NULL);
-				if(sizeof(label_t) == sizeof(int)) {
-					clusterList->compare = int_compare;
-				} else if(sizeof(label_t) == sizeof(long)) {
-					clusterList->compare = long_compare;
-				} else {
-					clusterList->compare = short_compare;
-				}
-				long tmp = c->offset;
-				hashtable_insert(significant, &tmp, &clusterList);
-			}
-			
-			array_list_append(clusterList, &(c->label));
-		}
-		}
+
+		return;
 	}
-	
-	sc->clusterLabels = (label_t *)calloc(sc->numPoints, sizeof(label_t));
 
+	//Every point ends up as noise in the virtual child of the deepest cluster it was
+	//part of, and that cluster maps straight to its cluster in the solution.
 	#ifdef _OPENMP
 		#pragma omp parallel for
 	#endif
-	for(size_t i = 0; i < set_size(significant->keys); i++)
-	{
-		int64_t key = ((int64_t *)significant->keys->data)[i];
-
-		ArrayList* clusterList = NULL;
-		hashtable_lookup(significant, &key, &clusterList);
-		hierarchy_entry* hpSecond;
-		int64_t l = key + 1;
-		
-		hashtable_lookup(sc->hierarchy, &l, &hpSecond);
-		for(index_t j = 0; j < sc->numPoints; j++){
-			label_t label = (hpSecond->labels)[j];
-			int64_t it = array_list_find(clusterList, &label, 0);
-			if(it != -1){
-				sc->clusterLabels[j] = label;
-			}
-		}
+	for(index_t j = 0; j < sc->numPoints; j++){
+		sc->clusterLabels[j] = pool->solution[pool->virtualChildOf[j]];
 	}
-
-	hashtable_destroy(significant, NULL, (void (*)(void *))array_list_delete);
 }
 
 /**
  * @brief 
  * 
  * @param sc 
- * @param pointNoiseLevels 
- * @param pointLastClusters 
- * @param infiniteStability 
+ * @param method 
+ * @param epsilon 
  * @return int 
  */
-int hdbscsan_calculate_outlier_scores(hdbscan* sc, distance_t* pointNoiseLevels, label_t* pointLastClusters, boolean infiniteStability){
+int hdbscan_select_clusters(hdbscan* sc, SELECTION_METHOD method, distance_t epsilon){
+
+	if(sc->clusters.size < 2){
+	#ifdef DEBUG
+		logger_write(ERROR, "hdbscan_select_clusters - There is no cluster tree, hdbscan_run must be called first.\n");
+	#else
+		printf("ERROR: hdbscan_select_clusters - There is no cluster tree, hdbscan_run must be called first.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
+	sc->selectionMethod = method;
+	sc->clusterSelectionEpsilon = epsilon;
+	hdbscan_find_prominent_clusters(sc, FALSE);
+
+	return sc->clusterLabels == NULL ? HDBSCAN_ERROR : HDBSCAN_SUCCESS;
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param cutDistance 
+ * @param labels 
+ * @return int 
+ */
+int hdbscan_cut_tree(hdbscan* sc, distance_t cutDistance, label_t* labels){
+
+	cluster_pool* pool = &sc->clusters;
+	if(pool->size < 2){
+	#ifdef DEBUG
+		logger_write(ERROR, "hdbscan_cut_tree - There is no cluster tree, hdbscan_run must be called first.\n");
+	#else
+		printf("ERROR: hdbscan_cut_tree - There is no cluster tree, hdbscan_run must be called first.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
+	//The edges heavier than the cut are gone, so the clusters that exist at the cut are
+	//those born above it. Map every cluster to its deepest ancestor that already exists.
+	pool->ancestor[0] = 0;
+	for(label_t label = 1; label < pool->size; label++){
+		label_t parent = pool->parent[label];
+
+		if(parent == 0 || pool->birthLevel[label] > cutDistance){
+			pool->ancestor[label] = label;
+		} else{
+			pool->ancestor[label] = pool->ancestor[parent];
+		}
+	}
+
+	//A point that fell out as noise above the cut is noise, otherwise it is still part of
+	//the cluster its last cluster descends from.
+	#ifdef _OPENMP
+		#pragma omp parallel for
+	#endif
+	for(index_t j = 0; j < sc->numPoints; j++){
+		if(pool->noiseLevel[j] > cutDistance){
+			labels[j] = 0;
+		} else{
+			labels[j] = pool->ancestor[pool->virtualChildOf[j]];
+		}
+	}
+
+	return HDBSCAN_SUCCESS;
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param newPoints 
+ * @param m 
+ * @param labels 
+ * @param probabilities 
+ * @return int 
+ */
+int hdbscan_approximate_predict(hdbscan* sc, void* newPoints, index_t m, label_t* labels, distance_t* probabilities){
+
+	cluster_pool* pool = &sc->clusters;
+	if(pool->size < 2 || sc->dataSet == NULL){
+	#ifdef DEBUG
+		logger_write(ERROR, "hdbscan_approximate_predict - There is no fitted model, hdbscan_run must be called first with prediction enabled.\n");
+	#else
+		printf("ERROR: hdbscan_approximate_predict - There is no fitted model, hdbscan_run must be called first with prediction enabled.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
+	distance* dis = &sc->distanceFunction;
+	distance_t* coreDistances = dis->coreDistances;
+	index_t numNeighbors = dis->numNeighbors;
+
+	int numThreads = 1;
+#ifdef _OPENMP
+	numThreads = omp_get_max_threads();
+#endif
+
+	//The distances from one new point to all the training points and its nearest
+	//neighbour distances, one slice per thread
+	size_t stride = (size_t)sc->numPoints + numNeighbors + 1;
+	distance_t* buffers = (distance_t *)hdbscan_malloc((size_t)numThreads * stride * sizeof(distance_t));
+	if(buffers == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_approximate_predict - Could not allocate memory for the distances.\n");
+	#else
+		printf("FATAL: hdbscan_approximate_predict - Could not allocate memory for the distances.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
+	#ifdef _OPENMP
+		#pragma omp parallel num_threads(numThreads)
+	#endif
+	{
+		int tid = 0;
+	#ifdef _OPENMP
+		tid = omp_get_thread_num();
+	#endif
+		distance_t* dists = buffers + (size_t)tid * stride;
+		distance_t* sortedDistance = dists + sc->numPoints;
+
+		#ifdef _OPENMP
+			#pragma omp for
+		#endif
+		for(index_t i = 0; i < m; i++){
+			//The new point counts itself as its first neighbour, the same as the
+			//training points do in distance_get_core_distances()
+			sortedDistance[0] = 0;
+			for(index_t k = 1; k <= numNeighbors; k++){
+				sortedDistance[k] = D_MAX;
+			}
+
+			for(index_t j = 0; j < sc->numPoints; j++){
+				distance_t d = distance_between(dis, newPoints, i, sc->dataSet, j);
+				dists[j] = d;
+
+				if(d < sortedDistance[numNeighbors]){
+					index_t k = numNeighbors;
+					while(k > 0 && sortedDistance[k-1] > d){
+						sortedDistance[k] = sortedDistance[k-1];
+						k--;
+					}
+					sortedDistance[k] = d;
+				}
+			}
+			distance_t coreDistance = sortedDistance[numNeighbors];
+
+			//The training point the new point would be linked to in the MST
+			index_t nearest = 0;
+			distance_t reach = D_MAX;
+			for(index_t j = 0; j < sc->numPoints; j++){
+				distance_t r = dists[j];
+				if(coreDistance > r){
+					r = coreDistance;
+				}
+
+				if(coreDistances[j] > r){
+					r = coreDistances[j];
+				}
+
+				if(r < reach){
+					reach = r;
+					nearest = j;
+				}
+			}
+
+			//Climb from the last cluster of the neighbour to the first cluster that
+			//still exists at the level the new point joins at
+			label_t c = pool->virtualChildOf[nearest];
+			while(pool->parent[c] != 0 && pool->birthLevel[c] <= reach){
+				c = pool->parent[c];
+			}
+
+			label_t label = pool->solution[c];
+			labels[i] = label;
+
+			if(probabilities != NULL){
+				distance_t strength = 0;
+				if(label != 0){
+					distance_t densest = pool->propagatedLowestChildDeathLevel[label];
+					strength = reach <= densest ? 1 : densest / reach;
+				}
+				probabilities[i] = strength;
+			}
+		}
+	}
+
+	hdbscan_free(buffers);
+	return HDBSCAN_SUCCESS;
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param clusters 
+ * @return index_t 
+ */
+index_t hdbscan_selected_clusters(hdbscan* sc, label_t* clusters){
+	cluster_pool* pool = &sc->clusters;
+	index_t k = 0;
+
+	for(label_t label = 1; label < pool->size; label++){
+		if(pool->solution[label] == label){
+			if(clusters != NULL){
+				clusters[k] = label;
+			}
+			k++;
+		}
+	}
+
+	return k;
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param memberships 
+ * @return int 
+ */
+int hdbscan_membership_vectors(hdbscan* sc, distance_t* memberships){
+
+	cluster_pool* pool = &sc->clusters;
+	if(pool->size < 2 || sc->clusterLabels == NULL){
+	#ifdef DEBUG
+		logger_write(ERROR, "hdbscan_membership_vectors - There are no clusters, hdbscan_run must be called first.\n");
+	#else
+		printf("ERROR: hdbscan_membership_vectors - There are no clusters, hdbscan_run must be called first.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
+	index_t numClusters = hdbscan_selected_clusters(sc, NULL);
+	if(numClusters == 0){
+		return HDBSCAN_SUCCESS;
+	}
+
+	label_t* clusters = (label_t *)hdbscan_malloc(numClusters * sizeof(label_t));
+	index_t* column = (index_t *)hdbscan_malloc(pool->size * sizeof(index_t));
+	index_t* offsets = (index_t *)hdbscan_calloc(numClusters + 1, sizeof(index_t));
+	index_t* exemplars = (index_t *)hdbscan_malloc(sc->numPoints * sizeof(index_t));
+	distance_t* merge = (distance_t *)hdbscan_malloc((size_t)pool->size * numClusters * sizeof(distance_t));
+
+	int numThreads = 1;
+#ifdef _OPENMP
+	numThreads = omp_get_max_threads();
+#endif
+
+	//The ancestor walk of every thread gets its own slice of these
+	label_t* lcas = (label_t *)hdbscan_malloc((size_t)numThreads * pool->size * sizeof(label_t));
+	boolean* onPaths = (boolean *)hdbscan_calloc((size_t)numThreads * pool->size, sizeof(boolean));
+
+	if(clusters == NULL || column == NULL || offsets == NULL || exemplars == NULL || merge == NULL || lcas == NULL || onPaths == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_membership_vectors - Could not allocate memory.\n");
+	#else
+		printf("FATAL: hdbscan_membership_vectors - Could not allocate memory.\n");
+	#endif
+
+		hdbscan_free(clusters);
+		hdbscan_free(column);
+		hdbscan_free(offsets);
+		hdbscan_free(exemplars);
+		hdbscan_free(merge);
+		hdbscan_free(lcas);
+		hdbscan_free(onPaths);
+		return HDBSCAN_ERROR;
+	}
+
+	hdbscan_selected_clusters(sc, clusters);
+	for(index_t k = 0; k < numClusters; k++){
+		column[clusters[k]] = k;
+	}
+
+	//The exemplars of a selected cluster are the points that stay in its leaves until
+	//the leaves die. They are grouped by cluster with a counting sort.
+	for(index_t j = 0; j < sc->numPoints; j++){
+		label_t leaf = pool->virtualChildOf[j];
+		if(pool->solution[leaf] != 0 && !pool->hasChildren[leaf] && pool->noiseLevel[j] == pool->deathLevel[leaf]){
+			offsets[column[pool->solution[leaf]] + 1]++;
+		}
+	}
+
+	for(index_t k = 0; k < numClusters; k++){
+		offsets[k + 1] += offsets[k];
+	}
+
+	for(index_t j = 0; j < sc->numPoints; j++){
+		label_t leaf = pool->virtualChildOf[j];
+		if(pool->solution[leaf] != 0 && !pool->hasChildren[leaf] && pool->noiseLevel[j] == pool->deathLevel[leaf]){
+			index_t k = column[pool->solution[leaf]];
+			exemplars[offsets[k]] = j;
+			offsets[k]++;
+		}
+	}
+
+	for(index_t k = numClusters; k > 0; k--){
+		offsets[k] = offsets[k - 1];
+	}
+	offsets[0] = 0;
+
+	//merge[label * numClusters + k] is the level at which a point whose last cluster is
+	//label joins cluster k: the birth of k when label is inside k, otherwise the level
+	//at which their lowest common ancestor splits.
+	#ifdef _OPENMP
+		#pragma omp parallel num_threads(numThreads)
+	#endif
+	{
+		int tid = 0;
+	#ifdef _OPENMP
+		tid = omp_get_thread_num();
+	#endif
+		label_t* lca = lcas + (size_t)tid * pool->size;
+		boolean* onPath = onPaths + (size_t)tid * pool->size;
+
+		#ifdef _OPENMP
+			#pragma omp for
+		#endif
+		for(index_t k = 0; k < numClusters; k++){
+			label_t target = clusters[k];
+			lca[0] = 0;
+			for(label_t c = target; c != 0; c = pool->parent[c]){
+				onPath[c] = TRUE;
+			}
+
+			for(label_t c = 1; c < pool->size; c++){
+				lca[c] = onPath[c] ? c : lca[pool->parent[c]];
+
+				if(lca[c] == target){
+					merge[(size_t)c * numClusters + k] = pool->birthLevel[target];
+				} else{
+					merge[(size_t)c * numClusters + k] = pool->deathLevel[lca[c]];
+				}
+			}
+
+			for(label_t c = target; c != 0; c = pool->parent[c]){
+				onPath[c] = FALSE;
+			}
+		}
+	}
+
+	hdbscan_free(lcas);
+	hdbscan_free(onPaths);
+
+	distance* dis = &sc->distanceFunction;
+
+	#ifdef _OPENMP
+		#pragma omp parallel for
+	#endif
+	for(index_t j = 0; j < sc->numPoints; j++){
+		distance_t* row = memberships + (size_t)j * numClusters;
+		distance_t* mergeRow = merge + (size_t)pool->virtualChildOf[j] * numClusters;
+
+		//Distance to the nearest exemplar of every cluster
+		distance_t nearestExemplar = D_MAX;
+		for(index_t k = 0; k < numClusters; k++){
+			distance_t d = D_MAX;
+			for(index_t e = offsets[k]; e < offsets[k + 1]; e++){
+				distance_t de = distance_get(dis, j, exemplars[e]);
+				if(de < d){
+					d = de;
+				}
+			}
+
+			row[k] = d;
+			if(d < nearestExemplar){
+				nearestExemplar = d;
+			}
+		}
+
+		//The outlier term of cluster k is m / (m - densest) where m is the merge level
+		//and densest is the level at which the densest part of k dies. It goes into a
+		//softmax, so the largest score is subtracted first.
+		distance_t maxScore = -D_MAX;
+		distance_t nearestMerge = D_MAX;
+		index_t nearestCluster = 0;
+		for(index_t k = 0; k < numClusters; k++){
+			distance_t m = mergeRow[k];
+			distance_t densest = pool->propagatedLowestChildDeathLevel[clusters[k]];
+			distance_t score = m > densest ? m / (m - densest) : D_MAX;
+
+			if(score > maxScore){
+				maxScore = score;
+			}
+
+			if(m < nearestMerge){
+				nearestMerge = m;
+				nearestCluster = k;
+			}
+		}
+
+		distance_t sum = 0;
+		for(index_t k = 0; k < numClusters; k++){
+			distance_t dist;
+			if(nearestExemplar == 0){
+				dist = row[k] == 0 ? 1 : 0;
+			} else{
+				dist = nearestExemplar / row[k];
+			}
+
+			distance_t m = mergeRow[k];
+			distance_t densest = pool->propagatedLowestChildDeathLevel[clusters[k]];
+			distance_t score = m > densest ? m / (m - densest) : D_MAX;
+
+			row[k] = dist * exp(score - maxScore);
+			sum += row[k];
+		}
+
+		//The probability that the point is in any cluster at all
+		distance_t densest = pool->propagatedLowestChildDeathLevel[clusters[nearestCluster]];
+		distance_t noise = pool->noiseLevel[j];
+		distance_t inCluster = noise <= densest ? 1 : densest / noise;
+
+		for(index_t k = 0; k < numClusters; k++){
+			row[k] = sum > 0 ? inCluster * row[k] / sum : inCluster / numClusters;
+		}
+	}
+
+	hdbscan_free(clusters);
+	hdbscan_free(column);
+	hdbscan_free(offsets);
+	hdbscan_free(exemplars);
+	hdbscan_free(merge);
+
+	return HDBSCAN_SUCCESS;
+}
+
+/**
+ * @brief Find the root of the component of v in the union-find forest of
+ * hdbscan_dbcv, halving the path on the way
+ * 
+ * @param parent 
+ * @param v 
+ * @return index_t 
+ */
+static index_t hdbscan_dbcv_find(index_t* parent, index_t v){
+	while(parent[v] != v){
+		parent[v] = parent[parent[v]];
+		v = parent[v];
+	}
+
+	return v;
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param validity 
+ * @param clusterValidity 
+ * @return int 
+ */
+int hdbscan_dbcv(hdbscan* sc, distance_t* validity, distance_t* clusterValidity){
+
+	cluster_pool* pool = &sc->clusters;
+	if(sc->mst == NULL || sc->clusterLabels == NULL){
+	#ifdef DEBUG
+		logger_write(ERROR, "hdbscan_dbcv - There is no minimum spanning tree, hdbscan_run must be called first.\n");
+	#else
+		printf("ERROR: hdbscan_dbcv - There is no minimum spanning tree, hdbscan_run must be called first.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+
+	*validity = 0;
+	index_t numClusters = hdbscan_selected_clusters(sc, NULL);
+	if(numClusters == 0){
+		return HDBSCAN_SUCCESS;
+	}
+
+	int numThreads = 1;
+#ifdef _OPENMP
+	numThreads = omp_get_max_threads();
+#endif
+
+	//The per-thread sparseness of every cluster is followed by the per-thread widest
+	//edge and the per-thread shortest edge to noise
+	size_t slots = (size_t)numThreads * numClusters;
+	label_t* clusters = (label_t *)hdbscan_malloc(numClusters * sizeof(label_t));
+	index_t* column = (index_t *)hdbscan_malloc(pool->size * sizeof(index_t));
+	distance_t* sparseness = (distance_t *)hdbscan_malloc((slots + 2 * (size_t)numThreads) * sizeof(distance_t));
+	distance_t* separation = (distance_t *)hdbscan_malloc(numClusters * sizeof(distance_t));
+	index_t* sizes = (index_t *)hdbscan_malloc(slots * sizeof(index_t));
+	distance_t* values = (distance_t *)hdbscan_malloc(numClusters * sizeof(distance_t));
+	index_t* parent = (index_t *)hdbscan_malloc(2 * (size_t)sc->numPoints * sizeof(index_t));
+	unsigned char* rank = (unsigned char *)hdbscan_calloc(sc->numPoints, sizeof(unsigned char));
+
+	if(clusters == NULL || column == NULL || sparseness == NULL || separation == NULL || sizes == NULL || values == NULL || parent == NULL || rank == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_dbcv - Could not allocate memory for the validity index.\n");
+	#else
+		printf("FATAL: hdbscan_dbcv - Could not allocate memory for the validity index.\n");
+	#endif
+
+		hdbscan_free(clusters);
+		hdbscan_free(column);
+		hdbscan_free(sparseness);
+		hdbscan_free(separation);
+		hdbscan_free(sizes);
+		hdbscan_free(values);
+		hdbscan_free(parent);
+		hdbscan_free(rank);
+		return HDBSCAN_ERROR;
+	}
+
+	//Labels that are not selected clusters, noise included, get column numClusters
+	hdbscan_selected_clusters(sc, clusters);
+	for(label_t label = 0; label < pool->size; label++){
+		column[label] = numClusters;
+	}
+
+	for(index_t k = 0; k < numClusters; k++){
+		column[clusters[k]] = k;
+		separation[k] = D_MAX;
+	}
+
+	for(size_t s = 0; s < slots; s++){
+		sparseness[s] = 0;
+		sizes[s] = 0;
+	}
+
+	distance_t* maxDistance = sparseness + slots;
+	distance_t* outlierSeparation = maxDistance + numThreads;
+	label_t* labels = sc->clusterLabels;
+	index_t* verticesA = (index_t *)sc->mst->verticesA->data;
+	index_t* verticesB = (index_t *)sc->mst->verticesB->data;
+	distance_t* weights = (distance_t *)sc->mst->edgeWeights->data;
+	size_t numEdges = sc->mst->verticesA->size;
+
+	//Every MST edge only touches the clusters of its two ends, so each thread keeps
+	//the sparseness (widest inner edge) of every cluster for its share of the edges
+	//and the shares are reduced afterwards
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads)
+#endif
+	{
+		int t = 0;
+	#ifdef _OPENMP
+		t = omp_get_thread_num();
+	#endif
+		distance_t* tSparseness = sparseness + (size_t)t * numClusters;
+		index_t* tSizes = sizes + (size_t)t * numClusters;
+		distance_t tMax = 0;
+		distance_t tOutlier = D_MAX;
+
+	#ifdef _OPENMP
+	#pragma omp for nowait
+	#endif
+		for(index_t i = 0; i < sc->numPoints; i++){
+			index_t k = column[labels[i]];
+			if(k < numClusters){
+				tSizes[k]++;
+			}
+		}
+
+	#ifdef _OPENMP
+	#pragma omp for
+	#endif
+		for(size_t e = 0; e < numEdges; e++){
+			index_t a = verticesA[e];
+			index_t b = verticesB[e];
+
+			// Self edges only carry the core distances
+			if(a == b){
+				continue;
+			}
+
+			distance_t w = weights[e];
+			index_t ka = column[labels[a]];
+			index_t kb = column[labels[b]];
+
+			if(w > tMax){
+				tMax = w;
+			}
+
+			if(ka == numClusters && kb == numClusters){
+				continue;
+			} else if(ka == numClusters || kb == numClusters){
+				if(w < tOutlier){
+					tOutlier = w;
+				}
+			} else if(ka == kb){
+				if(w > tSparseness[ka]){
+					tSparseness[ka] = w;
+				}
+			}
+		}
+
+		maxDistance[t] = tMax;
+		outlierSeparation[t] = tOutlier;
+	}
+
+	for(int t = 1; t < numThreads; t++){
+		if(maxDistance[t] > maxDistance[0]){
+			maxDistance[0] = maxDistance[t];
+		}
+
+		if(outlierSeparation[t] < outlierSeparation[0]){
+			outlierSeparation[0] = outlierSeparation[t];
+		}
+	}
+
+	//The separation of a cluster is the smallest minimax MST path weight to another
+	//cluster, which may run through noise. The MST edges are sorted by weight in
+	//hdbscan_do_run, so a single linkage pass finds it: every component knows if it
+	//holds no cluster, one cluster or several, and a cluster is separated at the
+	//weight of the first edge that joins its component to another cluster.
+	index_t* owner = parent + sc->numPoints;
+	index_t several = numClusters + 1;
+	for(index_t v = 0; v < sc->numPoints; v++){
+		parent[v] = v;
+		owner[v] = column[labels[v]];
+	}
+
+	for(size_t e = 0; e < numEdges; e++){
+		index_t ra = hdbscan_dbcv_find(parent, verticesA[e]);
+		index_t rb = hdbscan_dbcv_find(parent, verticesB[e]);
+		if(ra == rb){
+			continue;
+		}
+
+		index_t oa = owner[ra];
+		index_t ob = owner[rb];
+		index_t merged;
+
+		if(oa == numClusters || oa == ob){
+			merged = ob;
+		} else if(ob == numClusters){
+			merged = oa;
+		} else{
+			distance_t w = weights[e];
+			if(oa < numClusters && w < separation[oa]){
+				separation[oa] = w;
+			}
+
+			if(ob < numClusters && w < separation[ob]){
+				separation[ob] = w;
+			}
+			merged = several;
+		}
+
+		if(rank[ra] < rank[rb]){
+			parent[ra] = rb;
+			owner[rb] = merged;
+		} else{
+			if(rank[ra] == rank[rb]){
+				rank[ra]++;
+			}
+			parent[rb] = ra;
+			owner[ra] = merged;
+		}
+	}
+
+	//A cluster that the MST does not join to another cluster at all is an island,
+	//its separation is replaced by a value larger than any edge
+	distance_t correction = maxDistance[0];
+	if(numClusters == 1 && outlierSeparation[0] != D_MAX){
+		correction = outlierSeparation[0];
+	}
+	correction *= 2;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(index_t k = 0; k < numClusters; k++){
+		distance_t dsc = sparseness[k];
+		distance_t dspc = separation[k];
+
+		for(int t = 1; t < numThreads; t++){
+			size_t s = (size_t)t * numClusters + k;
+
+			if(sparseness[s] > dsc){
+				dsc = sparseness[s];
+			}
+
+			sizes[k] += sizes[s];
+		}
+
+		if(dspc == D_MAX){
+			dspc = correction;
+		}
+
+		distance_t m = dspc > dsc ? dspc : dsc;
+		values[k] = m > 0 ? (dspc - dsc) / m : 0;
+	}
+
+	//Summed in cluster order so the index does not depend on the threads
+	for(index_t k = 0; k < numClusters; k++){
+		*validity += (distance_t)sizes[k] * values[k] / sc->numPoints;
+
+		if(clusterValidity != NULL){
+			clusterValidity[k] = values[k];
+		}
+	}
+
+	hdbscan_free(clusters);
+	hdbscan_free(column);
+	hdbscan_free(sparseness);
+	hdbscan_free(separation);
+	hdbscan_free(sizes);
+	hdbscan_free(values);
+	hdbscan_free(parent);
+	hdbscan_free(rank);
+
+	return HDBSCAN_SUCCESS;
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param pointNoiseLevels 
+ * @param pointLastClusters 
+ * @param infiniteStability 
+ * @return int 
+ */
+int hdbscsan_calculate_outlier_scores(hdbscan* sc, distance_t* pointNoiseLevels, label_t* pointLastClusters, boolean infiniteStability){
+
+	index_t numPoints = sc->numPoints;
+	sc->outlierScores = (distance_t*)hdbscan_malloc(numPoints*sizeof(distance_t));
+
+	if(!sc->outlierScores){
+		
+	#ifdef DEBUG
+		logger_write(FATAL, "Calculate Outlier Score - Could not allocate memory for outlier scores.\n");
+	#else
+		printf("FATAL: Calculate Outlier Score - Could not allocate memory for outlier scores.\n");
+	#endif
+		
+		return HDBSCAN_ERROR;
+	}
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(index_t i = 0; i < sc->numPoints; i++){
+		label_t tmp = pointLastClusters[i];
+		distance_t epsilon_max = sc->clusters.propagatedLowestChildDeathLevel[tmp];
+		distance_t epsilon = pointNoiseLevels[i];
+
+		distance_t score = 0;
+		if(epsilon != 0){
+			score = 1 - (epsilon_max / epsilon);
+		}
+
+		sc->outlierScores[i] = score;
+	}
+
+	return 1;
+}
+
+/**
+ * @brief Move the entry at position i of a heap ordered by outlier_score_compare
+ * down until both of its children are larger.
+ * 
+ * @param heap 
+ * @param size 
+ * @param i 
+ */
+static void hdbscan_outlier_heap_sift_down(outlier_score* heap, index_t size, index_t i){
+	while(1){
+		index_t smallest = i;
+		index_t left = 2 * i + 1;
+		index_t right = 2 * i + 2;
+
+		if(left < size && outlier_score_compare(heap + left, heap + smallest) < 0){
+			smallest = left;
+		}
+
+		if(right < size && outlier_score_compare(heap + right, heap + smallest) < 0){
+			smallest = right;
+		}
+
+		if(smallest == i){
+			return;
+		}
+
+		outlier_score tmp = heap[i];
+		heap[i] = heap[smallest];
+		heap[smallest] = tmp;
+		i = smallest;
+	}
+}
+
+/**
+ * @brief Compare outlier scores so that the most outlying comes first.
+ * 
+ * @param score1 
+ * @param score2 
+ * @return int 
+ */
+static int hdbscan_outlier_score_compare_desc(const void* score1, const void* score2){
+	return outlier_score_compare(score2, score1);
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param k 
+ * @param top 
+ * @return index_t 
+ */
+index_t hdbscan_top_outliers(hdbscan* sc, index_t k, outlier_score* top){
+
+	if(sc->outlierScores == NULL){
+	#ifdef DEBUG
+		logger_write(ERROR, "hdbscan_top_outliers - There are no outlier scores, hdbscan_run must be called first.\n");
+	#else
+		printf("ERROR: hdbscan_top_outliers - There are no outlier scores, hdbscan_run must be called first.\n");
+	#endif
+
+		return 0;
+	}
+
+	if(k > sc->numPoints){
+		k = sc->numPoints;
+	}
+
+	if(k == 0){
+		return 0;
+	}
+
+	distance_t* coreDistances = sc->distanceFunction.coreDistances;
+	int numThreads = 1;
+#ifdef _OPENMP
+	numThreads = omp_get_max_threads();
+#endif
+
+	//Every thread keeps the k largest scores of its share in a min-heap, then
+	//the candidates of all the threads are sorted together.
+	outlier_score* candidates = (outlier_score*)hdbscan_malloc((size_t)numThreads * k * sizeof(outlier_score));
+	index_t* sizes = (index_t*)hdbscan_calloc((size_t)numThreads, sizeof(index_t));
+
+	if(candidates == NULL || sizes == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_top_outliers - Could not allocate memory for the candidates.\n");
+	#else
+		printf("FATAL: hdbscan_top_outliers - Could not allocate memory for the candidates.\n");
+	#endif
+
+		hdbscan_free(candidates);
+		hdbscan_free(sizes);
+		return 0;
+	}
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads)
+#endif
+	{
+		int t = 0;
+	#ifdef _OPENMP
+		t = omp_get_thread_num();
+	#endif
+		outlier_score* heap = candidates + (size_t)t * k;
+		index_t size = 0;
+
+	#ifdef _OPENMP
+	#pragma omp for
+	#endif
+		for(index_t i = 0; i < sc->numPoints; i++){
+			outlier_score os;
+			os.score = sc->outlierScores[i];
+			os.coreDistance = coreDistances[i];
+			os.id = i;
+
+			if(size < k){
+				//Sift the new entry up
+				index_t j = size++;
+				while(j > 0 && outlier_score_compare(&os, heap + (j - 1) / 2) < 0){
+					heap[j] = heap[(j - 1) / 2];
+					j = (j - 1) / 2;
+				}
+				heap[j] = os;
+			} else if(outlier_score_compare(&os, heap) > 0){
+				heap[0] = os;
+				hdbscan_outlier_heap_sift_down(heap, size, 0);
+			}
+		}
+
+		sizes[t] = size;
+	}
+
+	//Pack the heaps together
+	index_t count = sizes[0];
+	for(int t = 1; t < numThreads; t++){
+		memmove(candidates + count, candidates + (size_t)t * k, sizes[t] * sizeof(outlier_score));
+		count = (index_t)(count + sizes[t]);
+	}
+
+	qsort(candidates, count, sizeof(outlier_score), hdbscan_outlier_score_compare_desc);
+	memcpy(top, candidates, k * sizeof(outlier_score));
+
+	hdbscan_free(candidates);
+	hdbscan_free(sizes);
+
+	return k;
+}
+
+/**
+ * @brief 
+ * 
+ * @param labels 
+ * @param begin 
+ * @param end 
+ * @return hashtable* 
+ */
+hashtable* hdbscan_create_cluster_map(label_t* labels, index_t begin, index_t end){
+	index_t bsize = (index_t)((end - begin)/4);
+	hashtable* clusterTable;
+	
+	if(sizeof(label_t) == sizeof(int)) {
+		clusterTable = hashtable_init(bsize, H_INT, H_PTR, int_compare);
+	} else if(sizeof(label_t) == sizeof(long)) {
+		clusterTable = hashtable_init(bsize, H_LONG, H_PTR, long_compare);
+	} else {
+		clusterTable = hashtable_init(bsize, H_SHORT, H_PTR, short_compare);		
+	}
+
+	clusterTable->size = 0;
+
+	cluster_members cm;
+	if(hdbscan_create_cluster_members(&cm, labels, begin, end) == HDBSCAN_ERROR){
+		return clusterTable;
+	}
+
+	for(index_t n = 0; n < cm.numClusters; n++){
+		index_t size = (index_t)(cm.offsets[n + 1] - cm.offsets[n]);
+
+		//Every list gets exactly the size of its cluster
+		ArrayList* clusterList = array_list_init(size, sizeof(index_t), NULL);
+		if(sizeof(index_t) == sizeof(int)) {
+			clusterList->compare = int_compare;
+		} else if(sizeof(index_t) == sizeof(long)) {
+			clusterList->compare = long_compare;
+		} else {
+			clusterList->compare = short_compare;		
+		}
+
+		memcpy(clusterList->data, cm.members + cm.offsets[n], size * sizeof(index_t));
+		clusterList->size = size;
+		hashtable_insert(clusterTable, cm.labels + n, &clusterList);
+	}
+
+	hdbscan_cluster_members_clean(&cm);
+
+	return clusterTable;
+}
+
+/**
+ * @brief 
+ * 
+ * @param cm 
+ * @param labels 
+ * @param begin 
+ * @param end 
+ * @return int 
+ */
+int hdbscan_create_cluster_members(cluster_members* cm, label_t* labels, index_t begin, index_t end){
+
+	cm->numClusters = 0;
+	cm->labels = NULL;
+	cm->offsets = NULL;
+	cm->members = NULL;
+
+	if(labels == NULL || end <= begin){
+		return HDBSCAN_SUCCESS;
+	}
+
+	cm->members = (index_t *)hdbscan_malloc((end - begin) * sizeof(index_t));
+
+	label_t maxLabel = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(max:maxLabel)
+#endif
+	for(index_t i = begin; i < end; i++){
+		if(labels[i] > maxLabel){
+			maxLabel = labels[i];
+		}
+	}
+
+	size_t numBins = (size_t)maxLabel + 1;
+	int numThreads = 1;
+#ifdef _OPENMP
+	numThreads = omp_get_max_threads();
+#endif
+	index_t* counts = (index_t *)hdbscan_calloc((size_t)numThreads * numBins, sizeof(index_t));
+
+	if(cm->members == NULL || counts == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_create_cluster_members - Could not allocate memory for the membership index.\n");
+	#else
+		printf("FATAL: hdbscan_create_cluster_members - Could not allocate memory for the membership index.\n");
+	#endif
+
+		hdbscan_free(counts);
+		hdbscan_cluster_members_clean(cm);
+		return HDBSCAN_ERROR;
+	}
+
+	int err = HDBSCAN_SUCCESS;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads)
+#endif
+	{
+		int t = 0, nt = 1;
+	#ifdef _OPENMP
+		t = omp_get_thread_num();
+		nt = omp_get_num_threads();
+	#endif
+		index_t* count = counts + (size_t)t * numBins;
+		index_t lo = (index_t)(begin + (size_t)(end - begin) * (size_t)t / (size_t)nt);
+		index_t hi = (index_t)(begin + (size_t)(end - begin) * (size_t)(t + 1) / (size_t)nt);
+
+		for(index_t i = lo; i < hi; i++){
+			count[labels[i]]++;
+		}
+
+	#ifdef _OPENMP
+	#pragma omp barrier
+	#pragma omp single
+	#endif
+		{
+			//Turn the counts into the position of every thread's first point of
+			//every label, and find the labels in use
+			index_t numClusters = 0;
+			for(size_t l = 0; l < numBins; l++){
+				for(int u = 0; u < numThreads; u++){
+					if(counts[(size_t)u * numBins + l] > 0){
+						numClusters++;
+						break;
+					}
+				}
+			}
+
+			cm->labels = (label_t *)hdbscan_malloc(numClusters * sizeof(label_t));
+			cm->offsets = (index_t *)hdbscan_malloc((numClusters + 1) * sizeof(index_t));
+
+			if(cm->labels == NULL || cm->offsets == NULL){
+				err = HDBSCAN_ERROR;
+			} else{
+				index_t position = 0;
+				index_t k = 0;
+
+				for(size_t l = 0; l < numBins; l++){
+					index_t start = position;
+					for(int u = 0; u < numThreads; u++){
+						index_t c = counts[(size_t)u * numBins + l];
+						counts[(size_t)u * numBins + l] = position;
+						position = (index_t)(position + c);
+					}
+
+					if(position > start){
+						cm->labels[k] = (label_t)l;
+						cm->offsets[k] = start;
+						k++;
+					}
+				}
+
+				cm->offsets[numClusters] = position;
+				cm->numClusters = numClusters;
+			}
+		}
+
+		if(err == HDBSCAN_SUCCESS){
+			for(index_t i = lo; i < hi; i++){
+				cm->members[count[labels[i]]++] = i;
+			}
+		}
+	}
+
+	hdbscan_free(counts);
+
+	if(err == HDBSCAN_ERROR){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_create_cluster_members - Could not allocate memory for the membership index.\n");
+	#else
+		printf("FATAL: hdbscan_create_cluster_members - Could not allocate memory for the membership index.\n");
+	#endif
+
+		hdbscan_cluster_members_clean(cm);
+	}
+
+	return err;
+}
+
+/**
+ * @brief 
+ * 
+ * @param sc 
+ * @param clusterTable 
+ * @return hashtable* 
+ */
+hashtable* hdbscan_get_min_max_distances(hdbscan* sc, hashtable* clusterTable){
+
+	cluster_members cm;
+	if(hdbscan_cluster_members_from_map(&cm, clusterTable) == HDBSCAN_ERROR){
+		return NULL;
+	}
+
+	distance_values* values = (distance_values *)hdbscan_malloc(cm.numClusters * sizeof(distance_values));
+	if(values == NULL || hdbscan_cluster_members_min_max(sc, &cm, values) == HDBSCAN_ERROR){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_get_min_max_distances - Could not compute the distances.\n");
+	#else
+		printf("FATAL: hdbscan_get_min_max_distances - Could not compute the distances.\n");
+	#endif
+
+		hdbscan_free(values);
+		hdbscan_cluster_members_clean(&cm);
+		return NULL;
+	}
+
+	hashtable* distanceMap;
+
+	if(sizeof(label_t) == sizeof(int)) {
+		distanceMap = hashtable_init_size(clusterTable->size, H_INT, H_PTR, int_compare);
+	} else if(sizeof(label_t) == sizeof(long)) {
+		distanceMap = hashtable_init_size(clusterTable->size, H_LONG, H_PTR, long_compare);
+	} else {
+		distanceMap = hashtable_init_size(clusterTable->size, H_SHORT, H_PTR, short_compare);		
+	}
+
+	for(index_t k = 0; k < cm.numClusters; k++){
+		if(cm.offsets[k + 1] == cm.offsets[k]){
+			continue;
+		}
+
+		distance_values* dl = (distance_values *)hdbscan_malloc(sizeof(distance_values));
+		*dl = values[k];
+		hashtable_insert(distanceMap, cm.labels + k, &dl);
+	}
+
+	hdbscan_free(values);
+	hdbscan_cluster_members_clean(&cm);
+
+	return distanceMap;
+}
+
+/**
+ * @brief 
+ * 
+ * @param cm 
+ * @param clusterTable 
+ * @return int 
+ */
+int hdbscan_cluster_members_from_map(cluster_members* cm, hashtable* clusterTable){
 
-	distance_t* coreDistances = sc->distanceFunction.coreDistances;
-	index_t numPoints = sc->numPoints;
-	sc->outlierScores = (outlier_score*)malloc(numPoints*sizeof(outlier_score));
+	index_t numClusters = (index_t)hashtable_size(clusterTable);
+	label_t* keys = (label_t *)hashtable_keys(clusterTable)->data;
+	index_t numMembers = 0;
+	label_t key;
 
-	if(!sc->outlierScores){
-		
+	for(index_t k = 0; k < numClusters; k++){
+		ArrayList* clusterList = NULL;
+		key = keys[k];
+		hashtable_lookup(clusterTable, &key, &clusterList);
+		numMembers = (index_t)(numMembers + clusterList->size);
+	}
+
+	cm->numClusters = numClusters;
+	cm->labels = (label_t *)hdbscan_malloc(numClusters * sizeof(label_t));
+	cm->offsets = (index_t *)hdbscan_malloc((numClusters + 1) * sizeof(index_t));
+	cm->members = (index_t *)hdbscan_malloc(numMembers * sizeof(index_t));
+
+	if(cm->labels == NULL || cm->offsets == NULL || (cm->members == NULL && numMembers > 0)){
 	#ifdef DEBUG
-		logger_write(FATAL, "Calculate Outlier Score - Could not allocate memory for outlier scores.\n");
+		logger_write(FATAL, "hdbscan_cluster_members_from_map - Could not allocate memory for the membership index.\n");
 	#else
-		printf("FATAL: Calculate Outlier Score - Could not allocate memory for outlier scores.\n");
+		printf("FATAL: hdbscan_cluster_members_from_map - Could not allocate memory for the membership index.\n");
 	#endif
-		
+
+		hdbscan_cluster_members_clean(cm);
 		return HDBSCAN_ERROR;
 	}
 
-#ifdef _OPENMP
-#pragma omp parallel for
-#endif
-	for(index_t i = 0; i < sc->numPoints; i++){
-		label_t tmp = pointLastClusters[i];
-		cluster* c = ((cluster **)sc->clusters->data)[tmp];
-		distance_t epsilon_max = c->propagatedLowestChildDeathLevel;
-		distance_t epsilon = pointNoiseLevels[i];
-
-		distance_t score = 0;
-		if(epsilon != 0){
-			score = 1 - (epsilon_max / epsilon);
-		}
+	cm->offsets[0] = 0;
+	for(index_t k = 0; k < numClusters; k++){
+		ArrayList* clusterList = NULL;
+		key = keys[k];
+		hashtable_lookup(clusterTable, &key, &clusterList);
 
-		sc->outlierScores[i].id = i;
-		sc->outlierScores[i].score = score;
-		sc->outlierScores[i].coreDistance = coreDistances[i];
+		cm->labels[k] = key;
+		memcpy(cm->members + cm->offsets[k], clusterList->data, clusterList->size * sizeof(index_t));
+		cm->offsets[k + 1] = (index_t)(cm->offsets[k] + clusterList->size);
 	}
 
-	//Sort the outlier scores:
-	qsort(sc->outlierScores, numPoints, sizeof(outlier_score), outlier_score_compare);
-
-	return 1;
+	return HDBSCAN_SUCCESS;
 }
 
 /**
  * @brief 
  * 
- * @param labels 
- * @param begin 
- * @param end 
- * @return hashtable* 
+ * @param cm 
  */
-hashtable* hdbscan_create_cluster_map(label_t* labels, index_t begin, index_t end){
-	index_t bsize = (index_t)((end - begin)/4);
-	hashtable* clusterTable;
-	
-	if(sizeof(label_t) == sizeof(int)) {
-		clusterTable = hashtable_init(bsize, H_INT, H_PTR, int_compare);
-	} else if(sizeof(label_t) == sizeof(long)) {
-		clusterTable = hashtable_init(bsize, H_LONG, H_PTR, long_compare);
-	} else {
-		clusterTable = hashtable_init(bsize, H_SHORT, H_PTR, short_compare);		
-	}
+void hdbscan_cluster_members_clean(cluster_members* cm){
 
-	clusterTable->size = 0;
-	index_t size = (index_t)(end - begin);
-	
-	for(index_t i = begin; i < end; i++){
-		label_t *lb = labels + i;
-		ArrayList* clusterList = NULL;
-		hashtable_lookup(clusterTable, lb, &clusterList);
-
-		if(clusterList == NULL){
-			clusterList = array_list_init(size/3, sizeof(index_t), NULL);
-			if(sizeof(index_t) == sizeof(int)) {
-				clusterList->compare = int_compare;
-			} else if(sizeof(index_t) == sizeof(long)) {
-				clusterList->compare = long_compare;
-			} else {
-				clusterList->compare = short_compare;		
-			}
-			hashtable_insert(clusterTable, lb, &clusterList);
-		}
-		array_list_append(clusterList, &i);
-	}
+	hdbscan_free(cm->labels);
+	hdbscan_free(cm->offsets);
+	hdbscan_free(cm->members);
 
-	return clusterTable;
+	cm->labels = NULL;
+	cm->offsets = NULL;
+	cm->members = NULL;
+	cm->numClusters = 0;
 }
 
 /**
  * @brief 
  * 
  * @param sc 
- * @param clusterTable 
- * @return hashtable* 
+ * @param cm 
+ * @param values 
+ * @return int 
  */
-hashtable* hdbscan_get_min_max_distances(hdbscan* sc, hashtable* clusterTable){
+int hdbscan_cluster_members_min_max(hdbscan* sc, cluster_members* cm, distance_values* values){
 
-	hashtable* distanceMap;
+	index_t numClusters = cm->numClusters;
+	if(numClusters == 0){
+		return HDBSCAN_SUCCESS;
+	}
 
-	if(sizeof(label_t) == sizeof(int)) {
-		distanceMap = hashtable_init_size(clusterTable->size, H_INT, H_PTR, int_compare);
-	} else if(sizeof(label_t) == sizeof(long)) {
-		distanceMap = hashtable_init_size(clusterTable->size, H_LONG, H_PTR, long_compare);
-	} else {
-		distanceMap = hashtable_init_size(clusterTable->size, H_SHORT, H_PTR, short_compare);		
+	index_t* firstTask = (index_t *)hdbscan_malloc((numClusters + 1) * sizeof(index_t));
+
+	if(firstTask == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_cluster_members_min_max - Could not allocate memory for the tasks.\n");
+	#else
+		printf("FATAL: hdbscan_cluster_members_min_max - Could not allocate memory for the tasks.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
 	}
 
-	distance_t* core = sc->distanceFunction.coreDistances;
-	distance_t zero = 0.0000000000000000000;
-	label_t key;
+	//Every cluster is cut into blocks of rows and every block is one task
+	firstTask[0] = 0;
+	for(index_t k = 0; k < numClusters; k++){
+		index_t size = (index_t)(cm->offsets[k + 1] - cm->offsets[k]);
+		firstTask[k + 1] = (index_t)(firstTask[k] + (size + HDBSCAN_STATS_BLOCK - 1) / HDBSCAN_STATS_BLOCK);
+	}
 
-	for(size_t i = 0; i < set_size(clusterTable->keys); i++)
-    {
-		key = ((label_t *)clusterTable->keys->data)[i];
-		ArrayList* clusterList = NULL;		
-        hashtable_lookup(clusterTable, &key, &clusterList);
-		index_t* idxList = clusterList->data;
+	index_t numTasks = firstTask[numClusters];
+	index_t* taskCluster = (index_t *)hdbscan_malloc(numTasks * sizeof(index_t));
+	distance_t* minDr = (distance_t *)hdbscan_malloc(numTasks * sizeof(distance_t));
+	distance_t* maxDr = (distance_t *)hdbscan_malloc(numTasks * sizeof(distance_t));
 
-		distance_values* dl = NULL;
-		hashtable_lookup(distanceMap, &key, &dl);
-		
-		for(size_t j = 0; j < clusterList->size; j++) {
-			index_t index = idxList[j];
-			if(dl == NULL)
-			{
-				dl = (distance_values *)malloc(sizeof(distance_values));				
-				dl->min_cr = core[index];
-				dl->max_cr = core[index];
-				dl->cr_confidence = 0.0;
-
-				dl->min_dr = D_MAX;
-				dl->max_dr = D_MIN;
-				dl->dr_confidence = 0.0;
-				hashtable_insert(distanceMap, &key, &dl);
-			} else {
+	if(numTasks > 0 && (taskCluster == NULL || minDr == NULL || maxDr == NULL)){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_cluster_members_min_max - Could not allocate memory for the tasks.\n");
+	#else
+		printf("FATAL: hdbscan_cluster_members_min_max - Could not allocate memory for the tasks.\n");
+	#endif
+
+		hdbscan_free(firstTask);
+		hdbscan_free(taskCluster);
+		hdbscan_free(minDr);
+		hdbscan_free(maxDr);
+		return HDBSCAN_ERROR;
+	}
+
+	for(index_t k = 0; k < numClusters; k++){
+		for(index_t t = firstTask[k]; t < firstTask[k + 1]; t++){
+			taskCluster[t] = k;
+		}
+	}
+
+	distance* dis = &sc->distanceFunction;
+	distance_t* core = dis->coreDistances;
 
-				if(dl->min_cr > core[index] && (core[index] < zero || core[index] > zero)){
-					dl->min_cr = core[index];
+	//The blocks near the start of a cluster have the most pairs, so the tasks are
+	//handed out dynamically
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for(index_t t = 0; t < numTasks; t++){
+		index_t k = taskCluster[t];
+		index_t* idx = cm->members + cm->offsets[k];
+		index_t size = (index_t)(cm->offsets[k + 1] - cm->offsets[k]);
+		index_t begin = (index_t)((t - firstTask[k]) * HDBSCAN_STATS_BLOCK);
+		index_t end = begin + HDBSCAN_STATS_BLOCK < size ? (index_t)(begin + HDBSCAN_STATS_BLOCK) : size;
+
+		distance_t mn = D_MAX;
+		distance_t mx = D_MIN;
+		for(index_t j = begin; j < end; j++){
+			for(index_t l = (index_t)(j + 1); l < size; l++){
+				distance_t d = distance_get(dis, idx[j], idx[l]);
+
+				if(mn > d && d != 0){
+					mn = d;
 				}
 
-				//max core distance
-				if(dl->max_cr < core[index]){
-					dl->max_cr = core[index];
+				if(mx < d){
+					mx = d;
 				}
 			}
-			
-			// Calculating min and max distances
-			for(size_t k = j+1; k < clusterList->size; k++) {
-				distance_t d = distance_get(&(sc->distanceFunction), index, idxList[k]);
+		}
 
-				if(dl->min_dr > d && (d < zero || d > zero)){
-					dl->min_dr = d;
-				}
+		minDr[t] = mn;
+		maxDr[t] = mx;
+	}
 
-				// max distance
-				if(dl->max_dr < d){
-					dl->max_dr = d;
-				}
+	//Reduce the blocks of every cluster and get the core distances
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(index_t k = 0; k < numClusters; k++){
+		distance_values* dl = values + k;
+		index_t* idx = cm->members + cm->offsets[k];
+		index_t size = (index_t)(cm->offsets[k + 1] - cm->offsets[k]);
+
+		dl->cr_confidence = 0.0;
+		dl->dr_confidence = 0.0;
+		dl->min_dr = D_MAX;
+		dl->max_dr = D_MIN;
+
+		if(size == 0){
+			dl->min_cr = D_MAX;
+			dl->max_cr = D_MIN;
+			continue;
+		}
+
+		//The first core distance is taken as it is, after that only non-zero
+		//core distances can lower the minimum
+		dl->min_cr = core[idx[0]];
+		dl->max_cr = core[idx[0]];
+		for(index_t j = 1; j < size; j++){
+			distance_t c = core[idx[j]];
+			if(dl->min_cr > c && c != 0){
+				dl->min_cr = c;
+			}
+
+			if(dl->max_cr < c){
+				dl->max_cr = c;
 			}
 		}
-    }
 
-	return distanceMap;
+		for(index_t t = firstTask[k]; t < firstTask[k + 1]; t++){
+			if(dl->min_dr > minDr[t]){
+				dl->min_dr = minDr[t];
+			}
+
+			if(dl->max_dr < maxDr[t]){
+				dl->max_dr = maxDr[t];
+			}
+		}
+	}
+
+	hdbscan_free(firstTask);
+	hdbscan_free(taskCluster);
+	hdbscan_free(minDr);
+	hdbscan_free(maxDr);
+
+	return HDBSCAN_SUCCESS;
 }
 
 /**
@@ -1323,10 +3026,29 @@ hashtable* hdbscan_get_min_max_distances(hdbscan* sc, hashtable* clusterTable){
  */
 void hdbscan_destroy_distance_map(hashtable* table){
 
-    hashtable_destroy(table, NULL, free);
+    hashtable_destroy(table, NULL, hdbscan_free);
 	table = NULL;
 }
 
+/**
+ * @brief 
+ * 
+ * @param values 
+ * @param m 
+ */
+void hdbscan_stats_from_moments(stats_values* values, const moments* m){
+	distance_t n = (distance_t)m->count;
+
+	values->mean = m->mean;
+	values->variance = moments_variance(m);
+	values->standardDev = (distance_t)sqrt(values->variance);
+
+	//The same definitions as hdbscan_skew_kurt_1
+	distance_t sd3 = values->standardDev * values->variance;
+	values->skewness = (distance_t)(m->m3 / (n * sd3));
+	values->kurtosis = (distance_t)(m->m4 / (n * sd3 * values->standardDev) - 3);
+}
+
 /**
  * @brief Calculate skewness and kurtosis using the equations from 
  * https://www.gnu.org/software/gsl/doc/html/statistics.html
@@ -1405,67 +3127,99 @@ void hdbscan_skew_kurt_2(clustering_stats* stats, distance_t sum_sc, distance_t
 	#endif
 }
 
+/**
+ * @brief The moments and the maximums of the chunk of ratios read by one thread in
+ * hdbscan_calculate_stats_helper
+ */
+typedef struct _stats_chunk{
+	moments cr;
+	moments dr;
+	distance_t crMax;
+	distance_t drMax;
+} stats_chunk;
+
 /**
  * @brief 
  * 
  */
 void hdbscan_calculate_stats_helper(distance_t* cr, distance_t* dr, clustering_stats* stats){
-	
-	stats->coreDistanceValues.mean = cr[0];
-	stats->coreDistanceValues.max = cr[0];
 
-	stats->intraDistanceValues.mean = dr[0];
-	stats->intraDistanceValues.max = dr[0];
+	//Every thread accumulates the moments of one contiguous chunk and the chunks
+	//are merged in order, so the result does not depend on the scheduling. A
+	//single chunk lives on the stack, which is also the fallback when the chunks
+	//cannot be allocated.
+	stats_chunk single;
+	stats_chunk* chunks = &single;
+	int numThreads = 1;
+#ifdef _OPENMP
+	if(stats->count > HDBSCAN_STATS_PARALLEL_MIN){
+		numThreads = omp_get_max_threads();
+	}
+#endif
 
-	for(index_t i = 1; i < stats->count; i++)
-	{
-		// Core distance statistics
-		if(cr[i] > stats->coreDistanceValues.max)
-		{
-			stats->coreDistanceValues.max = cr[i];
+	if(numThreads > 1){
+		chunks = (stats_chunk *)hdbscan_malloc((size_t)numThreads * sizeof(stats_chunk));
+		if(chunks == NULL){
+			chunks = &single;
+			numThreads = 1;
 		}
+	}
 
-		stats->coreDistanceValues.mean += cr[i];
+	for(int t = 0; t < numThreads; t++){
+		moments_init(&chunks[t].cr);
+		moments_init(&chunks[t].dr);
+		chunks[t].crMax = cr[0];
+		chunks[t].drMax = dr[0];
+	}
 
-		// Intra cluster distances
-		if(dr[i] > stats->intraDistanceValues.max)
-		{
-			stats->intraDistanceValues.max = dr[i];
-		}
+#ifdef _OPENMP
+#pragma omp parallel num_threads(numThreads)
+#endif
+	{
+		int t = 0, nt = 1;
+	#ifdef _OPENMP
+		t = omp_get_thread_num();
+		nt = omp_get_num_threads();
+	#endif
+		stats_chunk* chunk = chunks + t;
+		index_t lo = (index_t)((size_t)stats->count * (size_t)t / (size_t)nt);
+		index_t hi = (index_t)((size_t)stats->count * (size_t)(t + 1) / (size_t)nt);
+
+		for(index_t i = lo; i < hi; i++){
+			moments_add(&chunk->cr, cr[i]);
+			moments_add(&chunk->dr, dr[i]);
+
+			if(cr[i] > chunk->crMax){
+				chunk->crMax = cr[i];
+			}
 
-		stats->intraDistanceValues.mean += dr[i];
+			if(dr[i] > chunk->drMax){
+				chunk->drMax = dr[i];
+			}
+		}
 	}
 
-	// Get the average
-	stats->coreDistanceValues.mean = stats->coreDistanceValues.mean/stats->count;
-	stats->intraDistanceValues.mean = stats->intraDistanceValues.mean/stats->count;
+	for(int t = 1; t < numThreads; t++){
+		moments_merge(&chunks[0].cr, &chunks[t].cr);
+		moments_merge(&chunks[0].dr, &chunks[t].dr);
 
-	/// Calculate the variance
-	distance_t sum_sc = 0;
-	distance_t sum_sd = 0;
-	distance_t sum_dc = 0;
-	distance_t sum_dd = 0;
-	
-	for(index_t i = 0; i < stats->count; i++)
-	{
-		distance_t tmp_c = cr[i] - stats->coreDistanceValues.mean;
-		stats->coreDistanceValues.variance += (distance_t)(tmp_c * tmp_c);
-		sum_sc += (distance_t)pow(tmp_c, 3);
-		sum_dc +=(distance_t) pow(tmp_c, 4);
+		if(chunks[t].crMax > chunks[0].crMax){
+			chunks[0].crMax = chunks[t].crMax;
+		}
 
-		distance_t tmp_d = dr[i] - stats->intraDistanceValues.mean;
-		stats->intraDistanceValues.variance += (distance_t)(tmp_d * tmp_d);
-		sum_sd += (distance_t)pow(tmp_d, 3);
-		sum_dd += (distance_t)pow(tmp_d, 4);
+		if(chunks[t].drMax > chunks[0].drMax){
+			chunks[0].drMax = chunks[t].drMax;
+		}
 	}
 
-	stats->coreDistanceValues.variance = stats->coreDistanceValues.variance / (distance_t)(stats->count - 1);
-	stats->intraDistanceValues.variance = stats->intraDistanceValues.variance / (distance_t)(stats->count - 1);
+	hdbscan_stats_from_moments(&stats->coreDistanceValues, &chunks[0].cr);
+	hdbscan_stats_from_moments(&stats->intraDistanceValues, &chunks[0].dr);
+	stats->coreDistanceValues.max = chunks[0].crMax;
+	stats->intraDistanceValues.max = chunks[0].drMax;
 
-	stats->coreDistanceValues.standardDev = (distance_t)sqrt(stats->coreDistanceValues.variance);
-	stats->intraDistanceValues.standardDev = (distance_t)sqrt(stats->intraDistanceValues.variance);
-
-	hdbscan_skew_kurt_1(stats, sum_sc, sum_sd, sum_dc, sum_dd);	
+	if(chunks != &single){
+		hdbscan_free(chunks);
+	}
 }
 
 /**
@@ -1478,6 +3232,7 @@ void hdbscan_calculate_stats(hashtable* distanceMap, clustering_stats* stats){
 
 	distance_t cr[hashtable_size(distanceMap)];
 	distance_t dr[hashtable_size(distanceMap)];
+	label_t* keys = (label_t *)hashtable_keys(distanceMap)->data;
 	label_t key;
 	distance_values* dl = NULL;
 	
@@ -1486,7 +3241,7 @@ void hdbscan_calculate_stats(hashtable* distanceMap, clustering_stats* stats){
 	#endif
 	for(size_t i = 0; i < hashtable_size(distanceMap); i++)
 	{
-		key = ((label_t *)distanceMap->keys->data)[i];
+		key = keys[i];
 		hashtable_lookup(distanceMap, &key, &dl);
 		cr[i] = dl->max_cr/dl->min_cr;
 		dr[i] = dl->max_dr/dl->min_dr;
@@ -1497,7 +3252,7 @@ void hdbscan_calculate_stats(hashtable* distanceMap, clustering_stats* stats){
 
 	for(size_t i = 0; i < hashtable_size(distanceMap); i++)
 	{
-		key = ((label_t *)distanceMap->keys->data)[i];
+		key = keys[i];
 		hashtable_lookup(distanceMap, &key, &dl);
 		distance_t rc = cr[i];
 		distance_t rd = dr[i];
@@ -1507,6 +3262,49 @@ void hdbscan_calculate_stats(hashtable* distanceMap, clustering_stats* stats){
 	}
 }
 
+/**
+ * @brief 
+ * 
+ * @param values 
+ * @param numValues 
+ * @param stats 
+ * @return int 
+ */
+int hdbscan_calculate_values_stats(distance_values* values, index_t numValues, clustering_stats* stats){
+
+	stats->count = numValues;
+	if(numValues == 0){
+		return HDBSCAN_SUCCESS;
+	}
+
+	distance_t* cr = (distance_t *)hdbscan_malloc(2 * (size_t)numValues * sizeof(distance_t));
+	if(cr == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_calculate_values_stats - Could not allocate memory.\n");
+	#else
+		printf("FATAL: hdbscan_calculate_values_stats - Could not allocate memory.\n");
+	#endif
+
+		return HDBSCAN_ERROR;
+	}
+	distance_t* dr = cr + numValues;
+
+	for(index_t k = 0; k < numValues; k++){
+		cr[k] = values[k].max_cr/values[k].min_cr;
+		dr[k] = values[k].max_dr/values[k].min_dr;
+	}
+
+	hdbscan_calculate_stats_helper(cr, dr, stats);
+
+	for(index_t k = 0; k < numValues; k++){
+		values[k].cr_confidence = ((stats->coreDistanceValues.max - cr[k]) / stats->coreDistanceValues.max) * 100;
+		values[k].dr_confidence = ((stats->intraDistanceValues.max - dr[k]) / stats->intraDistanceValues.max) * 100;
+	}
+
+	hdbscan_free(cr);
+	return HDBSCAN_SUCCESS;
+}
+
 /**
  * @brief 
  * 
@@ -1659,10 +3457,11 @@ ArrayList* hdbscan_sort_by_similarity(hashtable* distanceMap, ArrayList *cluster
 
 		label_t key;
 		distance_values* dv = NULL;
+		label_t* keys = (label_t *)hashtable_keys(distanceMap)->data;
 		
 		for(size_t i = 0; i < hashtable_size(distanceMap); i++)
 		{
-			key = ((label_t *)distanceMap->keys->data)[i];
+			key = keys[i];
 			hashtable_lookup(distanceMap, &key, &dv);
 		
 			array_list_append(clusters, &key);
@@ -1688,7 +3487,7 @@ ArrayList* hdbscan_sort_by_similarity(hashtable* distanceMap, ArrayList *cluster
 #pragma omp parallel for private(key, dv, conf)
 #endif
 		for(size_t i = 0; i < clusters->size; i++){
-			key = ((label_t *)distanceMap->keys->data)[i];			
+			key = ((label_t *)clusters->data)[i];
 			hashtable_lookup(distanceMap, &key, &dv);
 			
 			if(distanceType == CORE_DISTANCE_TYPE){
@@ -1744,10 +3543,11 @@ ArrayList* hdbscan_sort_by_length(hashtable* clusterTable, ArrayList *clusters){
 
 	if(size == 0){     /// If clusters had nothing in it, we will use the whole hash table
 		label_t key;
+		label_t* keys = (label_t *)hashtable_keys(clusterTable)->data;
 		for(size_t i = 0; i < hashtable_size(clusterTable); i++)
 		{
 			ArrayList *lst = NULL;
-			key = ((label_t *)clusterTable->keys)[i];
+			key = keys[i];
 			hashtable_lookup(clusterTable, &key, &lst);
 			array_list_append(clusters, &key);
 			distance_t tmp = (distance_t)lst->size;
@@ -1775,6 +3575,151 @@ ArrayList* hdbscan_sort_by_length(hashtable* clusterTable, ArrayList *clusters){
 	return clusters;
 }
 
+/**
+ * @brief Sort clusters on the lengths of their members in cm when values is NULL,
+ * otherwise on their confidences in values.
+ * 
+ * @param cm 
+ * @param values 
+ * @param clusters 
+ * @param distanceType 
+ * @return ArrayList* 
+ */
+static ArrayList* hdbscan_cluster_members_sort(cluster_members* cm, distance_values* values, ArrayList *clusters, int32_t distanceType){
+
+	if(clusters == NULL){
+		clusters = array_list_init(cm->numClusters > 0 ? cm->numClusters : 1, sizeof(label_t), NULL);
+
+		if(clusters == NULL){
+		#ifdef DEBUG
+			logger_write(FATAL, "hdbscan_cluster_members_sort - Could not allocate memory for the clusters.\n");
+		#else
+			printf("FATAL: hdbscan_cluster_members_sort - Could not allocate memory for the clusters.\n");
+		#endif
+
+			return NULL;
+		}
+
+		if(sizeof(label_t) == sizeof(int)) {
+			clusters->compare = int_compare;
+		} else if(sizeof(label_t) == sizeof(long)) {
+			clusters->compare = long_compare;
+		} else {
+			clusters->compare = short_compare;
+		}
+	}
+
+	if(clusters->size == 0){     /// If clusters had nothing in it, we will use the whole index
+		for(index_t k = 0; k < cm->numClusters; k++){
+			array_list_append(clusters, cm->labels + k);
+		}
+
+		if(clusters->size == 0){
+			return clusters;
+		}
+	}
+
+	//The position of every label in cm, labels that are not in cm get numClusters
+	label_t maxLabel = 0;
+	for(index_t k = 0; k < cm->numClusters; k++){
+		if(cm->labels[k] > maxLabel){
+			maxLabel = cm->labels[k];
+		}
+	}
+
+	index_t* position = (index_t *)hdbscan_malloc(((size_t)maxLabel + 1) * sizeof(index_t));
+	ArrayList *sortData = array_list_init(clusters->size, sizeof(distance_t), NULL);
+
+	if(position == NULL || sortData == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "hdbscan_cluster_members_sort - Could not allocate memory for the sort keys.\n");
+	#else
+		printf("FATAL: hdbscan_cluster_members_sort - Could not allocate memory for the sort keys.\n");
+	#endif
+
+		hdbscan_free(position);
+		if(sortData != NULL){
+			array_list_delete(sortData);
+		}
+		return NULL;
+	}
+
+	if(sizeof(distance_t) == sizeof(double)) {
+		sortData->compare = double_compare;
+	} else {
+		sortData->compare = float_compare;
+	}
+
+	for(label_t l = 0; l <= maxLabel; l++){
+		position[l] = cm->numClusters;
+	}
+
+	for(index_t k = 0; k < cm->numClusters; k++){
+		position[cm->labels[k]] = k;
+	}
+
+	label_t *data = (label_t *)clusters->data;
+	distance_t *keys = (distance_t *)sortData->data;
+	sortData->size = clusters->size;
+
+	for(size_t i = 0; i < clusters->size; i++){
+		index_t k = data[i] <= maxLabel ? position[data[i]] : cm->numClusters;
+
+		if(k == cm->numClusters){
+		#ifdef DEBUG
+			logger_write(ERROR, "hdbscan_cluster_members_sort - A cluster is not in the membership index.\n");
+		#else
+			printf("ERROR: hdbscan_cluster_members_sort - A cluster is not in the membership index.\n");
+		#endif
+
+			hdbscan_free(position);
+			array_list_delete(sortData);
+			return NULL;
+		}
+
+		if(values == NULL){
+			keys[i] = (distance_t)(cm->offsets[k + 1] - cm->offsets[k]);
+		} else if(distanceType == CORE_DISTANCE_TYPE){
+			keys[i] = values[k].cr_confidence;
+		} else{
+			keys[i] = values[k].dr_confidence;
+		}
+	}
+
+	// sort
+	hdbscan_quicksort(clusters, sortData, 0, (int32_t)(clusters->size-1));
+	hdbscan_free(position);
+	array_list_delete(sortData);
+
+	return clusters;
+}
+
+/**
+ * @brief 
+ * 
+ * @param cm 
+ * @param values 
+ * @param clusters 
+ * @param distanceType 
+ * @return ArrayList* 
+ */
+ArrayList* hdbscan_cluster_members_sort_by_similarity(cluster_members* cm, distance_values* values, ArrayList *clusters, int32_t distanceType){
+	assert(cm != NULL && values != NULL);
+	return hdbscan_cluster_members_sort(cm, values, clusters, distanceType);
+}
+
+/**
+ * @brief 
+ * 
+ * @param cm 
+ * @param clusters 
+ * @return ArrayList* 
+ */
+ArrayList* hdbscan_cluster_members_sort_by_length(cluster_members* cm, ArrayList *clusters){
+	assert(cm != NULL);
+	return hdbscan_cluster_members_sort(cm, NULL, clusters, INTRA_DISTANCE_TYPE);
+}
+
 /**
  * @brief Destroys the cluster table
  * 
@@ -1797,11 +3742,12 @@ void hdbscan_print_cluster_map(hashtable* table){
 	assert(table != NULL);
 
 	label_t key;
+	label_t* keys = (label_t *)hashtable_keys(table)->data;
 	ArrayList *clusterList = NULL;
 	for(index_t i = 0; i < hashtable_size(table); i++)
 	{
 		
-		key = ((label_t *)table->keys->data)[i];
+		key = keys[i];
 		hashtable_lookup(table, &key, &clusterList);
 		
 		sprintf(s, "%d -> [", key);
@@ -1828,12 +3774,13 @@ void hdbscan_print_cluster_sizes(hashtable* table){
 
 	assert(table != NULL);
 	label_t key;
+	label_t* keys = (label_t *)hashtable_keys(table)->data;
 	ArrayList *clusterList = NULL;
 	char s[50];
 
 	for(size_t i = 0; i < hashtable_size(table); i++)
 	{	
-		key = ((label_t *)table->keys->data)[i];
+		key = keys[i];
 		hashtable_lookup(table, &key, &clusterList);
 		sprintf(s, "%d : %ld\n", key, clusterList->size);
 		logger_write(NONE, s);
@@ -1856,16 +3803,14 @@ void hdbscan_print_hierarchies(hashtable* hierarchy, index_t numPoints, char *fi
 	if(filename != NULL){
 
 		char visFilename[300];
-		strcat(visFilename, filename);
-		strcat(visFilename, "_visualization.vis");
+		snprintf(visFilename, sizeof(visFilename), "%s_visualization.vis", filename);
 		visFile = fopen(visFilename, "w");
 		fprintf(visFile, "1\n");
 		fprintf(visFile, "%ld\n", hashtable_size(hierarchy));
 		fclose(visFile);
 
-		char hierarchyFilename[100];
-		strcat(hierarchyFilename, filename);
-		strcat(hierarchyFilename, "_hierarchy.csv");
+		char hierarchyFilename[300];
+		snprintf(hierarchyFilename, sizeof(hierarchyFilename), "%s_hierarchy.csv", filename);
 		hierarchyFile = fopen(hierarchyFilename, "w");
 	}
 	
@@ -1874,10 +3819,11 @@ void hdbscan_print_hierarchies(hashtable* hierarchy, index_t numPoints, char *fi
 	sprintf(s, "hierarchy size = %ld\n", hashtable_size(hierarchy));
 	logger_write(INFO, s);
 	
-	for(size_t i = 0; i < set_size(hierarchy->keys); i++){
+	set_t* levels = hashtable_keys(hierarchy);
+	for(size_t i = 0; i < set_size(levels); i++){
 		int64_t level;
 		hierarchy_entry* data;
-		set_value_at(hierarchy->keys, i, &level);
+		set_value_at(levels, i, &level);
         hashtable_lookup(hierarchy, &level, &data);
 
 		if(hierarchyFile){
@@ -1937,7 +3883,7 @@ void hdbscan_print_distance_map(hashtable* distancesMap){
 	{
 		label_t key;
 		distance_values* dv = NULL;
-		set_value_at(distancesMap->keys, i, &key);
+		set_value_at(hashtable_keys(distancesMap), i, &key);
 		hashtable_lookup(distancesMap, &key, &dv);
 		sprintf(s, "%d -> {\n", key);
 		sprintf(s + strlen(s), "\tmin_cr : %f, max_cr : %f, cr_confidence : %f\n", dv->min_cr, dv->max_cr, dv->cr_confidence);
@@ -1988,7 +3934,7 @@ void hdbscan_destroy_hierarchical_entry(hierarchy_entry* entry)
 {
 	if(entry)
 	{
-		free(entry->labels);
-		free(entry);
+		hdbscan_free(entry->labels);
+		hdbscan_free(entry);
 	}
 }
\ No newline at end of file
@@ -40,6 +40,7 @@
  */
 #ifdef __cplusplus
 #include <limits>
+#include <algorithm>
 #include "hdbscan/hdbscan.hpp"
 namespace clustering {
 
@@ -52,6 +53,11 @@ hdbscan::hdbscan(index_t minPts){
 	hdbscan_init(this, minPts);
 }
 
+hdbscan::hdbscan(index_t minPts, index_t minClusterSize){
+	hdbscan_init(this, minPts);
+	this->minClusterSize = minClusterSize;
+}
+
 hdbscan::~hdbscan(){
 	hdbscan_clean(this);
 }
@@ -68,6 +74,57 @@ void hdbscan::reRun(index_t minPts){
 	hdbscan_rerun(this, minPts);
 }
 
+void hdbscan::reSelect(index_t minClusterSize){
+	hdbscan_reselect(this, minClusterSize);
+}
+
+void hdbscan::selectClusters(SELECTION_METHOD method, distance_t epsilon){
+	hdbscan_select_clusters(this, method, epsilon);
+}
+
+void hdbscan::cutTree(distance_t cutDistance, label_t* labels){
+	hdbscan_cut_tree(this, cutDistance, labels);
+}
+
+void hdbscan::approximatePredict(void* newPoints, index_t m, label_t* labels, distance_t* probabilities){
+	hdbscan_approximate_predict(this, newPoints, m, labels, probabilities);
+}
+
+index_t hdbscan::selectedClusters(label_t* clusters){
+	return hdbscan_selected_clusters(this, clusters);
+}
+
+void hdbscan::membershipVectors(distance_t* memberships){
+	hdbscan_membership_vectors(this, memberships);
+}
+
+index_t hdbscan::topOutliers(index_t k, outlier_score* top){
+	return hdbscan_top_outliers(this, k, top);
+}
+
+distance_t hdbscan::dbcv(distance_t* clusterValidity){
+	distance_t validity = 0;
+	hdbscan_dbcv(this, &validity, clusterValidity);
+
+	return validity;
+}
+
+void hdbscan::enableProfile(boolean enabled){
+	hdbscan_enable_profile(this, enabled);
+}
+
+void hdbscan::enablePrediction(boolean enabled){
+	hdbscan_enable_prediction(this, enabled);
+}
+
+void hdbscan::setProgressCallback(progress_callback callback, void* data){
+	hdbscan_set_progress_callback(this, callback, data);
+}
+
+void hdbscan::cancel(){
+	hdbscan_cancel(this);
+}
+
 void hdbscan::computeHierarchyAndClusterTree(boolean compactHierarchy, distance_t* pointNoiseLevels, label_t* pointLastClusters){
 	hdbscan_compute_hierarchy_and_cluster_tree(this, compactHierarchy, pointNoiseLevels, pointLastClusters);
 }
@@ -88,66 +145,83 @@ void hdbscan::clean(){
 	hdbscan_destroy(this);
 }
 
+ClusterMembers::ClusterMembers(label_t* labels, index_t begin, index_t end){
+	hdbscan_create_cluster_members(&cm, labels, begin, end);
+}
+
+ClusterMembers::ClusterMembers(ClusterMembers&& other){
+	cm = other.cm;
+	other.cm.numClusters = 0;
+	other.cm.labels = NULL;
+	other.cm.offsets = NULL;
+	other.cm.members = NULL;
+}
+
+ClusterMembers::~ClusterMembers(){
+	hdbscan_cluster_members_clean(&cm);
+}
+
 map_t createClusterMap(label_t* labels, index_t begin, index_t end){
 
 	map_t clusterTable;
+	ClusterMembers members(labels, begin, end);
 
-	for(index_t i = begin; i < end; i++){
-		label_t label = labels[i];
-		clusterTable[label].push_back(i);
+	for(index_t k = 0; k < members.size(); k++){
+		MemberSpan span = members.members(k);
+		clusterTable[members.label(k)].assign(span.begin(), span.end());
 	}
 
 	return clusterTable;
 }
 
+map<label_t, distance_values> getMinMaxDistances(hdbscan& scan, ClusterMembers& members){
+	map<label_t, distance_values> pm;
+	vector<distance_values> values(members.size());
+
+	hdbscan_cluster_members_min_max(&scan, members.data(), values.data());
+	for(index_t k = 0; k < members.size(); k++){
+		pm[members.label(k)] = values[k];
+	}
+
+	return pm;
+}
+
 map<label_t, distance_values> getMinMaxDistances(hdbscan& scan, map_t& clusterTable){
-	distance_t* core = scan.distanceFunction.coreDistances;
 	map<label_t, distance_values> pm;
-	distance_t zero = 0.0000000000000000000;
 
+	// Flatten the table into a membership index, reading the vectors by reference
+	index_t numMembers = 0;
 	for(map_t::iterator it = clusterTable.begin(); it != clusterTable.end(); ++it){
-		vector<index_t> idxList = it->second;
-		for(size_t i = 0; i < idxList.size(); i++){
-			map<label_t, distance_values>::iterator iter = pm.find(it->first);
-			index_t index = idxList[i];
-
-			// min and max core distances
-			if(iter == pm.end()){
-				distance_values& dl = pm[it->first];
-				dl.min_cr = core[index];
-				dl.max_cr = core[index];
-				dl.cr_confidence = 0.0;
-
-				dl.min_dr = std::numeric_limits<distance_t>::max();
-				dl.max_dr = std::numeric_limits<distance_t>::min();
-				dl.dr_confidence = 0.0;
-				iter = pm.find(it->first);
-			} else{
-				distance_values& dl = iter->second;
-				// min core distance
-				if(dl.min_cr > core[index] && (core[index] < zero || core[index] > zero)){
-					dl.min_cr = core[index];
-				}
-
-				//max core distance
-				if(dl.max_cr < core[index]){
-					dl.max_cr = core[index];
-				}
-			}
+		numMembers = (index_t)(numMembers + it->second.size());
+	}
+
+	vector<label_t> labels;
+	vector<index_t> offsets;
+	vector<index_t> members;
+	labels.reserve(clusterTable.size());
+	offsets.reserve(clusterTable.size() + 1);
+	members.reserve(numMembers);
+
+	offsets.push_back(0);
+	for(map_t::iterator it = clusterTable.begin(); it != clusterTable.end(); ++it){
+		const vector<index_t>& idxList = it->second;
+		labels.push_back(it->first);
+		members.insert(members.end(), idxList.begin(), idxList.end());
+		offsets.push_back((index_t)members.size());
+	}
 
-			// Calculating min and max distances
-			for(index_t j = (index_t)(i+1); j < idxList.size(); j++){
-				distance_t d = distance_get(&scan.distanceFunction, index, idxList[j]);
+	cluster_members cm;
+	cm.numClusters = (index_t)labels.size();
+	cm.labels = labels.data();
+	cm.offsets = offsets.data();
+	cm.members = members.data();
 
-				if(iter->second.min_dr > d && (d < zero || d > zero)){
-					iter->second.min_dr = d;
-				}
+	vector<distance_values> values(cm.numClusters);
+	hdbscan_cluster_members_min_max(&scan, &cm, values.data());
 
-				// max distance
-				if(iter->second.max_dr < d){
-					iter->second.max_dr = d;
-				}
-			}
+	for(index_t k = 0; k < cm.numClusters; k++){
+		if(offsets[k + 1] > offsets[k]){
+			pm[labels[k]] = values[k];
 		}
 	}
 
@@ -187,6 +261,33 @@ int32_t analyseStats(clustering_stats& stats){
 	return hdbscan_analyse_stats(&stats);
 }
 
+map<string, phase_profile> getProfile(hdbscan& scan){
+	map<string, phase_profile> profile;
+
+	for(int phase = 0; phase < HDBSCAN_NUM_PHASES; phase++){
+		profile[profile_phase_name((HDBSCAN_PHASE)phase)] = scan.profile.phases[phase];
+	}
+
+	return profile;
+}
+
+int32_t selectMinPts(int32_t min, int32_t max, void* dataset, index_t rows, index_t cols, int32_t datatype, map<int32_t, distance_t>& selection, int32_t& val, int32_t& numClusters){
+
+	hashtable* table = hashtable_init(16, H_INT, H_DOUBLE, int_compare);
+	int32_t err = hdbscan_select_min_pts(min, max, dataset, rows, cols, datatype, table, &val, &numClusters);
+
+	int32_t* keys = (int32_t *)hashtable_keys(table)->data;
+	for(size_t i = 0; i < hashtable_size(table); i++){
+		distance_t score;
+		hashtable_lookup(table, keys + i, &score);
+		selection[keys[i]] = score;
+	}
+
+	hashtable_destroy(table, NULL, NULL);
+
+	return err;
+}
+
 
 void printClusterMap(map_t& table){
 
@@ -312,6 +413,41 @@ void sortByLength(map_t& clusterTable, vector<label_t>& clusters)
 	quickSort(clusters, lengths, 0, (index_t)(clusters.size()-1));
 }
 
+/**
+ * \brief Sorts clusters according to how long the clusters are.
+ * 
+ * \param members 
+ * \param clusters
+ */
+void sortByLength(ClusterMembers& members, vector<label_t>& clusters)
+{
+	vector<distance_t> lengths;
+
+	if(clusters.empty()){     /// If clusters had nothing in it, we will use the whole index
+
+		for(index_t k = 0; k < members.size(); k++)
+		{
+			clusters.push_back(members.label(k));
+			lengths.push_back((distance_t)members.members(k).size());
+		}
+	} else { /// else we just need to get the lengths from the index
+		lengths.resize(clusters.size());
+
+		#ifdef _OPENMP
+		#pragma omp parallel for
+		#endif
+		for(size_t i = 0; i < clusters.size(); i++){
+			cluster_members* cm = members.data();
+			label_t* found = std::lower_bound(cm->labels, cm->labels + cm->numClusters, clusters[i]);
+			index_t k = (index_t)(found - cm->labels);
+
+			lengths[i] = (distance_t)members.members(k).size();
+		}
+	}
+	// sort
+	quickSort(clusters, lengths, 0, (index_t)(clusters.size()-1));
+}
+
 /**
  * Uses quick sort algorithm to sort clusters based on the data
  */
@@ -0,0 +1,154 @@
+/*
+ * moments.c
+ *
+ * Copyright 2024 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file moments.c
+ * 
+ * @brief Implementation of the functions in moments.h
+ * 
+ * The update, merge and subtract formulas are the pairwise formulas of
+ * Terriberry and Pébay for the central moments of the union of two sets.
+ */
+#include "hdbscan/moments.h"
+#include "hdbscan/allocator.h"
+#include <stdio.h>
+#ifdef DEBUG
+#include "hdbscan/logger.h"
+#endif
+
+moments* moments_init(moments* m){
+	if(m == NULL)
+		m = (moments*)hdbscan_malloc(sizeof(moments));
+
+	if(m == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "moments_init - Could not allocate memory for moments\n");
+	#else
+		printf("FATAL: moments_init - Could not allocate memory for moments\n");
+	#endif
+	} else{
+		m->count = 0;
+		m->mean = 0;
+		m->m2 = 0;
+		m->m3 = 0;
+		m->m4 = 0;
+	}
+
+	return m;
+}
+
+void moments_add(moments* m, distance_t x){
+	distance_t n1 = (distance_t)m->count;
+	m->count++;
+	distance_t n = (distance_t)m->count;
+
+	distance_t delta = x - m->mean;
+	distance_t deltaN = delta / n;
+	distance_t deltaN2 = deltaN * deltaN;
+	distance_t term1 = delta * deltaN * n1;
+
+	m->mean += deltaN;
+	m->m4 += term1 * deltaN2 * (n * n - 3 * n + 3) + 6 * deltaN2 * m->m2 - 4 * deltaN * m->m3;
+	m->m3 += term1 * deltaN * (n - 2) - 3 * deltaN * m->m2;
+	m->m2 += term1;
+}
+
+void moments_remove(moments* m, distance_t x){
+	moments b;
+	moments_init(&b);
+	moments_add(&b, x);
+	moments_subtract(m, &b);
+}
+
+void moments_merge(moments* a, const moments* b){
+	if(b->count == 0){
+		return;
+	}
+
+	if(a->count == 0){
+		*a = *b;
+		return;
+	}
+
+	distance_t na = (distance_t)a->count;
+	distance_t nb = (distance_t)b->count;
+	distance_t n = na + nb;
+	distance_t delta = b->mean - a->mean;
+	distance_t delta2 = delta * delta;
+
+	distance_t m2 = a->m2 + b->m2 + delta2 * na * nb / n;
+	distance_t m3 = a->m3 + b->m3 + delta2 * delta * na * nb * (na - nb) / (n * n)
+				+ 3 * delta * (na * b->m2 - nb * a->m2) / n;
+	distance_t m4 = a->m4 + b->m4 + delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+				+ 6 * delta2 * (na * na * b->m2 + nb * nb * a->m2) / (n * n)
+				+ 4 * delta * (na * b->m3 - nb * a->m3) / n;
+
+	a->count = (index_t)(a->count + b->count);
+	a->mean += delta * nb / n;
+	a->m2 = m2;
+	a->m3 = m3;
+	a->m4 = m4;
+}
+
+void moments_subtract(moments* a, const moments* b){
+	if(b->count == 0){
+		return;
+	}
+
+	if(b->count >= a->count){
+		moments_init(a);
+		return;
+	}
+
+	//Solve the merge formulas for the moments of the remaining values
+	distance_t n = (distance_t)a->count;
+	distance_t nb = (distance_t)b->count;
+	distance_t na = n - nb;
+	distance_t mean = (n * a->mean - nb * b->mean) / na;
+	distance_t delta = b->mean - mean;
+	distance_t delta2 = delta * delta;
+
+	distance_t m2 = a->m2 - b->m2 - delta2 * na * nb / n;
+	distance_t m3 = a->m3 - b->m3 - delta2 * delta * na * nb * (na - nb) / (n * n)
+				- 3 * delta * (na * b->m2 - nb * m2) / n;
+	distance_t m4 = a->m4 - b->m4 - delta2 * delta2 * na * nb * (na * na - na * nb + nb * nb) / (n * n * n)
+				- 6 * delta2 * (na * na * b->m2 + nb * nb * m2) / (n * n)
+				- 4 * delta * (na * b->m3 - nb * m3) / n;
+
+	a->count = (index_t)(a->count - b->count);
+	a->mean = mean;
+	a->m2 = m2;
+	a->m3 = m3;
+	a->m4 = m4;
+}
+
+distance_t moments_variance(const moments* m){
+	if(m->count < 2){
+		return 0;
+	}
+
+	return m->m2 / (distance_t)(m->count - 1);
+}
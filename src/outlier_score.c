@@ -41,7 +41,7 @@
 
 outlier_score* create_outlier_score(outlier_score* os, distance_t score, distance_t coreDistance, index_t id){
 	if(os == NULL)
-		os = (outlier_score*)malloc(sizeof(outlier_score));
+		os = (outlier_score*)hdbscan_malloc(sizeof(outlier_score));
 
 	if(os == NULL){
 	#ifdef DEBUG
@@ -58,7 +58,7 @@ outlier_score* create_outlier_score(outlier_score* os, distance_t score, distanc
 	return os;
 }
 void destroy_outlier_score(outlier_score* os){
-	free(os);
+	hdbscan_free(os);
 }
 
 int outlier_score_compare(const void* score1, const void* score2){
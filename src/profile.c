@@ -0,0 +1,93 @@
+/*
+ * profile.c
+ *
+ * Copyright 2024 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file profile.c
+ * 
+ * @brief Implementation of the functions in profile.h
+ */
+#include "hdbscan/profile.h"
+#include "hdbscan/allocator.h"
+#include <string.h>
+#include <time.h>
+
+static const char* phase_names[HDBSCAN_NUM_PHASES] = {
+	"distances", "mst", "sort", "hierarchy", "propagation", "outlier_scores"
+};
+
+static double profile_clock(clockid_t clock){
+	struct timespec ts;
+	clock_gettime(clock, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void profile_init(hdbscan_profile* profile){
+	profile->enabled = FALSE;
+	profile_reset(profile);
+}
+
+void profile_reset(hdbscan_profile* profile){
+	memset(profile->phases, 0, sizeof(profile->phases));
+}
+
+void profile_begin(hdbscan_profile* profile, profile_mark* mark){
+	if(!profile->enabled){
+		/// A negative time tells profile_end that the phase is not being timed
+		mark->wallTime = -1.0;
+		return;
+	}
+
+	hdbscan_memory_track_begin();
+	hdbscan_memory_reset_peak();
+	mark->bytesAllocated = hdbscan_memory_allocated();
+	mark->liveBytes = hdbscan_memory_live();
+	mark->cpuTime = profile_clock(CLOCK_PROCESS_CPUTIME_ID);
+	mark->wallTime = profile_clock(CLOCK_MONOTONIC);
+}
+
+void profile_end(hdbscan_profile* profile, HDBSCAN_PHASE phase, profile_mark* mark){
+	if(mark->wallTime < 0){
+		return;
+	}
+
+	phase_profile* p = profile->phases + phase;
+	p->wallTime += profile_clock(CLOCK_MONOTONIC) - mark->wallTime;
+	p->cpuTime += profile_clock(CLOCK_PROCESS_CPUTIME_ID) - mark->cpuTime;
+	p->bytesAllocated += hdbscan_memory_allocated() - mark->bytesAllocated;
+
+	size_t peak = hdbscan_memory_peak();
+	if(peak > mark->liveBytes && peak - mark->liveBytes > p->peakBytes){
+		p->peakBytes = peak - mark->liveBytes;
+	}
+
+	p->calls++;
+	hdbscan_memory_track_end();
+}
+
+const char* profile_phase_name(HDBSCAN_PHASE phase){
+	return phase < HDBSCAN_NUM_PHASES ? phase_names[phase] : NULL;
+}
@@ -0,0 +1,85 @@
+/*
+ * progress.c
+ *
+ * Copyright 2024 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file progress.c
+ * 
+ * @brief Implementation of the functions in progress.h
+ */
+#include "hdbscan/progress.h"
+#include <time.h>
+
+static double progress_clock(){
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return (double)ts.tv_sec + (double)ts.tv_nsec * 1e-9;
+}
+
+void progress_init(progress* p){
+	p->callback = NULL;
+	p->data = NULL;
+	p->lastReport = 0;
+	p->cancelled = 0;
+}
+
+void progress_set_callback(progress* p, progress_callback callback, void* data){
+	p->callback = callback;
+	p->data = data;
+}
+
+void progress_start(progress* p){
+	p->lastReport = progress_clock();
+	__atomic_store_n(&p->cancelled, 0, __ATOMIC_RELAXED);
+}
+
+void progress_cancel(progress* p){
+	__atomic_store_n(&p->cancelled, 1, __ATOMIC_RELAXED);
+}
+
+int progress_cancelled(progress* p){
+	return p != NULL && __atomic_load_n(&p->cancelled, __ATOMIC_RELAXED);
+}
+
+int progress_report(progress* p, HDBSCAN_PHASE phase, double fraction){
+	if(p == NULL){
+		return 0;
+	}
+
+	if(p->callback != NULL && !progress_cancelled(p)){
+		double now = progress_clock();
+
+		if(fraction >= 1.0 || now - p->lastReport >= PROGRESS_INTERVAL){
+			p->lastReport = now;
+
+			if(p->callback(phase, fraction, p->data) == PROGRESS_CANCEL){
+				progress_cancel(p);
+			}
+		}
+	}
+
+	return progress_cancelled(p);
+}
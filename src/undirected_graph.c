@@ -45,7 +45,7 @@
 
 UndirectedGraph* graph_init(UndirectedGraph* g, index_t numVertices, ArrayList* verticesA, ArrayList* verticesB, ArrayList* edgeWeights) {
 	if(g == NULL)
-		g = (UndirectedGraph*)malloc(sizeof(UndirectedGraph));
+		g = (UndirectedGraph*)hdbscan_malloc(sizeof(UndirectedGraph));
 
 	if(g == NULL){
 	#ifdef DEBUG
@@ -60,7 +60,11 @@ UndirectedGraph* graph_init(UndirectedGraph* g, index_t numVertices, ArrayList*
 	g->verticesA = verticesA;
 	g->verticesB = verticesB;
 	g->edgeWeights = edgeWeights;
-	g->edges = (ArrayList**) malloc(numVertices * sizeof(ArrayList*));
+	g->csr = FALSE;
+	g->adjOffsets = NULL;
+	g->adjSizes = NULL;
+	g->adjacency = NULL;
+	g->edges = (ArrayList**) hdbscan_malloc(numVertices * sizeof(ArrayList*));
 
 	if(g->edges == NULL){
 
@@ -88,22 +92,163 @@ UndirectedGraph* graph_init(UndirectedGraph* g, index_t numVertices, ArrayList*
 	index_t vertexOne, vertexTwo;
 	for (index_t i = 0; i < g->verticesA->size; i++) {
 		
-		array_list_value_at(g->verticesA, i, &vertexOne);
-		array_list_value_at(g->verticesB, i, &vertexTwo);
+		vertexOne = index_list_at(g->verticesA, i);
+		vertexTwo = index_list_at(g->verticesB, i);
 
-		array_list_append(g->edges[vertexOne], &vertexTwo);
+		index_list_append(g->edges[vertexOne], vertexTwo);
 		if (vertexOne != vertexTwo) {
-			array_list_append(g->edges[vertexTwo], &vertexOne);
+			index_list_append(g->edges[vertexTwo], vertexOne);
 		}
 	}
 
 	return g;
 }
 
+UndirectedGraph* graph_init_csr(UndirectedGraph* g, index_t numVertices, ArrayList* verticesA, ArrayList* verticesB, ArrayList* edgeWeights) {
+	boolean owned = FALSE;
+	if(g == NULL){
+		g = (UndirectedGraph*)hdbscan_malloc(sizeof(UndirectedGraph));
+		owned = TRUE;
+	}
+
+	if(g == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "graph_init_csr - Could not allocate memory for graph.");
+	#else
+		printf("FATAL: graph_init_csr - Could not allocate memory for graph.");
+	#endif
+		return NULL;
+	}
+
+	g->numVertices = numVertices;
+	g->verticesA = verticesA;
+	g->verticesB = verticesB;
+	g->edgeWeights = edgeWeights;
+	g->edges = NULL;
+	g->csr = TRUE;
+
+	size_t numEdges = verticesA->size;
+
+	g->adjOffsets = (size_t *)hdbscan_malloc((numVertices + 1) * sizeof(size_t));
+	g->adjSizes = (index_t *)hdbscan_calloc(numVertices, sizeof(index_t));
+	g->adjacency = (index_t *)hdbscan_malloc((2 * numEdges + 1) * sizeof(index_t));
+
+	if(g->adjOffsets == NULL || g->adjSizes == NULL || g->adjacency == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "graph_init_csr - Could not allocate memory for adjacency.");
+	#else
+		printf("FATAL: graph_init_csr - Could not allocate memory for adjacency.");
+	#endif
+		hdbscan_free(g->adjOffsets);
+		hdbscan_free(g->adjSizes);
+		hdbscan_free(g->adjacency);
+		g->adjOffsets = NULL;
+		g->adjSizes = NULL;
+		g->adjacency = NULL;
+
+		if(owned == TRUE){
+			hdbscan_free(g);
+		}
+		return NULL;
+	}
+
+	graph_reset_edges(g);
+
+	return g;
+}
+
+int graph_reset_edges(UndirectedGraph* g) {
+	if(g->csr == FALSE){
+		return GRAPH_ERROR;
+	}
+
+	index_t numVertices = g->numVertices;
+	size_t numEdges = g->verticesA->size;
+	index_t* da = (index_t *)g->verticesA->data;
+	index_t* db = (index_t *)g->verticesB->data;
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(index_t v = 0; v < numVertices; v++){
+		g->adjSizes[v] = 0;
+	}
+
+	// Count the degree of each vertex. Self edges are only counted once.
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(size_t i = 0; i < numEdges; i++){
+		index_t vertexOne = da[i];
+		index_t vertexTwo = db[i];
+
+	#ifdef _OPENMP
+	#pragma omp atomic
+	#endif
+		g->adjSizes[vertexOne]++;
+
+		if(vertexOne != vertexTwo){
+		#ifdef _OPENMP
+		#pragma omp atomic
+		#endif
+			g->adjSizes[vertexTwo]++;
+		}
+	}
+
+	g->adjOffsets[0] = 0;
+	for(index_t v = 0; v < numVertices; v++){
+		g->adjOffsets[v + 1] = g->adjOffsets[v] + g->adjSizes[v];
+		g->adjSizes[v] = 0;
+	}
+
+	// Scatter the neighbours into their slots, using adjSizes as the cursors.
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(size_t i = 0; i < numEdges; i++){
+		index_t vertexOne = da[i];
+		index_t vertexTwo = db[i];
+		index_t slot;
+
+	#ifdef _OPENMP
+	#pragma omp atomic capture
+	#endif
+		slot = g->adjSizes[vertexOne]++;
+		g->adjacency[g->adjOffsets[vertexOne] + slot] = vertexTwo;
+
+		if(vertexOne != vertexTwo){
+		#ifdef _OPENMP
+		#pragma omp atomic capture
+		#endif
+			slot = g->adjSizes[vertexTwo]++;
+			g->adjacency[g->adjOffsets[vertexTwo] + slot] = vertexOne;
+		}
+	}
+
+	// The scatter order depends on the thread schedule, so sort each (short) neighbour list.
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(index_t v = 0; v < numVertices; v++){
+		index_t* nb = g->adjacency + g->adjOffsets[v];
+		for(index_t j = 1; j < g->adjSizes[v]; j++){
+			index_t x = nb[j];
+			index_t k = j;
+			while(k > 0 && nb[k - 1] > x){
+				nb[k] = nb[k - 1];
+				k--;
+			}
+			nb[k] = x;
+		}
+	}
+
+	return GRAPH_SUCCESS;
+}
+
 void graph_destroy(UndirectedGraph* g) {
 	if(g != NULL){
 		graph_clean(g);
-		free(g);
+		hdbscan_free(g);
 	}
 
 }
@@ -131,9 +276,18 @@ void graph_clean(UndirectedGraph* g) {
 				ArrayList* list = g->edges[i];
 				array_list_delete(list);
 			}
-			free(g->edges);
+			hdbscan_free(g->edges);
 			g->edges = NULL;
 		}
+
+		if (g->csr == TRUE) {
+			hdbscan_free(g->adjOffsets);
+			hdbscan_free(g->adjSizes);
+			hdbscan_free(g->adjacency);
+			g->adjOffsets = NULL;
+			g->adjSizes = NULL;
+			g->adjacency = NULL;
+		}
 	}
 }
 
@@ -142,8 +296,19 @@ void graph_quicksort_by_edge_weight(UndirectedGraph* g) {
 	if (esize <= 1)
 		return;
 
-	index_t startIndexStack[esize/2];
-	index_t endIndexStack[esize/2];
+	index_t* startIndexStack = (index_t *)hdbscan_malloc((esize/2 + 1) * sizeof(index_t));
+	index_t* endIndexStack = (index_t *)hdbscan_malloc((esize/2 + 1) * sizeof(index_t));
+
+	if(startIndexStack == NULL || endIndexStack == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "graph_quicksort_by_edge_weight - Could not allocate memory for the index stacks.");
+	#else
+		printf("FATAL: graph_quicksort_by_edge_weight - Could not allocate memory for the index stacks.");
+	#endif
+		hdbscan_free(startIndexStack);
+		hdbscan_free(endIndexStack);
+		return;
+	}
 
 	(startIndexStack)[0] = 0;
 	(endIndexStack)[0] = (index_t)(esize - 1);
@@ -169,16 +334,190 @@ void graph_quicksort_by_edge_weight(UndirectedGraph* g) {
 			stackTop++;
 		}
 	}
+
+	hdbscan_free(startIndexStack);
+	hdbscan_free(endIndexStack);
+}
+
+/**
+ * @brief Map the bit pattern of an edge weight to an unsigned key with the same ordering.
+ * 
+ * Positive values get the sign bit set and negative values have all their bits flipped.
+ * 
+ * @param w 
+ * @return uint64_t 
+ */
+static inline uint64_t graph_edge_weight_key(distance_t w){
+	if(sizeof(distance_t) == sizeof(uint64_t)){
+		uint64_t key = 0;
+		memcpy(&key, &w, sizeof(distance_t));
+		return (key >> 63) ? ~key : (key | ((uint64_t)1 << 63));
+	}
+
+	uint32_t key = 0;
+	memcpy(&key, &w, sizeof(key));
+	key = (key >> 31) ? ~key : (key | ((uint32_t)1 << 31));
+	return (uint64_t)key;
+}
+
+void graph_radix_sort_by_edge_weight(UndirectedGraph* g) {
+	size_t esize = g->edgeWeights->size;
+	if (esize <= 1)
+		return;
+
+	distance_t* dt = g->edgeWeights->data;
+	index_t* da = g->verticesA->data;
+	index_t* db = g->verticesB->data;
+
+	int32_t maxThreads = 1;
+#ifdef _OPENMP
+	maxThreads = omp_get_max_threads();
+#endif
+
+	size_t tsize = sizeof(distance_t) > sizeof(index_t) ? sizeof(distance_t) : sizeof(index_t);
+	uint64_t* keys = (uint64_t *)hdbscan_malloc(2 * esize * sizeof(uint64_t));
+	index_t* indices = (index_t *)hdbscan_malloc(2 * esize * sizeof(index_t));
+	size_t* histograms = (size_t *)hdbscan_malloc((size_t)maxThreads * 256 * sizeof(size_t));
+	void* tmp = hdbscan_malloc(esize * tsize);
+
+	if(keys == NULL || indices == NULL || histograms == NULL || tmp == NULL){
+	#ifdef DEBUG
+		logger_write(ERROR, "graph_radix_sort_by_edge_weight - Could not allocate memory, falling back to quicksort.");
+	#else
+		printf("ERROR: graph_radix_sort_by_edge_weight - Could not allocate memory, falling back to quicksort.");
+	#endif
+		hdbscan_free(keys);
+		hdbscan_free(indices);
+		hdbscan_free(histograms);
+		hdbscan_free(tmp);
+		graph_quicksort_by_edge_weight(g);
+		return;
+	}
+
+	uint64_t* keysIn = keys;
+	uint64_t* keysOut = keys + esize;
+	index_t* indicesIn = indices;
+	index_t* indicesOut = indices + esize;
+	boolean skipPass = FALSE;
+
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		int32_t numThreads = 1;
+		int32_t thread = 0;
+	#ifdef _OPENMP
+		numThreads = omp_get_num_threads();
+		thread = omp_get_thread_num();
+	#endif
+
+		// Each thread owns a contiguous block so that the scatter is stable
+		size_t begin = esize * (size_t)thread / (size_t)numThreads;
+		size_t end = esize * (size_t)(thread + 1) / (size_t)numThreads;
+		size_t* histogram = histograms + (size_t)thread * 256;
+
+		for(size_t i = begin; i < end; i++){
+			keysIn[i] = graph_edge_weight_key(dt[i]);
+			indicesIn[i] = (index_t)i;
+		}
+
+		for(uint32_t shift = 0; shift < 8 * sizeof(distance_t); shift += 8){
+
+			memset(histogram, 0, 256 * sizeof(size_t));
+			for(size_t i = begin; i < end; i++){
+				histogram[(keysIn[i] >> shift) & 0xFF]++;
+			}
+
+		#ifdef _OPENMP
+		#pragma omp barrier
+		#pragma omp single
+		#endif
+			{
+				// Turn the counts into the starting position of each (digit, thread) block
+				size_t offset = 0;
+				skipPass = FALSE;
+				for(size_t d = 0; d < 256; d++){
+					size_t total = 0;
+					for(int32_t t = 0; t < numThreads; t++){
+						size_t count = histograms[(size_t)t * 256 + d];
+						histograms[(size_t)t * 256 + d] = offset;
+						offset += count;
+						total += count;
+					}
+
+					if(total == esize){
+						skipPass = TRUE;
+					}
+				}
+			}
+
+			if(skipPass){
+				continue;
+			}
+
+			for(size_t i = begin; i < end; i++){
+				size_t pos = histogram[(keysIn[i] >> shift) & 0xFF]++;
+				keysOut[pos] = keysIn[i];
+				indicesOut[pos] = indicesIn[i];
+			}
+
+		#ifdef _OPENMP
+		#pragma omp barrier
+		#pragma omp single
+		#endif
+			{
+				uint64_t* kt = keysIn;
+				keysIn = keysOut;
+				keysOut = kt;
+
+				index_t* it = indicesIn;
+				indicesIn = indicesOut;
+				indicesOut = it;
+			}
+		}
+	}
+
+	// Permute the three edge arrays through the sorted indices
+	distance_t* dtmp = (distance_t *)tmp;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(size_t i = 0; i < esize; i++){
+		dtmp[i] = dt[indicesIn[i]];
+	}
+	memcpy(dt, dtmp, esize * sizeof(distance_t));
+
+	index_t* itmp = (index_t *)tmp;
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(size_t i = 0; i < esize; i++){
+		itmp[i] = da[indicesIn[i]];
+	}
+	memcpy(da, itmp, esize * sizeof(index_t));
+
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(size_t i = 0; i < esize; i++){
+		itmp[i] = db[indicesIn[i]];
+	}
+	memcpy(db, itmp, esize * sizeof(index_t));
+
+	hdbscan_free(keys);
+	hdbscan_free(indices);
+	hdbscan_free(histograms);
+	hdbscan_free(tmp);
 }
 
+
 int32_t graph_select_pivot_index(UndirectedGraph* g, int64_t startIndex, int64_t endIndex) {
 	if (startIndex - endIndex <= 1)
 		return (int32_t)startIndex;
 
-	distance_t first, middle, last;
-	array_list_value_at(g->edgeWeights, (size_t)startIndex, &first);
-	array_list_value_at(g->edgeWeights, (size_t)(startIndex + (endIndex - startIndex) / 2), &middle);
-	array_list_value_at(g->edgeWeights, (size_t)endIndex, &last);
+	distance_t first = distance_list_at(g->edgeWeights, (size_t)startIndex);
+	distance_t middle = distance_list_at(g->edgeWeights, (size_t)(startIndex + (endIndex - startIndex) / 2));
+	distance_t last = distance_list_at(g->edgeWeights, (size_t)endIndex);
 
 	if (first <= middle) {
 		if (middle <= last)
@@ -250,16 +589,63 @@ void graph_quicksort(UndirectedGraph* g, int64_t startIndex, int64_t endIndex) {
 	}
 }
 
+/**
+ * @brief Swap-delete vb from the live neighbours of va in the CSR adjacency.
+ * 
+ * @param g 
+ * @param va 
+ * @param vb 
+ */
+static void graph_csr_remove_neighbour(UndirectedGraph* g, index_t va, index_t vb){
+	index_t* nb = g->adjacency + g->adjOffsets[va];
+	index_t last = (index_t)(g->adjSizes[va] - 1);
+
+	for(index_t i = 0; i < g->adjSizes[va]; i++){
+		if(nb[i] == vb){
+			nb[i] = nb[last];
+			nb[last] = vb;
+			g->adjSizes[va] = last;
+			return;
+		}
+	}
+}
+
+index_t* graph_get_neighbours(UndirectedGraph* g, index_t vertex, index_t* numNeighbours){
+	if(g->csr == TRUE){
+		*numNeighbours = g->adjSizes[vertex];
+		return g->adjacency + g->adjOffsets[vertex];
+	}
+
+	ArrayList* list = g->edges[vertex];
+	*numNeighbours = (index_t)list->size;
+	return (index_t *)list->data;
+}
+
 void graph_remove_edge(UndirectedGraph* g, index_t va, index_t vb){
+	if(g->csr == TRUE){
+		graph_csr_remove_neighbour(g, va, vb);
+		if(va != vb){
+			graph_csr_remove_neighbour(g, vb, va);
+		}
+		return;
+	}
+
 	// get the edge list for va
 	// find position for vb in the edge list for va
-	array_list_remove(g->edges[va], &vb);
+	index_t removed;
+	int64_t pos = index_list_find(g->edges[va], vb, 0);
+	if(pos >= 0){
+		array_list_remove_at(g->edges[va], (size_t)pos, &removed);
+	}
 	
 	/**
 	 * Have to repeat for the opposite in case va=vb in which case calling this method twice
 	 * would miss the second time.
 	 */
-	array_list_remove(g->edges[vb], &va);
+	pos = index_list_find(g->edges[vb], va, 0);
+	if(pos >= 0){
+		array_list_remove_at(g->edges[vb], (size_t)pos, &removed);
+	}
 
 }
 
@@ -310,12 +696,11 @@ void graph_print(UndirectedGraph* g) {
 	logger_write(NONE, s);
 
 	for(uint i = 0; i < g->numVertices; i++){
-		ArrayList* edge = g->edges[i];
+		index_t numNeighbours;
+		index_t* ldata = graph_get_neighbours(g, i, &numNeighbours);
 		logger_write(NONE, "[");
-	
-		index_t* ldata = edge->data;
 
-		for(index_t i = 0; i < edge->size; i++){
+		for(index_t i = 0; i < numNeighbours; i++){
 			sprintf(s, "%d, ", ldata[i]);
 			logger_write(NONE, s);			
 		}
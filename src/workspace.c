@@ -0,0 +1,134 @@
+/*
+ * workspace.c
+ *
+ * Copyright 2024 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file workspace.c
+ * 
+ * @brief Implementation of the functions in workspace.h
+ * 
+ */
+#include "hdbscan/workspace.h"
+#include "hdbscan/allocator.h"
+#include <stdio.h>
+#ifdef DEBUG
+#include "hdbscan/logger.h"
+#endif
+
+size_t workspace_aligned_size(size_t bytes){
+	return (bytes + WORKSPACE_ALIGNMENT - 1) & ~((size_t)WORKSPACE_ALIGNMENT - 1);
+}
+
+workspace* workspace_init(workspace* ws){
+	if(ws == NULL)
+		ws = (workspace*)hdbscan_malloc(sizeof(workspace));
+
+	if(ws == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "workspace_init - Could not allocate memory for workspace\n");
+	#else
+		printf("FATAL: workspace_init - Could not allocate memory for workspace\n");
+	#endif
+	} else{
+		ws->data = NULL;
+		ws->capacity = 0;
+		ws->offset = 0;
+	}
+
+	return ws;
+}
+
+int workspace_reserve(workspace* ws, size_t capacity){
+	capacity = workspace_aligned_size(capacity);
+
+	if(capacity <= ws->capacity){
+		return WORKSPACE_SUCCESS;
+	}
+
+	if(ws->offset > 0){
+	#ifdef DEBUG
+		logger_write(ERROR, "workspace_reserve - Cannot grow the workspace while buffers are in use\n");
+	#else
+		printf("ERROR: workspace_reserve - Cannot grow the workspace while buffers are in use\n");
+	#endif
+		return WORKSPACE_ERROR;
+	}
+
+	/// The old contents are scratch so there is nothing to copy over
+	hdbscan_free(ws->data);
+	ws->data = (char*)hdbscan_aligned_alloc(WORKSPACE_ALIGNMENT, capacity);
+
+	if(ws->data == NULL){
+	#ifdef DEBUG
+		logger_write(FATAL, "workspace_reserve - Could not allocate memory for the workspace\n");
+	#else
+		printf("FATAL: workspace_reserve - Could not allocate memory for the workspace\n");
+	#endif
+		ws->capacity = 0;
+		return WORKSPACE_ERROR;
+	}
+
+	ws->capacity = capacity;
+	return WORKSPACE_SUCCESS;
+}
+
+void* workspace_alloc(workspace* ws, size_t bytes){
+	size_t size = workspace_aligned_size(bytes);
+
+	if(ws->offset + size > ws->capacity){
+		if(workspace_reserve(ws, ws->offset + size) == WORKSPACE_ERROR){
+			return NULL;
+		}
+	}
+
+	void* buffer = ws->data + ws->offset;
+	ws->offset += size;
+
+	return buffer;
+}
+
+size_t workspace_mark(workspace* ws){
+	return ws->offset;
+}
+
+void workspace_release(workspace* ws, size_t mark){
+	if(mark < ws->offset){
+		ws->offset = mark;
+	}
+}
+
+void workspace_reset(workspace* ws){
+	ws->offset = 0;
+}
+
+void workspace_clean(workspace* ws){
+	if(ws->data != NULL){
+		hdbscan_free(ws->data);
+		ws->data = NULL;
+	}
+
+	ws->capacity = 0;
+	ws->offset = 0;
+}
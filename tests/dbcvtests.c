@@ -0,0 +1,244 @@
+/*
+ * dbcvtests.c
+ *
+ * Copyright 2019 Onalenna Junior Makhura
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation files
+ * (the "Software"), to deal in the Software without restriction,
+ * including without limitation the rights to use, copy, modify, merge,
+ * publish, distribute, sublicense, and/or sell copies of the Software,
+ * and to permit persons to whom the Software is furnished to do so,
+ * subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/**
+ * @file dbcvtests.c
+ *
+ * @author Onalenna Junior Makhura (ojmakh@essex.ac.uk)
+ *
+ * @brief CUnit tests for the DBCV validity index
+ *
+ * @copyright Copyright (c) 2019
+ *
+ */
+#include <CUnit/Basic.h>
+#include <stdio.h>
+#include <math.h>
+#include "hdbscan/hdbscan.h"
+
+#define BLOB_SIZE 40
+#define BRIDGE_SIZE 12
+#define NUM_POINTS (2 * BLOB_SIZE + BRIDGE_SIZE)
+
+static uint64_t seed = 12345;
+
+/**
+ * @brief A small linear congruential generator so the data set is the same everywhere
+ *
+ * @return double A value in [0, 1)
+ */
+static double next_random(void)
+{
+    seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+    return (double)(seed >> 11) / 9007199254740992.0;
+}
+
+/**
+ * @brief Initialise the dbcv test suite.
+ *
+ * @return int
+ */
+int init_dbcv_suite(void)
+{
+    return 0;
+}
+
+/**
+ * @brief Clean the dbcv test suite.
+ *
+ * @return int
+ */
+int clean_dbcv_suite(void)
+{
+    return 0;
+}
+
+/**
+ * @brief Two blobs that are only joined through a sparse bridge of points. The
+ * bridge is mostly noise, so no MST edge goes from one cluster to the other and
+ * the separation has to be found through the noise.
+ *
+ * The index is checked against a brute force DBCV on the full mutual
+ * reachability graph: the minimax distance of every pair of points, and the
+ * separation of a cluster as the smallest minimax distance to a point of another
+ * cluster.
+ */
+void dbcv_noise_bridge_test()
+{
+    double dataset[NUM_POINTS * 2];
+    index_t n = 0;
+
+    for(index_t i = 0; i < BLOB_SIZE; i++, n++){
+        dataset[2 * n] = next_random();
+        dataset[2 * n + 1] = next_random();
+    }
+
+    for(index_t i = 0; i < BLOB_SIZE; i++, n++){
+        dataset[2 * n] = 10 + next_random();
+        dataset[2 * n + 1] = next_random();
+    }
+
+    for(index_t i = 0; i < BRIDGE_SIZE; i++, n++){
+        dataset[2 * n] = 1.5 + i * 0.65 + 0.2 * next_random();
+        dataset[2 * n + 1] = 0.5 + 2 * next_random();
+    }
+
+    hdbscan* sc = hdbscan_init(NULL, 5);
+    CU_ASSERT_PTR_NOT_NULL_FATAL(sc);
+    CU_ASSERT_EQUAL_FATAL(HDBSCAN_SUCCESS, hdbscan_run(sc, dataset, NUM_POINTS, 2, TRUE, H_DOUBLE));
+
+    index_t numClusters = hdbscan_selected_clusters(sc, NULL);
+    CU_ASSERT_EQUAL_FATAL(2, numClusters);
+
+    label_t clusters[2];
+    hdbscan_selected_clusters(sc, clusters);
+
+    distance_t validity;
+    distance_t clusterValidity[2];
+    CU_ASSERT_EQUAL_FATAL(HDBSCAN_SUCCESS, hdbscan_dbcv(sc, &validity, clusterValidity));
+
+    label_t* labels = sc->clusterLabels;
+    index_t* verticesA = (index_t *)sc->mst->verticesA->data;
+    index_t* verticesB = (index_t *)sc->mst->verticesB->data;
+    distance_t* weights = (distance_t *)sc->mst->edgeWeights->data;
+    size_t numEdges = sc->mst->verticesA->size;
+
+    index_t noise = 0;
+    for(index_t i = 0; i < NUM_POINTS; i++){
+        if(labels[i] == 0){
+            noise++;
+        }
+    }
+    CU_ASSERT(noise > 0);
+
+    for(size_t e = 0; e < numEdges; e++){
+        label_t la = labels[verticesA[e]];
+        label_t lb = labels[verticesB[e]];
+        CU_ASSERT(la == 0 || lb == 0 || la == lb);
+    }
+
+    // Minimax distances of the mutual reachability graph with Floyd-Warshall
+    static distance_t minimax[NUM_POINTS][NUM_POINTS];
+    distance* dis = &sc->distanceFunction;
+    distance_t* core = dis->coreDistances;
+
+    for(index_t i = 0; i < NUM_POINTS; i++){
+        for(index_t j = 0; j < NUM_POINTS; j++){
+            distance_t w = i == j ? 0 : distance_get(dis, i, j);
+
+            if(i != j && core[i] > w){
+                w = core[i];
+            }
+
+            if(i != j && core[j] > w){
+                w = core[j];
+            }
+            minimax[i][j] = w;
+        }
+    }
+
+    for(index_t k = 0; k < NUM_POINTS; k++){
+        for(index_t i = 0; i < NUM_POINTS; i++){
+            for(index_t j = 0; j < NUM_POINTS; j++){
+                distance_t m = minimax[i][k] > minimax[k][j] ? minimax[i][k] : minimax[k][j];
+                if(m < minimax[i][j]){
+                    minimax[i][j] = m;
+                }
+            }
+        }
+    }
+
+    distance_t expected = 0;
+    for(index_t k = 0; k < numClusters; k++){
+        distance_t separation = D_MAX;
+        distance_t sparseness = 0;
+        index_t size = 0;
+
+        for(index_t p = 0; p < NUM_POINTS; p++){
+            if(labels[p] != clusters[k]){
+                continue;
+            }
+            size++;
+
+            for(index_t q = 0; q < NUM_POINTS; q++){
+                if(labels[q] != 0 && labels[q] != clusters[k] && minimax[p][q] < separation){
+                    separation = minimax[p][q];
+                }
+            }
+        }
+
+        for(size_t e = 0; e < numEdges; e++){
+            if(verticesA[e] != verticesB[e] && labels[verticesA[e]] == clusters[k] && labels[verticesB[e]] == clusters[k] && weights[e] > sparseness){
+                sparseness = weights[e];
+            }
+        }
+
+        distance_t m = separation > sparseness ? separation : sparseness;
+        distance_t value = (separation - sparseness) / m;
+        CU_ASSERT_DOUBLE_EQUAL(value, clusterValidity[k], 1e-12);
+
+        expected += size * value / NUM_POINTS;
+    }
+
+    CU_ASSERT_DOUBLE_EQUAL(expected, validity, 1e-12);
+    hdbscan_destroy(sc);
+}
+
+/**
+ * @brief The main function for the dbcv tests
+ *
+ * @return int
+ */
+int main()
+{
+    CU_pSuite suite = NULL;
+    /* initialize the CUnit test registry */
+    if (CUE_SUCCESS != CU_initialize_registry())
+        return CU_get_error();
+
+    /* add a suite to the registry */
+    suite = CU_add_suite("DBCV test", init_dbcv_suite, clean_dbcv_suite);
+    if (NULL == suite)
+    {
+        printf("Could not add the test suite\n");
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* add the tests to the suite */
+    if ((NULL == CU_add_test(suite, "Test for clusters joined through noise", dbcv_noise_bridge_test)))
+    {
+        printf("Could not add the dbcv test to the suite\n");
+        CU_cleanup_registry();
+        return CU_get_error();
+    }
+
+    /* Run all tests using the CUnit Basic interface */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+    CU_cleanup_registry();
+    return CU_get_error();
+}